@@ -2,8 +2,11 @@
 
 #include <vector>
 #include "core/tensor/Tensor.h"
+#include "core/tensor/CsrTensor.h"
+#include "core/data/SampleView.h"
 
 class Loss;
+class ImageAugment2D;
 
 using namespace std;
 
@@ -14,6 +17,7 @@ class Batch {
         vector<size_t> indices;
         Tensor targets;
         Tensor data;
+        CsrTensor sparseData;
 
         // Methods
         void ensureGpu();
@@ -23,10 +27,15 @@ class Batch {
         Batch(size_t, size_t);
 
         // Methods
-        void setBatch(const Tensor&, const vector<float> &);
+        void setBatch(
+            const SampleView&, const vector<float> &, 
+            const ImageAugment2D *augment = nullptr, size_t epoch = 0
+        );
         void setBatchIndices(size_t, size_t, const vector<size_t>&);
 
         const Tensor& getData() const;
+        const CsrTensor& getSparseData() const;
+        bool isSparse() const;
         const Tensor& getTargets() const;
         size_t getSize() const;
         const vector<size_t>& getIndices() const;
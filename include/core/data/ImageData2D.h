@@ -2,34 +2,58 @@
 
 #include "core/data/Data.h"
 #include "core/tensor/Tensor.h"
+#include "core/tensor/ByteTensor.h"
 #include <unordered_map>
 #include <vector>
 #include <fstream>
 
+class ImageTransform2D;
+
 struct RawImage {
-    vector<unsigned char> pixels;
+    size_t offset;
     size_t width;
     size_t height;
     size_t channels;
 };
 
+struct RawImageSet {
+    vector<unsigned char> pixels;
+    vector<RawImage> images;
+
+    const unsigned char* getPixels(size_t) const;
+    size_t size() const;
+    void clear();
+};
+
 class ImageData2D : public Data {
     private:
+        // Constants
+        static const size_t MAX_IN_FLIGHT_BYTES;
+
         // Instance Variables
         size_t channels;
 
-        vector<RawImage> trainFeatures;
+        RawImageSet trainFeatures;
         vector<float> trainTargets;
 
-        vector<RawImage> testFeatures;
+        RawImageSet testFeatures;
         vector<float> testTargets;
 
+        ByteTensor trainImages;
+        ByteTensor testImages;
+
         unordered_map<string, int> labelMap;
 
         // Methods
-        void read(vector<RawImage>&, vector<float>&, const string&);
+        void read(RawImageSet&, vector<float>&, const string&);
+        void readPacked(ByteTensor&, vector<float>&, const string&, const ImageTransform2D&);
+        void readShards(ByteTensor&, vector<float>&, const string&);
+        void writeShards(const ByteTensor&, const vector<float>&, const string&, size_t) const;
         void scanDirectory(vector<string>&, vector<string>&, const string&) const;
-        void extractImages(vector<RawImage>&, const vector<string>&) const;
+        size_t probeImages(RawImageSet&, const vector<string>&) const;
+        int getDecodeThreads(size_t) const;
+        void extractImages(RawImageSet&, const vector<string>&) const;
+        void extractPackedImages(ByteTensor&, const vector<string>&, const ImageTransform2D&) const;
         void extractLabels(vector<float>&, const vector<string>&);
 
     public:
@@ -40,11 +64,19 @@ class ImageData2D : public Data {
         // Methods
         void readTrain(const string&);
         void readTest(const string&);
+        void readTrain(const string&, const ImageTransform2D&);
+        void readTest(const string&, const ImageTransform2D&);
+        void readTrainShards(const string&);
+        void readTestShards(const string&);
+        void writeTrainShards(const string&, size_t) const;
+        void writeTestShards(const string&, size_t) const;
         void clearTrain() override;
         void clearTest() override;
 
-        const vector<RawImage>& getTrainFeatures() const;
-        const vector<RawImage>& getTestFeatures() const;
+        const RawImageSet& getTrainFeatures() const;
+        const RawImageSet& getTestFeatures() const;
+        const ByteTensor& getTrainImages() const;
+        const ByteTensor& getTestImages() const;
         const vector<float>& getTrainTargets() const override;;
         const vector<float>& getTestTargets() const override;;
 
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <memory>
+
+class Tensor;
+class ByteTensor;
+class CsrTensor;
+
+using namespace std;
+
+// Non-owning view over the samples of a Tensor, ByteTensor or CsrTensor, optionally through a row
+// index list and a per-feature affine. The conversions from a tensor are implicit so fit() and
+// predict() accept tensors directly, but the view only stores a pointer: the source must outlive
+// every view made from it, including the ones kept in an IndexSplit. Never build a view that
+// outlives the call from a temporary tensor.
+class SampleView {
+    private:
+        // Instance Variables
+        const Tensor *floatSource;
+        const ByteTensor *byteSource;
+        const CsrTensor *sparseSource;
+        shared_ptr<const vector<size_t> > indices;
+        shared_ptr<const vector<float> > affineScale;
+        shared_ptr<const vector<float> > affineShift;
+        vector<size_t> shape;
+        size_t sampleSize;
+
+        // Methods
+        void dequantize(const uint8_t*, float*, size_t) const;
+        void copySample(size_t, float*) const;
+        void applyAffine(float*) const;
+
+    public:
+        // Constructors
+        SampleView(const Tensor&);
+        SampleView(const ByteTensor&);
+        SampleView(const CsrTensor&);
+        SampleView(const SampleView&, const vector<size_t>&);
+        SampleView();
+
+        // Methods
+        const vector<size_t>& getShape() const;
+        size_t getNumSamples() const;
+        size_t getSampleSize() const;
+        size_t getSampleBytes() const;
+        size_t getSourceIndex(size_t) const;
+        bool isEmpty() const;
+        bool isSparse() const;
+
+        void gather(const size_t*, size_t, float*) const;
+        void gatherRange(size_t, size_t, float*) const;
+        CsrTensor gatherSparse(const size_t*, size_t) const;
+        CsrTensor gatherRangeSparse(size_t, size_t) const;
+        Tensor materialize() const;
+        SampleView withAffine(const vector<float>&, const vector<float>&) const;
+};
\ No newline at end of file
@@ -3,10 +3,21 @@
 #include <string>
 #include <vector>
 #include <unordered_map>
+#include <string_view>
 #include "core/tensor/Tensor.h"
+#include "core/tensor/CsrTensor.h"
 #include "core/data/Data.h"
+#include "utils/CategoryTable.h"
 
 class TabularData : public Data {
+    public:
+        // Enums
+        enum FeatureFormats : uint32_t {
+            OneHot,
+            Sparse,
+            CategoryIds
+        };
+
     private:
         // Constants
         static const size_t NO_TARGET_IDX;
@@ -22,14 +33,21 @@ class TabularData : public Data {
         Tensor testFeatures;
         vector<float> trainTargets;
         vector<float> testTargets;
+        CsrTensor trainSparseFeatures;
+        CsrTensor testSparseFeatures;
 
         vector<bool> isCategorical;
-        vector<unordered_map<string, float> > featureEncodings;
+        vector<CategoryTable> featureEncodings;
+        vector<uint32_t> hashBuckets;
+        vector<size_t> recordOffsets;
+        vector<size_t> recordOrder;
+        size_t recordWidth;
         unordered_map<string, int> labelMap;
 
         bool isTrainLoaded;
         bool isTestLoaded;
         bool isLoadedFromModel;
+        FeatureFormats featureFormat;
 
         string task;
 
@@ -38,16 +56,23 @@ class TabularData : public Data {
         size_t getColIdx(const string&) const;
         void parseRawData(vector<vector<string> >&, vector<string>&, const vector<string>&, size_t);
         
+        void prepareEncodings(const vector<vector<string> >&);
         Tensor readFeatures(const vector<vector<string> >&);
+        CsrTensor readSparseFeatures(const vector<vector<string> >&);
         vector<float> readTargets(const vector<string>&);
         void readCsv(const string&, bool, size_t, const string&, bool);
 
         void setData(const Tensor&, vector<float>&, bool);
+        void setSparseData(const CsrTensor&, vector<float>&, bool);
         
         void head(size_t, const Tensor&) const;
+        void headSparse(size_t, const CsrTensor&) const;
 
         void checkTrainLoaded() const;
         void checkTestLoaded() const;
+        void checkDenseFeatures() const;
+        void checkSparseFeatures() const;
+        void loadLegacyEncodings(ifstream&, uint32_t);
 
     public:
         // Constructors
@@ -65,6 +90,25 @@ class TabularData : public Data {
 
         const Tensor& getTrainFeatures() const;
         const Tensor& getTestFeatures() const;
+        const CsrTensor& getTrainSparseFeatures() const;
+        const CsrTensor& getTestSparseFeatures() const;
+        void setSparseFeatures(bool);
+        void setCategoryIds(bool);
+        void setFeatureFormat(FeatureFormats);
+        FeatureFormats getFeatureFormat() const;
+        void setHashBuckets(size_t, size_t);
+        vector<size_t> getCardinalities() const;
+
+        void prepareRecords();
+        size_t getNumFeatureFields() const;
+        size_t getRecordWidth() const;
+        bool encodeRecord(const string_view*, float*) const;
+        bool encodeSparseRecord(const string_view*, uint32_t*, float*, size_t&) const;
+        bool encodeSparseRecord(const string_view*, CsrTensor&) const;
+        void reportInvalidRecord(const string_view*) const;
+        const vector<string>& getHeader() const;
+        vector<string> getLabelNames() const;
+        bool isClassification() const;
         const vector<float>& getTrainTargets() const override;
         const vector<float>& getTestTargets() const override;
 
@@ -77,5 +121,6 @@ class TabularData : public Data {
         void writeBin(ofstream&) const override;
         void loadFromBin(ifstream&) override;
 
+
         Data* clone() const override;
 };
\ No newline at end of file
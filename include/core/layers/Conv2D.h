@@ -2,6 +2,9 @@
 
 #include "core/tensor/Tensor.h"
 #include "core/layers/Layer.h"
+#include "core/tensor/PanelMatrix.h"
+#include "core/tensor/QuantizedMatrix.h"
+#include "core/tensor/Bf16Tensor.h"
 #include <vector>
 #include <cstdint>
 #include <string>
@@ -29,6 +32,7 @@ class Conv2D : public Layer {
         Tensor im2ColInBuf;
         Tensor kernels;
         Tensor fastKernels;
+        mutable Tensor unpackedKernels;
         Tensor activations;
         Tensor preActivations;
         vector<size_t> im2ColPreActShape;
@@ -40,6 +44,13 @@ class Conv2D : public Layer {
         Tensor gradIm2ColBuf;
         Tensor gradBuf;
         Tensor biases;
+        PanelMatrix packedKernels;
+        QuantizedMatrix quantizedKernels;
+        Bf16Tensor paddedInputBf;
+        Bf16Tensor preActivationsBf;
+        Bf16Tensor gradBufBf;
+        Bf16Tensor kernelsBf;
+        bool isBf16Training;
 
         WindowDims winIn;
         WindowDims winGrad;
@@ -51,6 +62,7 @@ class Conv2D : public Layer {
 
         // Methods
         void initKernels();
+        void ensureKernels();
         void initBiases();
         void initGradBuf(bool);
         void initStride(size_t);
@@ -89,6 +101,12 @@ class Conv2D : public Layer {
         void forward(const Tensor&) override;
         void backprop(const Tensor&, float, Tensor&, bool) override;
 
+        void initInference(const vector<size_t>&) override;
+        void infer(const Tensor&, Tensor&, Tensor&) const override;
+        void packWeights() override;
+        bool quantize(const vector<float>&) override;
+        vector<size_t> getInferScratchShape(const vector<size_t>&) const override;
+
         const Tensor& getOutput() const override;
         Tensor& getOutputGradient() override;
         
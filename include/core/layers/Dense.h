@@ -3,6 +3,8 @@
 #include <vector>
 #include "core/tensor/Tensor.h"
 #include "core/layers/Layer.h"
+#include "core/tensor/PanelMatrix.h"
+#include "core/tensor/QuantizedMatrix.h"
 
 class Activation;
 
@@ -28,6 +30,9 @@ class Dense : public Layer {
         Tensor dX;
         Tensor dA;
         Tensor biases;
+        PanelMatrix packedWeights;
+        QuantizedMatrix quantizedWeights;
+        mutable Tensor unpackedWeights;
 
         Activation *activation;
 
@@ -39,6 +44,7 @@ class Dense : public Layer {
         void initBiases();
         void initWeights(size_t);
         void initParams(size_t);
+        void ensureWeights();
         void initExecutionMode();
         void checkBuildSize(const vector<size_t>&) const;
         
@@ -68,6 +74,15 @@ class Dense : public Layer {
 
         void forward(const Tensor&) override;
         void backprop(const Tensor&, float, Tensor&, bool) override;
+        void forwardSparse(const CsrTensor&) override;
+        void backpropSparse(const CsrTensor&, float, Tensor&) override;
+
+        void initInference(const vector<size_t>&) override;
+        void infer(const Tensor&, Tensor&, Tensor&) const override;
+        void inferSparse(const CsrTensor&, Tensor&) const override;
+        void packWeights() override;
+        bool quantize(const vector<float>&) override;
+        vector<size_t> getInferScratchShape(const vector<size_t>&) const override;
 
         const Tensor& getOutput() const override;
         Tensor& getOutputGradient() override;
@@ -31,6 +31,8 @@ class Dropout : public Layer {
         void forward(const Tensor&) override;
         void backprop(const Tensor&, float, Tensor&, bool) override;
 
+        void infer(const Tensor&, Tensor&, Tensor&) const override;
+
         const Tensor& getOutput() const override;
         Tensor& getOutputGradient() override;
 
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <vector>
+#include "core/tensor/Tensor.h"
+#include "core/layers/Layer.h"
+
+using namespace std;
+
+class Embedding : public Layer {
+    private:
+        // Instance Variables
+        vector<size_t> cardinalities;
+        vector<size_t> tableOffsets;
+        size_t embeddingDim;
+        size_t numPassThrough;
+
+        Tensor table;
+        Tensor output;
+        Tensor dX;
+
+        // Methods
+        void initOffsets();
+        void initTable();
+        void checkBuildSize(const vector<size_t>&) const;
+        size_t getOutputWidth() const;
+        size_t getRowIdx(size_t, float) const;
+        void gather(const Tensor&, Tensor&) const;
+        void writeBinInternal(ofstream&) const override;
+
+    public:
+        // Constructors
+        Embedding(const vector<size_t>&, size_t);
+        Embedding();
+
+        // Methods
+        void build(const vector<size_t>&, bool isInference = false) override;
+
+        void forward(const Tensor&) override;
+        void backprop(const Tensor&, float, Tensor&, bool) override;
+
+        void initInference(const vector<size_t>&) override;
+        void infer(const Tensor&, Tensor&, Tensor&) const override;
+
+        const Tensor& getOutput() const override;
+        Tensor& getOutputGradient() override;
+
+        vector<size_t> getBuildOutShape(const vector<size_t>&) const override;
+        Layer::Encodings getEncoding() const override;
+
+        void loadFromBin(ifstream&) override;
+
+        const Tensor& getWeights() const override;
+
+        Layer* clone() const override;
+};
\ No newline at end of file
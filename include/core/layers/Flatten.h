@@ -25,6 +25,8 @@ class Flatten : public Layer {
         void forward(const Tensor&) override;
         void backprop(const Tensor&, float, Tensor&, bool) override;
 
+        void infer(const Tensor&, Tensor&, Tensor&) const override;
+
         const Tensor& getOutput() const override;
         Tensor& getOutputGradient() override;
 
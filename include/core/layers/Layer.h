@@ -5,6 +5,7 @@
 #include "core/gpu/GpuTypes.h"
 
 class Tensor;
+class CsrTensor;
 
 using namespace std;
 
@@ -12,8 +13,9 @@ class Layer {
     private:
         // Instance Variables
         size_t maxBatchSize;
+        bool sparseInput;
+        bool mixedPrecision;
 
-        virtual void syncBuffers();
         virtual void writeBinInternal(ofstream&) const = 0;
 
     public:
@@ -26,7 +28,8 @@ class Layer {
             Flatten,
             Dropout,
             GlobalAveragePooling2D,
-            None
+            None,
+            Embedding
         };
         // Constructor
         Layer();
@@ -39,6 +42,15 @@ class Layer {
 
         virtual void forward(const Tensor&) = 0;
         virtual void backprop(const Tensor&, float, Tensor&, bool) = 0;
+        virtual void forwardSparse(const CsrTensor&);
+        virtual void backpropSparse(const CsrTensor&, float, Tensor&);
+
+        virtual void initInference(const vector<size_t>&);
+        virtual void infer(const Tensor&, Tensor&, Tensor&) const = 0;
+        virtual void inferSparse(const CsrTensor&, Tensor&) const;
+        virtual vector<size_t> getInferScratchShape(const vector<size_t>&) const;
+        virtual void packWeights();
+        virtual bool quantize(const vector<float>&);
 
         virtual const Tensor& getOutput() const = 0;
         virtual Tensor& getOutputGradient() = 0;
@@ -46,9 +58,14 @@ class Layer {
         virtual vector<size_t> getBuildOutShape(const vector<size_t>&) const = 0;
         virtual Encodings getEncoding() const = 0;
         size_t getMaxBatchSize() const;
+        void setSparseInput(bool);
+        bool isSparseInput() const;
+        void setMixedPrecision(bool);
+        bool isMixedPrecision() const;
         
         virtual void writeBin(ofstream&);
         virtual void loadFromBin(ifstream&);
+        virtual void syncBuffers();
 
         virtual const Tensor& getWeights() const;
         virtual const Tensor& getBiases() const;
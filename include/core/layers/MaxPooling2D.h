@@ -46,6 +46,9 @@ class MaxPooling2D : public Layer {
         void forward(const Tensor&) override;
         void backprop(const Tensor&, float, Tensor&, bool) override;
 
+        void infer(const Tensor&, Tensor&, Tensor&) const override;
+        vector<size_t> getInferScratchShape(const vector<size_t>&) const override;
+
         const Tensor& getOutput() const override;
         Tensor& getOutputGradient() override;
 
@@ -18,12 +18,11 @@ class ProgressAccuracy : public ProgressMetric {
         void init(size_t) override;
         string getName() const override;
         void updateCorrectPredictions(
-            const Tensor&, const vector<float>&, const Tensor&, 
-            const vector<size_t> *indices = nullptr
+            const vector<float>&, const Tensor&, const vector<size_t> *indices = nullptr
         );
         void update(const Batch&, const Loss*, const Tensor&, float) override;
         void update(
-            const Tensor&, const vector<float>&, const Loss*, const Tensor&, float
+            size_t, const vector<float>&, const Loss*, const Tensor&, float
         ) override;
         float calculate() const override;
 };
\ No newline at end of file
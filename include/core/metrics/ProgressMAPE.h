@@ -13,9 +13,7 @@ class ProgressMAPE : public ProgressMetric {
         float runningSum;
 
         // Methods
-        void accumulateMAPE(
-            const Tensor&, const vector<float>&, const Loss*, const Tensor&, float
-        );
+        void accumulateMAPE(const vector<float>&, const Tensor&);
         
     public:
         // Methods
@@ -23,7 +21,7 @@ class ProgressMAPE : public ProgressMetric {
         string getName() const override;
         void update(const Batch&, const Loss*, const Tensor&, float) override;
         void update(
-            const Tensor&, const vector<float>&, const Loss*, const Tensor&, float
+            size_t, const vector<float>&, const Loss*, const Tensor&, float
         ) override;
         float calculate() const override;
 };
\ No newline at end of file
@@ -42,7 +42,7 @@ class ProgressMetric {
 
         virtual void update(const Batch&, const Loss*, const Tensor&, float);
         virtual void update(
-            const Tensor&, const vector<float>&, const Loss*, const Tensor&, float
+            size_t, const vector<float>&, const Loss*, const Tensor&, float
         );
         virtual float calculate() const = 0;
 };
\ No newline at end of file
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <vector>
+#include "core/tensor/Tensor.h"
+#include "core/data/SampleView.h"
+
+class NeuralNet;
+class CsrTensor;
+
+using namespace std;
+
+// Runs a trained network forward using its own activation workspace, sized once for a max batch.
+class InferenceSession {
+    private:
+        // Constants
+        static const vector<size_t> TUNE_CANDIDATES;
+        static const size_t TUNE_BATCHES;
+        static const size_t TUNE_REPEATS;
+
+        // Instance Variables
+        NeuralNet &model;
+        size_t maxBatchSize;
+        size_t currBatchSize;
+        vector<size_t> sampleShape;
+        bool isSparse;
+        size_t layoutGeneration;
+
+        vector<Tensor> outputs;
+        vector<Tensor> scratch;
+        vector<vector<size_t> > outShapes;
+        vector<vector<size_t> > scratchShapes;
+
+        vector<size_t> batchShape;
+        Tensor batchInput;
+        vector<vector<float> > *channelRanges;
+
+        // Methods
+        void allocateWorkspace();
+        void allocateLayerWorkspace();
+        void checkLayout();
+        void reShapeWorkspace(size_t);
+        void checkBatchSize(size_t) const;
+        const Tensor& runLayers(const Tensor&, size_t);
+        const Tensor& runRange(const SampleView&, size_t, size_t);
+        double timeRange(const SampleView&, size_t);
+        void cpyBatchToOutput(const Tensor&, size_t, size_t, Tensor&) const;
+        void trackRanges(const Tensor&, vector<float>&) const;
+
+    public:
+        // Constants
+        static const size_t AUTO_BATCH_SIZE;
+
+        // Constructors
+        InferenceSession(NeuralNet&, size_t, const vector<size_t>&, bool isSparse = false);
+
+        // Methods
+        const Tensor& run(const Tensor&);
+        const Tensor& run(const CsrTensor&);
+        Tensor predict(const SampleView&);
+        Tensor calibrate(const SampleView&, vector<vector<float> >&);
+
+        static InferenceSession* tune(NeuralNet&, const SampleView&, size_t);
+
+        bool isCompatible(const vector<size_t>&, bool) const;
+        bool isStale() const;
+        size_t getMaxBatchSize() const;
+        size_t getWorkspaceBytes() const;
+        size_t getOutputSize() const;
+};
\ No newline at end of file
@@ -4,7 +4,10 @@
 #include "core/layers/Layer.h"
 #include <fstream>
 #include <random>
+#include <mutex>
+#include <atomic>
 #include "core/tensor/Tensor.h"
+#include "core/data/SampleView.h"
 #include "core/gpu/GpuTypes.h"
 
 class Loss;
@@ -12,6 +15,9 @@ class Activation;
 class Batch;
 class ProgressMetric;
 class EarlyStop;
+class ImageAugment2D;
+class CsrTensor;
+class InferenceSession;
 
 using namespace std;
 
@@ -19,6 +25,9 @@ class NeuralNet {
     private:
         // Constants
         static const size_t INFERENCE_BATCH_SIZE;
+        static const float INFERENCE_MEMORY_MB;
+        static const float BYTES_PER_MEGABYTE;
+        static const size_t CALIBRATION_BATCH_SIZE;
 
         // Instance Variables
         vector<Layer*> layers;
@@ -26,33 +35,60 @@ class NeuralNet {
         Loss *loss;
         size_t maxBatchSize;
         Tensor dL;
+        size_t shuffleBlockSize;
+        size_t shuffleWindowBlocks;
+        float gatherBandwidth;
+        InferenceSession *session;
+        size_t sessionBatchSize;
+        size_t inferenceBatchSize;
+        float inferenceMemoryMb;
+        vector<size_t> inferenceSampleShape;
+        mutex inferenceMutex;
+        atomic<bool> isPacked;
+        atomic<size_t> layoutGeneration;
+        bool mixedPrecision;
 
         // Static variables;
         static random_device rd;
         static mt19937 generator;
 
         // Methods
-        void build(size_t, const Tensor&, bool isInference = false);
+        void build(size_t, const SampleView&, bool isInference = false);
+        void build(size_t, vector<size_t>, bool, bool);
 
-        float runEpoch(const Tensor&, const vector<float>&, float, size_t, ProgressMetric&);
+        float runEpoch(
+            const SampleView&, const vector<float>&, float, size_t, 
+            ProgressMetric&, const ImageAugment2D*, size_t
+        );
         void forwardPass(const Tensor&);
+        void forwardPassSparse(const CsrTensor&);
         void backprop(const Batch&, float);
         
         void fitBatch(const Batch&, float);
-        Batch makeBatch(size_t, size_t, const Tensor&, const vector<float>&, const vector<size_t>&) const;
+        Batch makeBatch(
+            size_t, size_t, const SampleView&, const vector<float>&, 
+            const vector<size_t>&, const ImageAugment2D*, size_t
+        ) const;
 
         void loadLoss(ifstream&);
         Layer* loadLayer(ifstream&);
 
-        vector<size_t> generateShuffledIndices(const Tensor&) const;
+        vector<size_t> generateShuffledIndices(const SampleView&) const;
+        vector<size_t> generateBlockShuffledIndices(size_t) const;
 
         void reShapeDL(size_t);
 
-        Tensor makeInferenceBatch(size_t, size_t, size_t, const Tensor&) const;
+        Tensor predictGpu(const SampleView&, size_t);
+        void resetSession();
+        void invalidatePackedWeights();
+        void clearQuantization();
+        void printQuantizationReport(const Tensor&, const Tensor&, const vector<float>&) const;
+        Tensor makeInferenceBatch(size_t, size_t, const SampleView&) const;
         void forwardPassInference(const Tensor&);
-        void cpyBatchToOutput(size_t, size_t, size_t, size_t, const Tensor&, Tensor&) const;
+        void forwardInferenceBatch(size_t, size_t, const SampleView&);
+        void cpyBatchToOutput(size_t, size_t, size_t, size_t, Tensor&) const;
 
-        bool validateEpoch(const Tensor&, const vector<float>&, ProgressMetric&, EarlyStop*, size_t);
+        bool validateEpoch(const SampleView&, const vector<float>&, ProgressMetric&, EarlyStop*, size_t);
         void deleteLayers();
         void tryBestWeights(EarlyStop *stop);
 
@@ -75,19 +111,40 @@ class NeuralNet {
 
         //Methods
         void fit(
-            const Tensor&, const vector<float>&, float, 
+            const SampleView&, const vector<float>&, float, 
             float, size_t, size_t, ProgressMetric&,
-            const Tensor& xVal = Tensor(),
+            const SampleView& xVal = SampleView(),
             const vector<float>& yVal = vector<float>(),
-            EarlyStop *stop = nullptr
+            EarlyStop *stop = nullptr,
+            const ImageAugment2D *augment = nullptr
         );
 
-        Tensor predict(const Tensor&);
+        Tensor predict(const SampleView&);
+        Tensor predict(const SampleView&, size_t);
+        const vector<Layer*>& getLayers() const;
+        void initInference(const vector<size_t>&);
+        void packWeights();
+        size_t getLayoutGeneration() const;
+        void quantize(
+            const SampleView&, 
+            const SampleView& xEval = SampleView(), 
+            const vector<float>& yEval = vector<float>()
+        );
 
         void writeBin(ofstream&) const;
         void loadFromBin(ifstream&);
         void saveBestWeights(ofstream&) const;
         void loadBestWeights(ifstream&);
 
+        void setBlockShuffle(size_t, size_t windowBlocks = 8);
+        void setMixedPrecision(bool);
+        float getGatherBandwidth() const;
+
+        void setInferenceBatchSize(size_t, float maxWorkspaceMb = INFERENCE_MEMORY_MB);
+        size_t getInferenceBatchSize() const;
+
         NeuralNet* clone() const;
+
+        // Static Methods
+        static mt19937& getGenerator();
 };
\ No newline at end of file
@@ -1,12 +1,17 @@
 #pragma once
 
 #include "core/model/NeuralNet.h"
+#include "core/tensor/CsrTensor.h"
+#include "utils/BinUtils.h"
 #include <string>
+#include <string_view>
 #include <fstream>
 
 class Scalar;
 class Data;
+class TabularData;
 class ImageTransform2D;
+class InferenceSession;
 
 using namespace std;
 
@@ -24,8 +29,25 @@ class Pipeline {
 
         string bestModelPath;
 
+        // Record Inference Workspace
+        TabularData *recordData;
+        InferenceSession *recordSession;
+        size_t maxRecords;
+        Tensor recordInput;
+        CsrTensor sparseRecordInput;
+        vector<size_t> recordShape;
+        vector<float> featureScale;
+        vector<float> featureShift;
+        vector<float> targetScale;
+        vector<float> targetShift;
+
         // Methods
         void checkIsLoadedPipeline(const string&) const;
+        void resetRecordInference();
+        void resetRecordSession();
+        void prepareScalars();
+        void applyAffine(float*, size_t, size_t, const vector<float>&, const vector<float>&) const;
+        void writeRecordOutput(const Tensor&, size_t, float*) const;
 
         void loadModel(ifstream&);
         void loadData(ifstream&);
@@ -54,10 +76,22 @@ class Pipeline {
         NeuralNet* getModel() const;
         ImageTransform2D* getImageTransformer() const;
 
-        void saveToBin(const string&) const;
+        void saveToBin(const string&, BinUtils::WeightFormats = BinUtils::FP32) const;
         void writeBin(ofstream&) const;
         void loadComponents(ifstream&);
 
+        void prepareInference(size_t maxRecords = 1);
+        void predict(const string_view*, size_t, float*);
+        void predict(const vector<string_view>&, float*);
+        void encodeRecord(const string_view*, float*) const;
+        void encodeRecord(const string_view*, CsrTensor&) const;
+        bool tryEncodeRecord(const string_view*, float*) const;
+        bool tryEncodeRecord(const string_view*, uint32_t*, float*, size_t&) const;
+        void predictEncoded(const Tensor&, float*);
+        void predictEncoded(const CsrTensor&, float*);
+        size_t getNumFields() const;
+        size_t getOutputSize() const;
+
         // Static Methods
         static Pipeline loadFromBin(const string&);
 };
\ No newline at end of file
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+class Tensor;
+struct WindowDims;
+
+using namespace std;
+
+// NHWC tensor stored as bfloat16: the top 16 bits of an fp32 value, rounded to nearest even.
+// Used by mixed-precision training to keep activation and gradient buffers at half the size.
+// The conv kernels widen values as they are read and accumulate in fp32.
+class Bf16Tensor {
+    private:
+        // Instance Variables
+        vector<size_t> shape;
+        vector<uint16_t> data;
+
+    public:
+        // Constructors
+        Bf16Tensor(const vector<size_t>&);
+        Bf16Tensor();
+
+        // Methods
+        const vector<size_t>& getShape() const;
+        size_t getSize() const;
+        const uint16_t* getData() const;
+        void reShapeInPlace(const vector<size_t>&);
+
+        void store(const Tensor&);
+        void load(Tensor&) const;
+        void storePadded(const Tensor&, const WindowDims&);
+        void storeUpsampledGrad(const Tensor&, const WindowDims&, size_t);
+        void storeKernels(const Tensor&);
+
+        void conv2dForward(const Bf16Tensor&, size_t, Tensor&, const Tensor&) const;
+        void conv2dWeights(const Tensor&, size_t, size_t, size_t, size_t, Tensor&) const;
+        void conv2dInput(const Bf16Tensor&, Tensor&) const;
+
+        // Static Methods
+        static uint16_t fromFloat(float);
+        static float toFloat(uint16_t);
+};
\ No newline at end of file
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <memory>
+
+class MappedFile;
+
+using namespace std;
+
+class ByteTensor {
+    private:
+        // Instance Variables
+        vector<size_t> shape;
+        vector<uint8_t> data;
+
+        vector<shared_ptr<const MappedFile> > mappings;
+        vector<const uint8_t*> segments;
+        size_t segmentSamples;
+
+        float scale;
+        float shift;
+
+    public:
+        // Constructors
+        ByteTensor(const vector<size_t>&, float scale = 1.0f, float shift = 0.0f);
+        ByteTensor();
+
+        // Methods
+        const vector<size_t>& getShape() const;
+        size_t getSize() const;
+        size_t getSampleSize() const;
+        bool isView() const;
+
+        const uint8_t* getData() const;
+        uint8_t* getData();
+        const uint8_t* getSample(size_t) const;
+
+        float getScale() const;
+        float getShift() const;
+        void setScaling(float, float);
+        void setMinmaxScaling();
+
+        void addSegment(shared_ptr<const MappedFile>, const uint8_t*);
+        void clear();
+
+        // Static Methods
+        static ByteTensor view(const vector<size_t>&, size_t, float scale = 1.0f, float shift = 0.0f);
+};
\ No newline at end of file
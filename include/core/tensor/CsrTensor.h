@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+class Tensor;
+
+using namespace std;
+
+class CsrTensor {
+    private:
+        // Instance Variables
+        vector<size_t> shape;
+        vector<size_t> rowPtr;
+        vector<uint32_t> colIdx;
+        vector<float> values;
+
+    public:
+        // Constructors
+        CsrTensor(size_t, size_t);
+        CsrTensor();
+
+        // Methods
+        const vector<size_t>& getShape() const;
+        size_t getNumRows() const;
+        size_t getNumCols() const;
+        size_t getNnz() const;
+
+        vector<size_t>& getRowPtr();
+        vector<uint32_t>& getColIdx();
+        vector<float>& getValues();
+        const vector<size_t>& getRowPtr() const;
+        const vector<uint32_t>& getColIdx() const;
+        const vector<float>& getValues() const;
+
+        CsrTensor gatherRows(const size_t*, size_t) const;
+        void densifyRow(size_t, float*) const;
+        Tensor toDense() const;
+
+        // Kernels
+        void mmT(const Tensor&, Tensor&) const;
+        void applyWeightGrad(const Tensor&, float, float, Tensor&) const;
+
+        void reserve(size_t, size_t);
+        void clearRows();
+        void appendEntry(uint32_t, float);
+        void finishRow();
+
+        void clear();
+};
\ No newline at end of file
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <fstream>
+#include <cstdint>
+
+class Tensor;
+class CsrTensor;
+class MappedFile;
+
+using namespace std;
+
+// Row-major {rows, cols} weights repacked into panels of PANEL_ROWS interleaved rows, so the
+// CPU inference kernels stream them contiguously with one SIMD lane per output row. Panels loaded
+// from a model container are a read-only view into the mapped file. Panels saved in fp16, bf16 or
+// block int8 stay encoded after loading until widen() expands them to fp32.
+class PanelMatrix {
+    private:
+        // Constants
+        static const size_t PANEL_ROWS;
+        static const size_t BLOCK_COLS;
+        static const size_t ROW_BLOCK;
+        static const uint32_t ROW_MAJOR_LAYOUT;
+        static const uint32_t PANEL_LAYOUT;
+        static const uint32_t ENCODED_LAYOUT;
+        static const size_t QUANT_BLOCK;
+        static const float MAX_LEVEL;
+
+        // Static Variables
+        static size_t numThreads;
+
+        // Instance Variables
+        size_t numRows;
+        size_t numCols;
+        size_t numPanels;
+        vector<float> panels;
+        shared_ptr<const MappedFile> mapping;
+        const float *data;
+        uint32_t format;
+        vector<int8_t> encoded;
+        const int8_t *encodedData;
+
+        // Methods
+        size_t getPanelSize() const;
+        const float* getPanels(vector<float>&) const;
+        void checkWidened() const;
+        void writeDims(ofstream&) const;
+        void readDims(ifstream&);
+        void writeBin(ofstream&) const;
+        void loadFromBin(ifstream&);
+        void writeEncoded(ofstream&, uint32_t) const;
+        void writePanels(ofstream&, uint32_t) const;
+        void loadEncoded(ifstream&);
+
+        // Static Methods
+        static size_t getEncodedSize(size_t, uint32_t);
+        static void encode(const float*, size_t, uint32_t, int8_t*);
+        static void decode(const int8_t*, size_t, uint32_t, float*);
+        static uint16_t halfFromFloat(float);
+        static float halfToFloat(uint16_t);
+
+    public:
+        // Constructors
+        PanelMatrix();
+        PanelMatrix(const PanelMatrix&);
+        PanelMatrix& operator=(const PanelMatrix&);
+
+        // Methods
+        void pack(const Tensor&);
+        void unpack(Tensor&) const;
+        void clear();
+        void widen();
+        bool isEmpty() const;
+        bool isMapped() const;
+        bool isEncoded() const;
+        size_t getNumRows() const;
+        size_t getNumCols() const;
+
+        void writeWeights(ofstream&, const Tensor&) const;
+        void loadWeights(ifstream&, const vector<size_t>&, Tensor&);
+
+        void gemv(const float*, const float*, float*) const;
+        void gemm(const float*, size_t, const float*, float*) const;
+        void sparseGemm(const CsrTensor&, const float*, float*) const;
+        void conv2d(const Tensor&, size_t, size_t, size_t, const float*, Tensor&) const;
+
+        // Static Methods
+        static void setNumThreads(size_t);
+        static size_t getNumThreads();
+};
\ No newline at end of file
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <fstream>
+#include <cstdint>
+
+class Tensor;
+class MappedFile;
+struct WindowDims;
+
+using namespace std;
+
+// Int8 copy of row-major {rows, cols} weights with one scale per output row. Inputs are
+// quantized per tensor after dividing each channel by a smoothing factor that is folded into
+// the weights, so outlier activation channels do not flatten the others. Quantized inputs are
+// unsigned with a zero point of 128, which lets u8 x s8 dot products compile to vpdpbusd.
+class QuantizedMatrix {
+    private:
+        // Constants
+        static const size_t ROW_BLOCK;
+        static const size_t ROW_ALIGNMENT;
+        static const size_t MIN_FASTER_COLS;
+        static const int32_t MAX_LEVEL;
+        static const int32_t ZERO_POINT;
+        static const float SMOOTHING_ALPHA;
+
+        // Instance Variables
+        size_t numRows;
+        size_t numCols;
+        size_t rowStride;
+        size_t numChannels;
+        vector<int8_t> weights;
+        vector<int32_t> rowSums;
+        vector<float> outScales;
+        vector<float> channelMultipliers;
+        shared_ptr<const MappedFile> mapping;
+        const int8_t *data;
+
+        // Methods
+        vector<float> computeSmoothing(const Tensor&, const vector<float>&) const;
+        float dequantize(int32_t, size_t) const;
+        void quantizePixels(const float*, size_t, uint8_t*) const;
+
+        // Static Methods
+        static void dotBlock(const uint8_t* const*, const int8_t*, size_t, int32_t*);
+        static int32_t dotRow(const uint8_t*, const int8_t*, size_t);
+
+    public:
+        // Constructors
+        QuantizedMatrix();
+        QuantizedMatrix(const QuantizedMatrix&);
+        QuantizedMatrix& operator=(const QuantizedMatrix&);
+
+        // Methods
+        void quantize(const Tensor&, const vector<float>&);
+        void clear();
+        bool isEmpty() const;
+        size_t getRowStride() const;
+
+        void quantizeInput(const float*, size_t, uint8_t*) const;
+        void quantizeImage(const Tensor&, const WindowDims&, uint8_t*) const;
+
+        void gemv(const uint8_t*, const float*, float*) const;
+        void gemm(const uint8_t*, size_t, const float*, float*) const;
+        void conv2d(
+            const uint8_t*, const vector<size_t>&, size_t, size_t, size_t, 
+            const float*, uint8_t*, Tensor&
+        ) const;
+
+        void writeBin(ofstream&) const;
+        void loadFromBin(ifstream&);
+
+        // Static Methods
+        static bool isFaster(size_t);
+};
\ No newline at end of file
@@ -30,6 +30,8 @@ class Tensor {
 
         // Methods
         void ensureGpu();
+        void maxPool2dInternal(size_t*, size_t, size_t, size_t, Tensor&, const WindowDims&) const;
+        void toWindowMajor(vector<float>&) const;
 
     public:
 
@@ -72,6 +74,7 @@ class Tensor {
         void padWindowInput(Tensor&, const WindowDims&, float) const;
         void padAndUpsampleGrad(Tensor&, const WindowDims&, size_t) const;
         void maxPool2d(vector<size_t>&, size_t, size_t, size_t, Tensor&, const WindowDims&) const;
+        void maxPool2d(size_t, size_t, size_t, Tensor&, const WindowDims&) const;
         void maxPool2dGrad(const vector<size_t>&, Tensor&) const;
 
         void hadamard(const Tensor&);
@@ -91,6 +94,7 @@ class Tensor {
 
         // Static methods
         static Paddings decodePadding(const string&);
+        static WindowDims computeInputWindow(const vector<size_t>&, size_t, size_t, Tensor::Paddings, size_t);
 
         // Gpu Interface
         #ifdef __APPLE__
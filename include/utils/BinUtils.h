@@ -1,18 +1,76 @@
 #pragma once
 #include <string>
+#include <fstream>
+#include <cstdint>
+#include <vector>
+#include <memory>
+#include <mutex>
 
 class Pipeline;
 class NeuralNet;
+class MappedFile;
 
 using namespace std;
 
 class BinUtils {
+    public:
+        // Enums
+        enum WeightFormats : uint32_t {
+            FP32,
+            FP16,
+            BF16,
+            INT8
+        };
+
     private:
+        // Structs
+        struct ContainerHeader {
+            char magic[4];
+            uint32_t version;
+            uint32_t numSections;
+            uint32_t alignment;
+            uint64_t tableOffset;
+            uint64_t fileSize;
+            uint8_t reserved[32];
+        };
+
+        struct Section {
+            uint32_t kind;
+            uint32_t reserved;
+            uint64_t offset;
+            uint64_t size;
+            uint64_t checksum;
+        };
+
         // Constants
         static const char CANCEL;
         static const char OVERRIDE;
         static const char RENAME;
         static const string MODEL_EXTENSION;
+        static const string TEMP_EXTENSION;
+        static const uint8_t FORMAT_MARKER;
+        static const uint32_t FORMAT_REVISION;
+        static const uint32_t LEGACY_REVISION;
+        static const char CONTAINER_MAGIC[4];
+        static const uint32_t CONTAINER_VERSION;
+        static const size_t ALIGNMENT;
+        static const uint32_t STREAM_SECTION;
+        static const uint32_t FLOAT_SECTION;
+        static const uint32_t BYTE_SECTION;
+        static const uint32_t INLINE_ARRAY;
+        static const uint32_t SECTION_ARRAY;
+        static const uint64_t CHECKSUM_SEED;
+        static const uint64_t CHECKSUM_PRIME;
+
+        // Static Variables
+        static mutex fileMutex;
+        static uint32_t readRevision;
+        static bool isWritingSections;
+        static WeightFormats writeFormat;
+        static vector<Section> writeSections;
+        static shared_ptr<const MappedFile> readMapping;
+        static vector<Section> readSections;
+        static bool verifyChecksums;
         
         // Methods
         static bool fileExists(string, bool);
@@ -21,12 +79,37 @@ class BinUtils {
         static void printOptions();
         static string addExtension(const string&);
         static void checkParentDirs(const string&);
+        static void writeHeader(ofstream&);
+        static void readHeader(ifstream&);
+
+        static void writePadding(ofstream&);
+        static void finishContainer(const string&, uint64_t);
+        static bool isContainer(ifstream&);
+        static void openContainer(const string&);
+        static void writeArray(ofstream&, const void*, size_t, uint32_t);
+        static const uint8_t* readSection(ifstream&, size_t, uint32_t);
+        static uint64_t checksum(const uint8_t*, size_t, uint64_t);
+        static uint64_t streamChecksum(const uint8_t*, const vector<Section>&);
 
     public:
         // Methods
-        static void writeToBin(const Pipeline&, const string&);
+        static void writeToBin(const Pipeline&, const string&, WeightFormats = FP32);
         static void saveBestWeights(const string&, const NeuralNet&);
         static void loadBestWeights(const string&, NeuralNet&);
-        static void savePipeline(const Pipeline&, const string&);
+        static void savePipeline(const Pipeline&, const string&, WeightFormats = FP32);
         static Pipeline loadPipeline(const string&);
+        static uint32_t getReadRevision();
+
+        static bool isWritingContainer();
+        static WeightFormats getWeightFormat();
+        static void setVerifyChecksums(bool);
+        static void writeFloats(ofstream&, const float*, size_t);
+        static void readFloats(ifstream&, float*, size_t);
+        static const float* readFloats(
+            ifstream&, vector<float>&, size_t, shared_ptr<const MappedFile>&
+        );
+        static void writeBytes(ofstream&, const int8_t*, size_t);
+        static const int8_t* readBytes(
+            ifstream&, vector<int8_t>&, size_t, shared_ptr<const MappedFile>&
+        );
 };
\ No newline at end of file
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <fstream>
+#include "core/tensor/Tensor.h"
+#include "core/tensor/CsrTensor.h"
+
+class Pipeline;
+class TabularData;
+class SlotQueue;
+
+using namespace std;
+
+// Streams a CSV through a loaded tabular Pipeline with parsing, inference and writing overlapped.
+class BulkScorer {
+    private:
+        // Constants
+        static const char DELIMITER;
+        static const string PREDICTION_COL;
+
+        // Structs
+        struct Chunk {
+            size_t numRows;
+            size_t firstRecord;
+            vector<string> lines;
+            vector<string_view> rawFields;
+            vector<string_view> fields;
+            vector<size_t> inputShape;
+            Tensor input;
+            vector<uint32_t> sparseCols;
+            vector<float> sparseValues;
+            vector<size_t> rowNnz;
+            CsrTensor sparseInput;
+            vector<float> output;
+        };
+
+        // Instance Variables
+        Pipeline &pipeline;
+        TabularData *data;
+        size_t chunkRows;
+        size_t numChunks;
+        size_t parseThreads;
+        size_t inferThreads;
+        vector<Chunk> chunks;
+
+        size_t numFileCols;
+        size_t numFields;
+        size_t recordWidth;
+        size_t outputSize;
+        bool isSparse;
+        vector<size_t> fieldCols;
+        vector<string> labelNames;
+        string parseError;
+
+        // Methods
+        void prepare();
+        void splitThreads(size_t);
+        void mapColumns(const string&, const string&);
+        void prepareChunks();
+        bool splitLine(const string&, string_view*) const;
+        string describeInvalidRecord(const Chunk&, size_t) const;
+        bool encodeRow(Chunk&, size_t, float*) const;
+        bool encodeChunk(Chunk&, string&) const;
+        void gatherSparse(Chunk&) const;
+        void formatChunk(const Chunk&, string&) const;
+
+        void parseStage(ifstream&, SlotQueue&, SlotQueue&);
+        void inferStage(SlotQueue&, SlotQueue&);
+        size_t writeStage(ofstream&, SlotQueue&, SlotQueue&);
+
+    public:
+        // Constructors
+        BulkScorer(Pipeline&, size_t chunkRows = 4096, size_t numChunks = 4, size_t parseThreads = 0);
+
+        // Methods
+        size_t score(const string&, const string&, const string &targetCol = "");
+};
\ No newline at end of file
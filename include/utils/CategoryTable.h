@@ -0,0 +1,64 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <string_view>
+#include <cstdint>
+#include <fstream>
+#include <unordered_map>
+
+using namespace std;
+
+class CategoryTable {
+    private:
+        // Structs
+        struct Slot {
+            uint32_t id;
+            uint32_t start;
+            uint32_t length;
+        };
+
+        // Constants
+        static const uint32_t EMPTY_SLOT;
+        static const uint64_t HASH_SEED;
+        static const uint64_t HASH_PRIME;
+        static const uint64_t LOW_BITS;
+        static const uint64_t HIGH_BITS;
+        static const uint64_t SEED_MIX;
+        static const uint32_t MAX_SEED;
+        static const size_t KEYS_PER_BUCKET;
+
+        // Instance Variables
+        string keyArena;
+        vector<uint32_t> keyEnds;
+        vector<uint32_t> seeds;
+        vector<Slot> slots;
+
+        // Methods
+        void compile();
+        bool equalsKey(const Slot&, const char*, size_t) const;
+        size_t getBucket(uint64_t) const;
+        size_t getSlot(uint64_t, uint32_t) const;
+
+        // Static Methods
+        static uint64_t mix(uint64_t);
+        static uint64_t hashKey(const char*, size_t);
+        static size_t fastRange(uint32_t, size_t);
+        static char foldCase(char);
+        static uint64_t foldCase8(uint64_t);
+        static uint64_t loadChunk(const char*, size_t);
+        static bool isBlank(char);
+
+    public:
+        // Constructors
+        CategoryTable(const unordered_map<string, float>&);
+        CategoryTable();
+
+        // Methods
+        size_t size() const;
+        bool find(string_view, size_t&) const;
+        string_view getKey(size_t) const;
+
+        void writeBin(ofstream&) const;
+        void loadFromBin(ifstream&);
+};
\ No newline at end of file
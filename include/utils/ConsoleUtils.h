@@ -39,6 +39,7 @@ class ConsoleUtils {
         // Methods
         static void printProgressBar(ProgressMetric&);
         static void printValidationMetrics(ProgressMetric&);
+        static void printGatherBandwidth(float);
         static void loadMessage(const string&);
         static void completeMessage();
         static void printTitle();
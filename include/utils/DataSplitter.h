@@ -1,6 +1,7 @@
 #pragma once
 
 #include "core/tensor/Tensor.h"
+#include "core/data/SampleView.h"
 #include <vector>
 
 using namespace std;
@@ -14,12 +15,31 @@ struct Split {
     void clear();
 };
 
+// Views into the split source, which must outlive the split.
+struct IndexSplit {
+    SampleView xTrain;
+    SampleView xVal;
+    vector<float> yTrain;
+    vector<float> yVal;
+
+    Split materialize() const;
+    void clear();
+};
+
 class DataSplitter {
     private:
-        static Split prepareSplit(size_t, size_t, size_t, const Tensor&);
         static float clampRatio(float);
+        static IndexSplit makeSplit(
+            const SampleView&, const vector<float>&, vector<size_t>&, vector<size_t>&
+        );
 
     public:
+        static IndexSplit stratifiedIndexSplit(
+            const SampleView&, const vector<float>&, float valRatio = 0.10f
+        );
+        static IndexSplit randomIndexSplit(
+            const SampleView&, const vector<float>&, float valRatio = 0.10f
+        );
         static Split stratifiedSplit(const Tensor&, const vector<float>&, float valRatio = 0.10f);
         static Split randomSplit(const Tensor&, const vector<float>&, float valRatio = 0.10f);
 };
\ No newline at end of file
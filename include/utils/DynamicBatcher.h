@@ -0,0 +1,95 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <string_view>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <future>
+#include <functional>
+#include <chrono>
+#include "core/tensor/Tensor.h"
+#include "core/tensor/CsrTensor.h"
+#include "utils/LatencyHistogram.h"
+
+class Pipeline;
+
+using namespace std;
+
+// Groups single-record requests from many threads into batches for a loaded tabular Pipeline.
+// A batch runs once it is full or its oldest request has waited maxWaitMicros.
+class DynamicBatcher {
+    private:
+        // Structs
+        struct Request {
+            vector<string> fields;
+            promise<vector<float> > result;
+            function<void(vector<float>)> callback;
+            chrono::steady_clock::time_point enqueueTime;
+        };
+
+        struct Node {
+            atomic<Node*> next;
+            Request *request;
+        };
+
+        // Instance Variables
+        Pipeline &pipeline;
+        size_t maxBatchSize;
+        chrono::microseconds maxWait;
+        size_t numFields;
+        size_t recordWidth;
+        size_t outputSize;
+        bool isSparse;
+
+        atomic<Node*> head;
+        Node *tail;
+        atomic<bool> isStopping;
+        atomic<bool> isWaiting;
+        mutex wakeMutex;
+        condition_variable wakeUp;
+        thread worker;
+
+        vector<Request*> batch;
+        vector<string_view> fieldViews;
+        vector<size_t> inputShape;
+        Tensor input;
+        CsrTensor sparseInput;
+        vector<float> output;
+
+        mutable mutex statsMutex;
+        LatencyHistogram queueTimes;
+        LatencyHistogram computeTimes;
+        size_t numBatches;
+        size_t numRequests;
+
+        // Methods
+        void enqueue(Request*);
+        Request* dequeue();
+        bool hasRequests() const;
+        void waitForRequests(const chrono::steady_clock::time_point*);
+
+        void run();
+        bool collectBatch();
+        void processBatch();
+        void encodeBatch();
+        void recordStats(chrono::steady_clock::time_point, chrono::steady_clock::time_point);
+
+    public:
+        // Constructors
+        DynamicBatcher(Pipeline&, size_t maxBatchSize = 32, size_t maxWaitMicros = 1000);
+
+        // Destructor
+        ~DynamicBatcher();
+
+        // Methods
+        future<vector<float> > submit(vector<string>);
+        void submit(vector<string>, function<void(vector<float>)>);
+
+        LatencyHistogram getQueueTimes() const;
+        LatencyHistogram getComputeTimes() const;
+        double getMeanBatchSize() const;
+        void printStats() const;
+};
\ No newline at end of file
@@ -2,26 +2,92 @@
 
 #include <vector>
 #include <string>
+#include <string_view>
+#include <cstdint>
 #include <unordered_map>
 
 class Tensor;
+class CsrTensor;
+class CategoryTable;
 
 using namespace std;
 
 class FeatureEncoder {
     private:
+        // Constants
+        static const uint32_t FNV_OFFSET_BASIS;
+        static const uint32_t FNV_PRIME;
+        static const size_t MAX_NUMERIC_CHARS;
+
         // Methods
         static bool getValueType(const string&);
         static unordered_map<string, float> encodeFeature(const vector<vector<string> >&, size_t);
+        static size_t getCategoryWidth(const CategoryTable&, uint32_t);
 
     public:
         // Methods
+        static uint32_t hashValue(string_view);
+        static bool getCategoryIdx(const CategoryTable&, uint32_t, string_view, size_t&);
         static vector<bool> getCategoricalCols(const vector<vector<string> >&);
-        static vector<size_t> getOffsets(const vector<bool>&, const vector<unordered_map<string, float> >&, size_t, size_t&);
-        static vector<unordered_map<string, float> > encodeFeatures(const vector<vector<string> >&, const vector<bool>&);
+        static vector<size_t> getOffsets(
+            const vector<bool>&, 
+            const vector<CategoryTable>&, 
+            const vector<uint32_t>&,
+            size_t, 
+            size_t&
+        );
+        static vector<CategoryTable> encodeFeatures(
+            const vector<vector<string> >&, 
+            const vector<bool>&, 
+            const vector<uint32_t>&
+        );
         static Tensor getFeatures(
             const vector<bool>&, 
-            const vector<unordered_map<string, float> >&, 
+            const vector<CategoryTable>&, 
+            const vector<uint32_t>&,
+            const vector<vector<string> >&
+        );
+        static Tensor getCategoryIds(
+            const vector<bool>&, 
+            const vector<CategoryTable>&, 
+            const vector<uint32_t>&,
+            const vector<vector<string> >&
+        );
+        static CsrTensor getSparseFeatures(
+            const vector<bool>&, 
+            const vector<CategoryTable>&, 
+            const vector<uint32_t>&,
             const vector<vector<string> >&
         );
+
+        static bool tryParseNumeric(string_view, float&);
+        static float parseNumeric(string_view);
+        static vector<size_t> getIdOrder(const vector<bool>&);
+        static bool encodeRecord(
+            const vector<bool>&, 
+            const vector<CategoryTable>&, 
+            const vector<uint32_t>&,
+            const vector<size_t>&,
+            size_t,
+            const string_view*, 
+            float*
+        );
+        static bool encodeRecordIds(
+            const vector<bool>&, 
+            const vector<CategoryTable>&, 
+            const vector<uint32_t>&,
+            const vector<size_t>&,
+            const string_view*, 
+            float*
+        );
+        static bool encodeRecordSparse(
+            const vector<bool>&, 
+            const vector<CategoryTable>&, 
+            const vector<uint32_t>&,
+            const vector<size_t>&,
+            const string_view*, 
+            uint32_t*,
+            float*,
+            size_t&
+        );
 };
\ No newline at end of file
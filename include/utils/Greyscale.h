@@ -8,14 +8,22 @@ class Greyscale : public Scalar {
     
     public:
         // Methods
+        using Scalar::fit;
+        using Scalar::partialFit;
+        using Scalar::transform;
+
         void fit(const vector<float>&) override;
+        void partialFit(const vector<float>&) override;
 
-        Tensor transform(const Tensor&) const override;
+        void transformInPlace(Tensor&) const override;
         Tensor reverseTransform(const Tensor&) const override; 
 
         vector<float> transform(const vector<float>&)const override;
+        void transformInPlace(vector<float>&) const override;
         vector<float> reverseTransform(const vector<float>&) const override;
 
+        bool getAffine(vector<float>&, vector<float>&) const override;
+
         uint32_t getEncoding() const override;
 
         Scalar* clone() const override;
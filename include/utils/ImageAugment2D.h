@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+class Tensor;
+
+using namespace std;
+
+class ImageAugment2D {
+    private:
+        // Constants
+        static const int OUTSIDE;
+
+        // Instance Variables
+        float flipProb;
+        float maxTranslate;
+        float minCropScale;
+        float maxBrightness;
+        float maxContrast;
+        uint64_t seed;
+
+        // Methods
+        uint64_t getSampleSeed(size_t, size_t) const;
+        void buildAxis(size_t, float, float, bool, vector<int>&, vector<float>&) const;
+        void resample(const float*, float*, size_t, size_t, size_t, mt19937&) const;
+        void adjustColour(float*, size_t, mt19937&) const;
+
+    public:
+        // Constructors
+        ImageAugment2D(
+            float flipProb = 0.5f, 
+            float maxTranslate = 0.1f, 
+            float minCropScale = 0.9f,
+            float maxBrightness = 0.1f, 
+            float maxContrast = 0.1f,
+            uint64_t seed = 0
+        );
+
+        // Methods
+        void apply(Tensor&, const vector<size_t>&, size_t) const;
+};
\ No newline at end of file
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <vector>
+#include <map>
+#include <mutex>
+#include <memory>
+#include <tuple>
+
+using namespace std;
+
+struct ResizeKernel {
+    size_t taps;
+    vector<size_t> starts;
+    vector<float> weights;
+
+    void build(size_t, size_t);
+};
+
+struct ResizePlan {
+    ResizeKernel horizontal;
+    ResizeKernel vertical;
+};
+
+class ImageResizer {
+    private:
+        // Constants
+        static const float MAX_PIXEL_VALUE;
+
+        // Static Variables
+        static map<tuple<size_t, size_t, size_t, size_t>, shared_ptr<const ResizePlan> > plans;
+        static mutex plansMutex;
+
+        // Methods
+        static const ResizePlan& getPlan(size_t, size_t, size_t, size_t);
+        static const float* resizeHorizontal(
+            const unsigned char*, size_t, size_t, size_t, size_t, const ResizeKernel&
+        );
+        static unsigned char toPixel(float);
+
+    public:
+        // Methods
+        static void resize(
+            const unsigned char*, size_t, size_t, 
+            unsigned char*, size_t, size_t, size_t
+        );
+        static void resize(
+            const unsigned char*, size_t, size_t, 
+            float*, size_t, size_t, size_t, float
+        );
+        static size_t getNumCachedPlans();
+};
\ No newline at end of file
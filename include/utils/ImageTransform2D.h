@@ -3,6 +3,7 @@
 #include <vector>
 #include <fstream>
 #include "core/data/ImageData2D.h"
+#include "core/tensor/ByteTensor.h"
 
 using namespace std;
 
@@ -16,13 +17,20 @@ class ImageTransform2D {
         int width;
         int channels;
 
+        // Methods
+        void checkChannels(size_t) const;
+
     public:
         // Constructors
         ImageTransform2D(int, int, int);
         ImageTransform2D();
 
         // Methods
-        Tensor transform(const vector<RawImage>&) const;
+        Tensor transform(const RawImageSet&) const;
+        ByteTensor transformPacked(const RawImageSet&) const;
+        ByteTensor makePackedTensor(size_t) const;
+        void resizeInto(const unsigned char*, size_t, size_t, unsigned char*) const;
+        size_t getImageSize() const;
         int getHeight() const;
         int getWidth() const;
         int getChannels() const;
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <vector>
+#include <string>
+
+using namespace std;
+
+// Log2-bucketed histogram of durations in microseconds.
+class LatencyHistogram {
+    private:
+        // Constants
+        static const size_t NUM_BUCKETS;
+        static const size_t BAR_WIDTH;
+
+        // Instance Variables
+        vector<size_t> counts;
+        size_t totalCount;
+        double totalMicros;
+        double maxMicros;
+
+        // Methods
+        static double getBucketLimit(size_t);
+
+    public:
+        // Constructors
+        LatencyHistogram();
+
+        // Methods
+        void record(double);
+        size_t getCount() const;
+        double getMean() const;
+        double getMax() const;
+        double getPercentile(float) const;
+        void print(const string&) const;
+};
\ No newline at end of file
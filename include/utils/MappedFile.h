@@ -0,0 +1,26 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+
+using namespace std;
+
+class MappedFile {
+    private:
+        // Instance Variables
+        const uint8_t *data;
+        size_t size;
+
+    public:
+        // Constructors
+        MappedFile(const string&);
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        // Destructor
+        ~MappedFile();
+
+        // Methods
+        const uint8_t* getData() const;
+        size_t getSize() const;
+};
\ No newline at end of file
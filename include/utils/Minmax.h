@@ -10,20 +10,25 @@ class Minmax : public Scalar {
         // Methods
         void checkRank(const Tensor&) const;
         void checkDims(size_t) const;
+        float getScaleFactor(size_t) const;
 
     public:
         // Methods
         void fit(const Tensor&) override;
-        Tensor transform(const Tensor&) const override;
+        void partialFit(const Tensor&) override;
+        void transformInPlace(Tensor&) const override;
         Tensor reverseTransform(const Tensor&) const override;
 
         void fit(const vector<float>&) override;
-        vector<float> transform(const vector<float>&) const override;
+        void partialFit(const vector<float>&) override;
+        void transformInPlace(vector<float>&) const override;
         vector<float> reverseTransform(const vector<float>&) const override;
 
         void writeBin(ofstream&) const override;
         void loadFromBin(ifstream&) override;
 
+        bool getAffine(vector<float>&, vector<float>&) const override;
+
         uint32_t getEncoding() const override;
 
         void reset() override;
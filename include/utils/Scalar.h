@@ -4,6 +4,7 @@
 #include <cstdint>
 
 class Tensor;
+class SampleView;
 
 using namespace std;
 
@@ -12,16 +13,27 @@ class Scalar {
         // Instance Variables
         bool fitted;
 
+    protected:
+        // Methods
+        void markFitted();
+
     public:
         // Methods
         virtual void fit(const Tensor&);
-        virtual Tensor transform(const Tensor&) const = 0;
+        virtual void partialFit(const Tensor&);
+        virtual Tensor transform(const Tensor&) const;
+        virtual void transformInPlace(Tensor&) const = 0;
         virtual Tensor reverseTransform(const Tensor&) const = 0;
 
         virtual void fit(const vector<float>&);
-        virtual vector<float> transform(const vector<float>&) const = 0;
+        virtual void partialFit(const vector<float>&);
+        virtual vector<float> transform(const vector<float>&) const;
+        virtual void transformInPlace(vector<float>&) const = 0;
         virtual vector<float> reverseTransform(const vector<float>&) const = 0;
 
+        virtual bool getAffine(vector<float>&, vector<float>&) const;
+        SampleView transformView(const SampleView&) const;
+
         virtual void reset();
 
         virtual ~Scalar() = default;
@@ -39,6 +51,7 @@ class Scalar {
         enum Encodings : uint32_t {
             Greyscale,
             Minmax,
-            None
+            None,
+            Standard
         };
 };
\ No newline at end of file
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <fstream>
+#include "core/tensor/ByteTensor.h"
+
+class MappedFile;
+
+using namespace std;
+
+class ShardUtils {
+    private:
+        // Constants
+        static const uint32_t MAGIC;
+        static const uint32_t VERSION;
+        static const size_t PAGE_ALIGNMENT;
+        static const string MANIFEST_NAME;
+        static const string SHARD_PREFIX;
+        static const string SHARD_EXTENSION;
+
+        // Methods
+        static string getShardPath(const string&, size_t);
+        static size_t getDataOffset(size_t);
+        static void writeShard(const string&, const ByteTensor&, const vector<float>&, size_t, size_t);
+        static void writeManifest(
+            const string&, const ByteTensor&, const unordered_map<string, int>&, size_t, size_t
+        );
+        static uint32_t readField(const MappedFile&, size_t);
+        static const uint8_t* readShard(
+            const MappedFile&, const string&, size_t, size_t, vector<float>&, size_t
+        );
+
+    public:
+        // Methods
+        static void writeShards(
+            const string&, const ByteTensor&, const vector<float>&, 
+            const unordered_map<string, int>&, size_t
+        );
+        static ByteTensor readShards(const string&, vector<float>&, unordered_map<string, int>&);
+};
\ No newline at end of file
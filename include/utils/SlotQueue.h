@@ -0,0 +1,30 @@
+#pragma once
+
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+
+using namespace std;
+
+// Bounded blocking FIFO of buffer slot indices used to hand work between pipeline stages.
+class SlotQueue {
+    private:
+        // Instance Variables
+        vector<size_t> slots;
+        size_t head;
+        size_t count;
+        bool closed;
+
+        mutex queueMutex;
+        condition_variable notEmpty;
+        condition_variable notFull;
+
+    public:
+        // Constructors
+        SlotQueue(size_t);
+
+        // Methods
+        void push(size_t);
+        bool pop(size_t&);
+        void close();
+};
\ No newline at end of file
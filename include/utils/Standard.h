@@ -0,0 +1,50 @@
+#pragma once
+#include "utils/Scalar.h"
+
+class Standard : public Scalar {
+    private:
+        // Instance Variables
+        uint64_t count;
+        vector<double> means;
+        vector<double> sumSquares;
+
+        vector<float> meanVals;
+        vector<float> stdVals;
+
+        // Methods
+        void checkRank(const Tensor&) const;
+        void checkDims(size_t) const;
+        void accumulate(const float*, size_t, size_t);
+        void mergeStats(const Standard&);
+        void updateScaling();
+
+    public:
+        // Constructors
+        Standard();
+
+        // Methods
+        void fit(const Tensor&) override;
+        void partialFit(const Tensor&) override;
+        void transformInPlace(Tensor&) const override;
+        Tensor reverseTransform(const Tensor&) const override;
+
+        void fit(const vector<float>&) override;
+        void partialFit(const vector<float>&) override;
+        void transformInPlace(vector<float>&) const override;
+        vector<float> reverseTransform(const vector<float>&) const override;
+
+        bool getAffine(vector<float>&, vector<float>&) const override;
+        void merge(const Standard&);
+
+        const vector<float>& getMeans() const;
+        const vector<float>& getStds() const;
+
+        void writeBin(ofstream&) const override;
+        void loadFromBin(ifstream&) override;
+
+        uint32_t getEncoding() const override;
+
+        void reset() override;
+
+        Scalar* clone() const override;
+};
\ No newline at end of file
@@ -29,7 +29,7 @@ void Softmax::activateRow(
     size_t numCols
 ) const {
 
-    vector<float> exps(numCols, 0.0);
+    float *exps = activations.data() + row * numCols;
     float totalSum = 0;
     float maxPreAct = getMaxPreActivation(z, row, numCols);
 
@@ -39,7 +39,7 @@ void Softmax::activateRow(
     }
 
     for (size_t j = 0; j < numCols; j++) { 
-        activations[row * numCols + j] =  exps[j]/totalSum;
+        exps[j] /= totalSum;
     }
 }
 
@@ -4,6 +4,7 @@
 #include "core/activations/Activation.h"
 #include "core/tensor/Matrix.h"
 #include "core/gpu/GpuEngine.h"
+#include "utils/ImageAugment2D.h"
 #include <cstring>
 
 Batch::Batch(size_t numLayers, size_t batchSize) :
@@ -33,29 +34,29 @@ void Batch::ensureGpu() {
 }
 
 void Batch::setBatch(
-    const Tensor &train,
-    const vector<float> &trainLabels
+    const SampleView &train,
+    const vector<float> &trainLabels,
+    const ImageAugment2D *augment,
+    size_t epoch
 ) {
-    const vector<size_t> &trainShape = train.getShape();
-    vector<size_t> batchShape = trainShape;
-    batchShape[0] = batchSize;
-    data = Tensor(batchShape);
-    
-    size_t elementSize = data.getSize() / batchSize;
+    if (train.isSparse()) {
+        sparseData = train.gatherSparse(indices.data(), batchSize);
+    } else {
+        vector<size_t> batchShape = train.getShape();
+        batchShape[0] = batchSize;
+        data = Tensor(batchShape);
+        train.gather(indices.data(), batchSize, data.getFlat().data());
+    }
 
-    vector<float> &batchFlat = data.getFlat();
     vector<float> &targetsFlat = targets.getFlat();
-    const vector<float> &trainFlat = train.getFlat();
     
     #pragma omp parallel for
     for (size_t i = 0; i < batchSize; i++) {
-        size_t rdIdx = indices[i];
-        memcpy(
-            batchFlat.data() + (i * elementSize), 
-            trainFlat.data() + (rdIdx * elementSize), 
-            elementSize * sizeof(float)
-        );
-        targetsFlat[i] = trainLabels[rdIdx];
+        targetsFlat[i] = trainLabels[indices[i]];
+    }
+
+    if (augment != nullptr && !train.isSparse()) {
+        augment->apply(data, indices, epoch);
     }
     ensureGpu();
 }
@@ -64,12 +65,20 @@ const Tensor& Batch::getData() const {
     return data;
 }
 
+const CsrTensor& Batch::getSparseData() const {
+    return sparseData;
+}
+
+bool Batch::isSparse() const {
+    return sparseData.getNumRows() > 0;
+}
+
 const Tensor& Batch::getTargets() const {
     return targets;
 }
 
 size_t Batch::getSize() const {
-    return data.getShape()[0];
+    return batchSize;
 }
 
 const vector<size_t>& Batch::getIndices() const {
@@ -7,58 +7,178 @@
 #include "utils/ConsoleUtils.h"
 #include <iostream>
 #include "utils/CsvUtils.h"
+#include "utils/ImageTransform2D.h"
+#include "utils/ShardUtils.h"
+#include <omp.h>
+#include <cstring>
 
 using namespace std;
 namespace fs = filesystem;
 
+const size_t ImageData2D::MAX_IN_FLIGHT_BYTES = 256 * 1024 * 1024;
+
 ImageData2D::ImageData2D(size_t channels) : channels(channels) {}
 
 ImageData2D::ImageData2D() : channels(0) {}
 
+const unsigned char* RawImageSet::getPixels(size_t idx) const {
+    return pixels.data() + images[idx].offset;
+}
+
+size_t RawImageSet::size() const {
+    return images.size();
+}
+
+void RawImageSet::clear() {
+    vector<unsigned char>().swap(pixels);
+    vector<RawImage>().swap(images);
+}
+
 void ImageData2D::scanDirectory(
     vector<string> &paths,
     vector<string> &labels,
     const string &path
 ) const {
     ConsoleUtils::loadMessage("Scanning Image Directories.");
+    vector<fs::path> labelDirs;
     for (const auto &labelDir : fs::directory_iterator(path)) {
+        if (labelDir.is_directory()) {
+            labelDirs.push_back(labelDir.path());
+        }
+    }
 
-        if (!labelDir.is_directory()) continue;
+    size_t numDirs = labelDirs.size();
+    vector<vector<string> > dirPaths(numDirs);
 
-        string label = labelDir.path().filename().string();
-        for (const auto &image : fs::directory_iterator(labelDir.path())) {
-            paths.push_back(image.path().string());
-            labels.push_back(label);
+    #pragma omp parallel for schedule(dynamic)
+    for (size_t i = 0; i < numDirs; i++) {
+        for (const auto &image : fs::directory_iterator(labelDirs[i])) {
+            dirPaths[i].push_back(image.path().string());
         }
     }
+
+    for (size_t i = 0; i < numDirs; i++) {
+        string label = labelDirs[i].filename().string();
+        paths.insert(paths.end(), dirPaths[i].begin(), dirPaths[i].end());
+        labels.insert(labels.end(), dirPaths[i].size(), label);
+    }
     ConsoleUtils::completeMessage();
 }
 
+size_t ImageData2D::probeImages(
+    RawImageSet &features,
+    const vector<string> &paths
+) const {
+    size_t numImages = paths.size();
+    features.images.resize(numImages);
+    size_t maxImageBytes = 0;
+
+    #pragma omp parallel for schedule(dynamic) reduction(max:maxImageBytes)
+    for (size_t n = 0; n < numImages; n++) {
+        int w, h, c;
+        if (!stbi_info(paths[n].c_str(), &w, &h, &c)) {
+            ConsoleUtils::fatalError("Could not load image: " + paths[n]);
+        }
+
+        RawImage &image = features.images[n];
+        image.width = w;
+        image.height = h;
+        image.channels = channels;
+
+        size_t imageBytes = image.width * image.height * image.channels;
+        if (imageBytes > maxImageBytes) maxImageBytes = imageBytes;
+    }
+
+    size_t offset = 0;
+    for (size_t n = 0; n < numImages; n++) {
+        RawImage &image = features.images[n];
+        image.offset = offset;
+        offset += image.width * image.height * image.channels;
+    }
+
+    features.pixels.resize(offset);
+    return maxImageBytes;
+}
+
+int ImageData2D::getDecodeThreads(size_t maxImageBytes) const {
+    size_t maxThreads = omp_get_max_threads();
+    if (maxImageBytes == 0) {
+        return (int) maxThreads;
+    }
+
+    size_t budgetThreads = MAX_IN_FLIGHT_BYTES / maxImageBytes;
+    return (int) max((size_t) 1, min(budgetThreads, maxThreads));
+}
+
 void ImageData2D::extractImages(
-    vector<RawImage> &features, 
+    RawImageSet &features, 
     const vector<string> &paths
 ) const{
     ConsoleUtils::loadMessage("Extracting Images.");
-    features.reserve(paths.size());
-    for (const string &imgPath : paths) {
+    size_t maxImageBytes = probeImages(features, paths);
+    int numThreads = getDecodeThreads(maxImageBytes);
+    size_t numImages = paths.size();
+
+    #pragma omp parallel for schedule(dynamic) num_threads(numThreads)
+    for (size_t n = 0; n < numImages; n++) {
+        const RawImage &image = features.images[n];
         int w, h, c;
         unsigned char *input = stbi_load(
-            imgPath.c_str(),
+            paths[n].c_str(),
             &w, &h, &c,
             channels
         );
 
         if (!input) {
-            ConsoleUtils::fatalError("Could not load image: " + imgPath);
+            ConsoleUtils::fatalError("Could not load image: " + paths[n]);
         }
 
-        RawImage rawImage;
-        rawImage.width = w;
-        rawImage.height = h;
-        rawImage.channels = channels;
-        rawImage.pixels.assign(input, input + (w*h*channels));
-        features.push_back(rawImage);
+        if ((size_t) w != image.width || (size_t) h != image.height) {
+            ConsoleUtils::fatalError("Image header does not match decoded size: " + paths[n]);
+        }
+
+        memcpy(
+            features.pixels.data() + image.offset, 
+            input, 
+            image.width * image.height * image.channels
+        );
+        stbi_image_free(input);
+    }
+    ConsoleUtils::completeMessage();
+}
+
+void ImageData2D::extractPackedImages(
+    ByteTensor &images,
+    const vector<string> &paths,
+    const ImageTransform2D &transformer
+) const {
+    ConsoleUtils::loadMessage("Extracting & Resizing Images.");
+    if ((size_t) transformer.getChannels() != channels) {
+        ConsoleUtils::fatalError(
+            "Channel mismatch: requested " + std::to_string(transformer.getChannels()) +
+            " but data reads " + std::to_string(channels) + " channels."
+        );
+    }
+
+    size_t numImages = paths.size();
+    size_t imageSize = transformer.getImageSize();
+    images = transformer.makePackedTensor(numImages);
+    unsigned char *imageData = images.getData();
+
+    #pragma omp parallel for schedule(dynamic)
+    for (size_t n = 0; n < numImages; n++) {
+        int w, h, c;
+        unsigned char *input = stbi_load(
+            paths[n].c_str(),
+            &w, &h, &c,
+            channels
+        );
+
+        if (!input) {
+            ConsoleUtils::fatalError("Could not load image: " + paths[n]);
+        }
 
+        transformer.resizeInto(input, w, h, imageData + n * imageSize);
         stbi_image_free(input);
     }
     ConsoleUtils::completeMessage();
@@ -75,7 +195,7 @@ void ImageData2D::extractLabels(vector<float> &targets, const vector<string> &la
 }
 
 void ImageData2D::read(
-    vector<RawImage> &features, 
+    RawImageSet &features, 
     vector<float> &targets, 
     const string &path
 ) {
@@ -87,6 +207,20 @@ void ImageData2D::read(
     ConsoleUtils::printSepLine();
 }
 
+void ImageData2D::readPacked(
+    ByteTensor &images,
+    vector<float> &targets,
+    const string &path,
+    const ImageTransform2D &transformer
+) {
+    vector<string> paths;
+    vector<string> labels;
+    scanDirectory(paths, labels, path);
+    extractPackedImages(images, paths, transformer);
+    extractLabels(targets, labels);
+    ConsoleUtils::printSepLine();
+}
+
 void ImageData2D::readTrain(const string &path) {
     cout << endl << "📥 Loading training data from: \"" << CsvUtils::trimFilePath(path) << "\"." << endl;
     read(trainFeatures, trainTargets, path);
@@ -97,24 +231,115 @@ void ImageData2D::readTest(const string &path) {
     read(testFeatures, testTargets, path);
 }
 
+void ImageData2D::readTrain(const string &path, const ImageTransform2D &transformer) {
+    cout << endl << "📥 Loading training data from: \"" << CsvUtils::trimFilePath(path) << "\"." << endl;
+    readPacked(trainImages, trainTargets, path, transformer);
+}
+
+void ImageData2D::readTest(const string &path, const ImageTransform2D &transformer) {
+    cout << endl << "📥 Loading testing data from: \"" << CsvUtils::trimFilePath(path) << "\"." << endl;
+    readPacked(testImages, testTargets, path, transformer);
+}
+
+void ImageData2D::readShards(
+    ByteTensor &images,
+    vector<float> &targets,
+    const string &path
+) {
+    unordered_map<string, int> shardLabelMap;
+    images = ShardUtils::readShards(path, targets, shardLabelMap);
+
+    if (labelMap.empty()) {
+        labelMap = shardLabelMap;
+    } else if (shardLabelMap != labelMap) {
+        vector<float> remap(shardLabelMap.size());
+        for (const pair<const string, int> &pair : shardLabelMap) {
+            auto it = labelMap.find(pair.first);
+            if (it == labelMap.end()) {
+                ConsoleUtils::fatalError("Unknown label \"" + pair.first + "\" in image shards.");
+            }
+            remap[pair.second] = (float) it->second;
+        }
+
+        size_t numTargets = targets.size();
+        for (size_t i = 0; i < numTargets; i++) {
+            targets[i] = remap[(size_t) targets[i]];
+        }
+    }
+
+    if (images.getShape()[3] != channels) {
+        ConsoleUtils::fatalError(
+            "Channel mismatch: requested " + std::to_string(channels) +
+            " but shards provide " + std::to_string(images.getShape()[3]) + "."
+        );
+    }
+    ConsoleUtils::printSepLine();
+}
+
+void ImageData2D::writeShards(
+    const ByteTensor &images,
+    const vector<float> &targets,
+    const string &path,
+    size_t recordsPerShard
+) const {
+    if (images.getSize() == 0) {
+        ConsoleUtils::fatalError(
+            "Shards are written from packed images. Read the data with an ImageTransform2D first."
+        );
+    }
+
+    ShardUtils::writeShards(path, images, targets, labelMap, recordsPerShard);
+    ConsoleUtils::printSepLine();
+}
+
+void ImageData2D::readTrainShards(const string &path) {
+    cout << endl << "📥 Loading training shards from: \"" << CsvUtils::trimFilePath(path) << "\"." << endl;
+    readShards(trainImages, trainTargets, path);
+}
+
+void ImageData2D::readTestShards(const string &path) {
+    cout << endl << "📥 Loading testing shards from: \"" << CsvUtils::trimFilePath(path) << "\"." << endl;
+    readShards(testImages, testTargets, path);
+}
+
+void ImageData2D::writeTrainShards(const string &path, size_t recordsPerShard) const {
+    cout << endl << "📦 Packing training shards to: \"" << CsvUtils::trimFilePath(path) << "\"." << endl;
+    writeShards(trainImages, trainTargets, path, recordsPerShard);
+}
+
+void ImageData2D::writeTestShards(const string &path, size_t recordsPerShard) const {
+    cout << endl << "📦 Packing testing shards to: \"" << CsvUtils::trimFilePath(path) << "\"." << endl;
+    writeShards(testImages, testTargets, path, recordsPerShard);
+}
+
 void ImageData2D::clearTrain() {
     trainFeatures.clear();
+    trainImages.clear();
     vector<float>().swap(trainTargets);
 }
 
 void ImageData2D::clearTest() {
     testFeatures.clear();
+    testImages.clear();
     vector<float>().swap(testTargets);
 }
 
-const vector<RawImage>& ImageData2D::getTrainFeatures() const {
+const RawImageSet& ImageData2D::getTrainFeatures() const {
     return trainFeatures;
 }
 
-const vector<RawImage>& ImageData2D::getTestFeatures() const {
+const RawImageSet& ImageData2D::getTestFeatures() const {
     return testFeatures;
 }
 
+const ByteTensor& ImageData2D::getTrainImages() const {
+    return trainImages;
+}
+
+const ByteTensor& ImageData2D::getTestImages() const {
+    return testImages;
+}
+
 const vector<float>& ImageData2D::getTrainTargets() const {
     return trainTargets;
 }
@@ -124,6 +349,10 @@ const vector<float>& ImageData2D::getTestTargets() const {
 }
 
 size_t ImageData2D::getNumTrainSamples() const {
+    if (trainImages.getSize() != 0) {
+        return trainImages.getShape()[0];
+    }
+
     return trainFeatures.size();
 }
 
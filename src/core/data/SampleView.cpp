@@ -0,0 +1,230 @@
+#include "core/data/SampleView.h"
+#include "core/tensor/Tensor.h"
+#include "core/tensor/ByteTensor.h"
+#include "core/tensor/CsrTensor.h"
+#include "utils/ConsoleUtils.h"
+#include <cstring>
+
+SampleView::SampleView(const Tensor &source) : 
+    floatSource(&source), 
+    byteSource(nullptr),
+    sparseSource(nullptr),
+    shape(source.getShape()),
+    sampleSize(0)
+{
+    if (!shape.empty() && shape[0] != 0) {
+        sampleSize = source.getSize() / shape[0];
+    }
+}
+
+SampleView::SampleView(const ByteTensor &source) : 
+    floatSource(nullptr), 
+    byteSource(&source),
+    sparseSource(nullptr),
+    shape(source.getShape()),
+    sampleSize(source.getSampleSize())
+{}
+
+SampleView::SampleView(const CsrTensor &source) : 
+    floatSource(nullptr), 
+    byteSource(nullptr),
+    sparseSource(&source),
+    shape(source.getShape()),
+    sampleSize(source.getNumCols())
+{}
+
+SampleView::SampleView(const SampleView &base, const vector<size_t> &rows) :
+    floatSource(base.floatSource),
+    byteSource(base.byteSource),
+    sparseSource(base.sparseSource),
+    affineScale(base.affineScale),
+    affineShift(base.affineShift),
+    shape(base.shape),
+    sampleSize(base.sampleSize)
+{
+    size_t numRows = rows.size();
+    shared_ptr<vector<size_t> > sourceRows = make_shared<vector<size_t> >(numRows);
+
+    #pragma omp parallel for
+    for (size_t i = 0; i < numRows; i++) {
+        (*sourceRows)[i] = base.getSourceIndex(rows[i]);
+    }
+
+    indices = sourceRows;
+    if (!shape.empty()) {
+        shape[0] = numRows;
+    }
+}
+
+SampleView::SampleView() : 
+    floatSource(nullptr), byteSource(nullptr), sparseSource(nullptr), sampleSize(0) {}
+
+const vector<size_t>& SampleView::getShape() const {
+    return shape;
+}
+
+size_t SampleView::getNumSamples() const {
+    if (shape.empty()) {
+        return 0;
+    }
+
+    return shape[0];
+}
+
+size_t SampleView::getSampleSize() const {
+    return sampleSize;
+}
+
+size_t SampleView::getSampleBytes() const {
+    if (floatSource != nullptr) {
+        return sampleSize * sizeof(float);
+    }
+
+    if (sparseSource != nullptr) {
+        size_t numRows = sparseSource->getNumRows();
+        size_t nnzBytes = sparseSource->getNnz() * (sizeof(float) + sizeof(uint32_t));
+        return (numRows > 0) ? nnzBytes / numRows : 0;
+    }
+
+    return sampleSize;
+}
+
+size_t SampleView::getSourceIndex(size_t row) const {
+    if (indices) {
+        return (*indices)[row];
+    }
+
+    return row;
+}
+
+bool SampleView::isEmpty() const {
+    return getNumSamples() == 0;
+}
+
+bool SampleView::isSparse() const {
+    return sparseSource != nullptr;
+}
+
+void SampleView::dequantize(const uint8_t *src, float *dst, size_t size) const {
+    float scale = byteSource->getScale();
+    float shift = byteSource->getShift();
+
+    #pragma omp simd
+    for (size_t i = 0; i < size; i++) {
+        dst[i] = (float) src[i] * scale + shift;
+    }
+}
+
+void SampleView::copySample(size_t sourceRow, float *dst) const {
+    if (floatSource != nullptr) {
+        const float *src = floatSource->getFlat().data() + sourceRow * sampleSize;
+        memcpy(dst, src, sampleSize * sizeof(float));
+    } else if (sparseSource != nullptr) {
+        sparseSource->densifyRow(sourceRow, dst);
+    } else {
+        dequantize(byteSource->getSample(sourceRow), dst, sampleSize);
+    }
+
+    if (affineScale) {
+        applyAffine(dst);
+    }
+}
+
+void SampleView::applyAffine(float *dst) const {
+    const float *scale = affineScale->data();
+    const float *shift = affineShift->data();
+
+    if (affineScale->size() == 1) {
+        float scaleVal = scale[0];
+        float shiftVal = shift[0];
+
+        #pragma omp simd
+        for (size_t i = 0; i < sampleSize; i++) {
+            dst[i] = dst[i] * scaleVal + shiftVal;
+        }
+        return;
+    }
+
+    #pragma omp simd
+    for (size_t i = 0; i < sampleSize; i++) {
+        dst[i] = dst[i] * scale[i] + shift[i];
+    }
+}
+
+SampleView SampleView::withAffine(const vector<float> &scale, const vector<float> &shift) const {
+    if (scale.size() != shift.size() || (scale.size() != 1 && scale.size() != sampleSize)) {
+        ConsoleUtils::fatalError(
+            "Affine transform size " + to_string(scale.size()) + 
+            " does not match sample size " + to_string(sampleSize) + "."
+        );
+    }
+
+    if (affineScale) {
+        ConsoleUtils::fatalError("Sample view already has an affine transform.");
+    }
+
+    SampleView view = *this;
+
+    view.affineScale = make_shared<const vector<float> >(scale);
+    view.affineShift = make_shared<const vector<float> >(shift);
+    return view;
+}
+
+void SampleView::gather(const size_t *rows, size_t count, float *dst) const {
+    #pragma omp parallel for
+    for (size_t i = 0; i < count; i++) {
+        copySample(getSourceIndex(rows[i]), dst + i * sampleSize);
+    }
+}
+
+void SampleView::gatherRange(size_t start, size_t count, float *dst) const {
+    if (floatSource != nullptr && !indices && !affineScale) {
+        const float *src = floatSource->getFlat().data() + start * sampleSize;
+        memcpy(dst, src, count * sampleSize * sizeof(float));
+        return;
+    }
+
+    #pragma omp parallel for
+    for (size_t i = 0; i < count; i++) {
+        copySample(getSourceIndex(start + i), dst + i * sampleSize);
+    }
+}
+
+CsrTensor SampleView::gatherSparse(const size_t *rows, size_t count) const {
+    if (sparseSource == nullptr) {
+        ConsoleUtils::fatalError("Sparse gather requires a sparse feature source.");
+    }
+
+    if (affineScale) {
+        ConsoleUtils::fatalError(
+            "Affine transforms are not supported on sparse features.\n"
+            "Scaling would destroy sparsity; scale numeric columns before encoding."
+        );
+    }
+
+    vector<size_t> sourceRows(count);
+    for (size_t i = 0; i < count; i++) {
+        sourceRows[i] = getSourceIndex(rows[i]);
+    }
+
+    return sparseSource->gatherRows(sourceRows.data(), count);
+}
+
+CsrTensor SampleView::gatherRangeSparse(size_t start, size_t count) const {
+    vector<size_t> rows(count);
+    for (size_t i = 0; i < count; i++) {
+        rows[i] = start + i;
+    }
+
+    return gatherSparse(rows.data(), count);
+}
+
+Tensor SampleView::materialize() const {
+    if (isEmpty()) {
+        return Tensor();
+    }
+
+    Tensor output = Tensor(shape);
+    gatherRange(0, getNumSamples(), output.getFlat().data());
+    return output;
+}
\ No newline at end of file
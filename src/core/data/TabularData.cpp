@@ -10,6 +10,7 @@
 #include "utils/TrainingUtils.h"
 #include <cstdint>
 #include "utils/TargetEncoder.h"
+#include "utils/BinUtils.h"
 
 const string TabularData::NO_TARGET_COL = "";
 const size_t TabularData::NO_TARGET_IDX = numeric_limits<size_t>::max();
@@ -18,7 +19,7 @@ const string TabularData::REGRESSION_TASK = "regression";
 const string TabularData::CLASSIFICATION_TASK = "classification";
 
 TabularData::TabularData(const string &taskType) : 
-    isTrainLoaded(false), isTestLoaded(false), isLoadedFromModel(false) {
+    recordWidth(0), isTrainLoaded(false), isTestLoaded(false), isLoadedFromModel(false), featureFormat(OneHot) {
     string taskFormatted = CsvUtils::toLowerCase(CsvUtils::trim(taskType));
 
     if (taskFormatted != REGRESSION_TASK && taskFormatted != CLASSIFICATION_TASK) {
@@ -31,7 +32,7 @@ TabularData::TabularData(const string &taskType) :
     task = taskFormatted;
 }
 
-TabularData::TabularData() {}
+TabularData::TabularData() : recordWidth(0), featureFormat(OneHot) {}
 
 void TabularData::checkTrainLoaded() const {
     if (!isTrainLoaded) {
@@ -51,6 +52,178 @@ void TabularData::checkTestLoaded() const {
     }
 }
 
+void TabularData::checkDenseFeatures() const {
+    if (featureFormat == Sparse) {
+        ConsoleUtils::fatalError(
+            "Features were loaded in sparse format.\n"
+            "Use getTrainSparseFeatures() or getTestSparseFeatures() instead."
+        );
+    }
+}
+
+void TabularData::checkSparseFeatures() const {
+    if (featureFormat != Sparse) {
+        ConsoleUtils::fatalError(
+            "Features were loaded in dense format.\n"
+            "Call setSparseFeatures(true) before reading data."
+        );
+    }
+}
+
+void TabularData::setSparseFeatures(bool sparse) {
+    setFeatureFormat(sparse ? Sparse : OneHot);
+}
+
+void TabularData::setCategoryIds(bool ids) {
+    setFeatureFormat(ids ? CategoryIds : OneHot);
+}
+
+void TabularData::setFeatureFormat(FeatureFormats format) {
+    if (isTrainLoaded || isTestLoaded) {
+        ConsoleUtils::fatalError("Feature format must be set before reading data.");
+    }
+
+    featureFormat = format;
+}
+
+TabularData::FeatureFormats TabularData::getFeatureFormat() const {
+    return featureFormat;
+}
+
+// Hashes the given feature column (target excluded) into a fixed number of one-hot buckets.
+void TabularData::setHashBuckets(size_t featureIdx, size_t numBuckets) {
+    if (isTrainLoaded || isTestLoaded || !featureEncodings.empty()) {
+        ConsoleUtils::fatalError("Hashed columns must be set before reading training data.");
+    }
+
+    if (hashBuckets.size() <= featureIdx) {
+        hashBuckets.resize(featureIdx + 1, 0);
+    }
+
+    hashBuckets[featureIdx] = (uint32_t) numBuckets;
+}
+
+// One embedding row per seen category plus a trailing out-of-vocabulary row.
+vector<size_t> TabularData::getCardinalities() const {
+    vector<size_t> cardinalities;
+    size_t numCols = isCategorical.size();
+    for (size_t j = 0; j < numCols; j++) {
+        if (j < hashBuckets.size() && hashBuckets[j] > 0) {
+            cardinalities.push_back(hashBuckets[j]);
+        } else if (isCategorical[j]) {
+            cardinalities.push_back(featureEncodings[j].size() + 1);
+        }
+    }
+
+    return cardinalities;
+}
+
+// Caches the encoded column layout so that single records can be encoded without allocating.
+void TabularData::prepareRecords() {
+    if (isCategorical.empty() || featureEncodings.empty()) {
+        ConsoleUtils::fatalError(
+            "Record encoding requires fitted feature encodings.\n"
+            "Please read training data or load a saved pipeline first."
+        );
+    }
+
+    size_t numCols = isCategorical.size();
+    hashBuckets.resize(numCols, 0);
+
+    recordWidth = 0;
+    recordOffsets = FeatureEncoder::getOffsets(
+        isCategorical, featureEncodings, hashBuckets, numCols, recordWidth
+    );
+    recordOrder = FeatureEncoder::getIdOrder(isCategorical);
+
+    if (featureFormat == CategoryIds) {
+        recordWidth = numCols;
+    }
+}
+
+size_t TabularData::getNumFeatureFields() const {
+    return isCategorical.size();
+}
+
+size_t TabularData::getRecordWidth() const {
+    return recordWidth;
+}
+
+// The record encoders return false if a numeric field does not parse.
+bool TabularData::encodeRecord(const string_view *fields, float *dst) const {
+    if (featureFormat == CategoryIds) {
+        return FeatureEncoder::encodeRecordIds(
+            isCategorical, featureEncodings, hashBuckets, recordOrder, fields, dst
+        );
+    }
+
+    return FeatureEncoder::encodeRecord(
+        isCategorical, featureEncodings, hashBuckets, recordOffsets, recordWidth, fields, dst
+    );
+}
+
+// cols and values must hold getNumFeatureFields() entries.
+bool TabularData::encodeSparseRecord(
+    const string_view *fields, 
+    uint32_t *cols, 
+    float *values, 
+    size_t &nnz
+) const {
+    return FeatureEncoder::encodeRecordSparse(
+        isCategorical, featureEncodings, hashBuckets, recordOffsets, fields, cols, values, nnz
+    );
+}
+
+// Encodes straight into the tail of dst, which stays within its reserved capacity.
+bool TabularData::encodeSparseRecord(const string_view *fields, CsrTensor &dst) const {
+    vector<uint32_t> &colIdx = dst.getColIdx();
+    vector<float> &values = dst.getValues();
+    size_t start = values.size();
+    size_t numFields = getNumFeatureFields();
+    colIdx.resize(start + numFields);
+    values.resize(start + numFields);
+
+    size_t nnz = 0;
+    bool isValid = encodeSparseRecord(fields, colIdx.data() + start, values.data() + start, nnz);
+    colIdx.resize(start + nnz);
+    values.resize(start + nnz);
+    if (isValid) {
+        dst.finishRow();
+    }
+
+    return isValid;
+}
+
+// Exits naming the first numeric field of a record that failed to encode.
+void TabularData::reportInvalidRecord(const string_view *fields) const {
+    size_t numFields = getNumFeatureFields();
+    for (size_t j = 0; j < numFields; j++) {
+        if (!isCategorical[j]) {
+            FeatureEncoder::parseNumeric(fields[j]);
+        }
+    }
+
+    ConsoleUtils::fatalError("Record could not be encoded.");
+}
+
+const vector<string>& TabularData::getHeader() const {
+    return header;
+}
+
+// Label names indexed by their encoded class id.
+vector<string> TabularData::getLabelNames() const {
+    vector<string> labelNames(labelMap.size());
+    for (const pair<const string, int> &label : labelMap) {
+        labelNames[label.second] = label.first;
+    }
+
+    return labelNames;
+}
+
+bool TabularData::isClassification() const {
+    return task == CLASSIFICATION_TASK;
+}
+
 void TabularData::readTrain(const string &filename, size_t targetIdx, bool hasHeader) {
     cout << endl << "📥 Loading training data from: \"" << CsvUtils::trimFilePath(filename) << "\"." << endl;
     readCsv(filename, true, targetIdx, NO_TARGET_COL, hasHeader);
@@ -77,14 +250,28 @@ void TabularData::readTest(const string &filename, const string &colname) {
 
 const Tensor& TabularData::getTrainFeatures() const {
     checkTrainLoaded();
+    checkDenseFeatures();
     return trainFeatures;
 }
 
 const Tensor& TabularData::getTestFeatures() const {
     checkTestLoaded();
+    checkDenseFeatures();
     return testFeatures;
 }
 
+const CsrTensor& TabularData::getTrainSparseFeatures() const {
+    checkTrainLoaded();
+    checkSparseFeatures();
+    return trainSparseFeatures;
+}
+
+const CsrTensor& TabularData::getTestSparseFeatures() const {
+    checkTestLoaded();
+    checkSparseFeatures();
+    return testSparseFeatures;
+}
+
 const vector<float>& TabularData::getTrainTargets() const {
     checkTrainLoaded();
     return trainTargets;
@@ -97,6 +284,10 @@ const vector<float>& TabularData::getTestTargets() const {
 
 size_t TabularData::getNumTrainSamples() const {
     checkTrainLoaded();
+    if (featureFormat == Sparse) {
+        return trainSparseFeatures.getNumRows();
+    }
+
     return trainFeatures.M().getNumRows();
 }
 
@@ -106,21 +297,31 @@ Data::Encodings TabularData::getEncoding() const {
 
 void TabularData::headTrain(size_t numRows) const {
     checkTrainLoaded();
-    head(numRows, trainFeatures);
+    if (featureFormat == Sparse) {
+        headSparse(numRows, trainSparseFeatures);
+    } else {
+        head(numRows, trainFeatures);
+    }
 }
 
 void TabularData::headTest(size_t numRows) const {
     checkTestLoaded();
-    head(numRows, testFeatures);
+    if (featureFormat == Sparse) {
+        headSparse(numRows, testSparseFeatures);
+    } else {
+        head(numRows, testFeatures);
+    }
 }
 
 void TabularData::clearTrain() {
     trainFeatures.clear();
+    trainSparseFeatures.clear();
     vector<float>().swap(trainTargets);
 }
 
 void TabularData::clearTest() {
     testFeatures.clear();
+    testSparseFeatures.clear();
     vector<float>().swap(testTargets);
 }
 
@@ -156,6 +357,29 @@ void TabularData::head(
     }
 }
 
+void TabularData::headSparse(size_t numRows, const CsrTensor &mat) const {
+    size_t numHeadRows = min(numRows, mat.getNumRows());
+    vector<size_t> rows(numHeadRows);
+    for (size_t i = 0; i < numHeadRows; i++) {
+        rows[i] = i;
+    }
+
+    cout << "Sparse data shape: " << mat.getNumRows() << " x " << mat.getNumCols() 
+         << " (" << mat.getNnz() << " non-zero entries)." << endl;
+    Tensor headRows = mat.gatherRows(rows.data(), numHeadRows).toDense();
+    head(numRows, headRows);
+}
+
+void TabularData::setSparseData(const CsrTensor &features, vector<float> &target, bool isTrainData) {
+    if (isTrainData) {
+        trainSparseFeatures = features;
+        trainTargets = target;
+    } else {
+        testSparseFeatures = features;
+        testTargets = target;
+    }
+}
+
 void TabularData::setData(const Tensor &features, vector<float> &target, bool isTrainData) {
     if (isTrainData) {
         trainFeatures = features;
@@ -226,10 +450,15 @@ void TabularData::readCsv(
     vector<string> targetsRaw;
     parseRawData(featuresRaw, targetsRaw, lines, targetIdx);
 
-    Tensor features = readFeatures(featuresRaw);
-    vector<float> target = readTargets(targetsRaw);
-
-    setData(features, target, isTrainData);
+    if (featureFormat == Sparse) {
+        CsrTensor features = readSparseFeatures(featuresRaw);
+        vector<float> target = readTargets(targetsRaw);
+        setSparseData(features, target, isTrainData);
+    } else {
+        Tensor features = readFeatures(featuresRaw);
+        vector<float> target = readTargets(targetsRaw);
+        setData(features, target, isTrainData);
+    }
     ConsoleUtils::printSepLine();
 }
 
@@ -250,17 +479,49 @@ vector<float> TabularData::readTargets(const vector<string> &targetsRaw) {
     return targets;
 }
 
-Tensor TabularData::readFeatures(const vector<vector<string> > &featuresRaw) {
-    ConsoleUtils::loadMessage("Extracting Features.");
+void TabularData::prepareEncodings(const vector<vector<string> > &featuresRaw) {
+    size_t numCols = featuresRaw[0].size();
+    if (hashBuckets.size() > numCols) {
+        ConsoleUtils::fatalError(
+            "Hashed column index " + to_string(hashBuckets.size() - 1) + 
+            " is out of range for " + to_string(numCols) + " feature columns."
+        );
+    }
+    hashBuckets.resize(numCols, 0);
+
     if (isCategorical.empty()) {
         isCategorical = FeatureEncoder::getCategoricalCols(featuresRaw);
+        for (size_t j = 0; j < numCols; j++) {
+            isCategorical[j] = isCategorical[j] || hashBuckets[j] > 0;
+        }
     }
 
     if (featureEncodings.empty()) {
-        featureEncodings = FeatureEncoder::encodeFeatures(featuresRaw, isCategorical);
+        featureEncodings = FeatureEncoder::encodeFeatures(featuresRaw, isCategorical, hashBuckets);
     }
+}
+
+CsrTensor TabularData::readSparseFeatures(const vector<vector<string> > &featuresRaw) {
+    ConsoleUtils::loadMessage("Extracting Sparse Features.");
+    prepareEncodings(featuresRaw);
+
+    CsrTensor features = FeatureEncoder::getSparseFeatures(
+        isCategorical, featureEncodings, hashBuckets, featuresRaw
+    );
+    ConsoleUtils::completeMessage();
+    return features;
+}
+
+Tensor TabularData::readFeatures(const vector<vector<string> > &featuresRaw) {
+    ConsoleUtils::loadMessage("Extracting Features.");
+    prepareEncodings(featuresRaw);
 
-    Tensor features = FeatureEncoder::getFeatures(isCategorical, featureEncodings, featuresRaw);
+    Tensor features;
+    if (featureFormat == CategoryIds) {
+        features = FeatureEncoder::getCategoryIds(isCategorical, featureEncodings, hashBuckets, featuresRaw);
+    } else {
+        features = FeatureEncoder::getFeatures(isCategorical, featureEncodings, hashBuckets, featuresRaw);
+    }
     ConsoleUtils::completeMessage();
     return features;
 }
@@ -272,6 +533,13 @@ void TabularData::writeBin(ofstream &modelBin) const {
     modelBin.write((char*) &taskLen, sizeof(uint32_t));
     modelBin.write(task.c_str(), taskLen);
 
+    uint32_t formatWrite = featureFormat;
+    modelBin.write((char*) &formatWrite, sizeof(uint32_t));
+
+    uint32_t numHashCols = hashBuckets.size();
+    modelBin.write((char*) &numHashCols, sizeof(uint32_t));
+    modelBin.write((char*) hashBuckets.data(), numHashCols * sizeof(uint32_t));
+
     uint32_t headerSize =  header.size();
     modelBin.write((char*) &headerSize, sizeof(uint32_t));
     for (uint32_t i = 0; i < headerSize; i++) {
@@ -293,14 +561,7 @@ void TabularData::writeBin(ofstream &modelBin) const {
     uint32_t numCatCols = featureEncodings.size();
     modelBin.write((char*) &numCatCols, sizeof(uint32_t));
     for (uint32_t i = 0; i < numCatCols; i++) {
-        uint32_t mapSize = featureEncodings[i].size();
-        modelBin.write((char*) &mapSize, sizeof(uint32_t));
-        for (const pair<const string, float> &pair : featureEncodings[i]) {
-            uint32_t keyLen = pair.first.size();
-            modelBin.write((char*) &keyLen, sizeof(uint32_t));
-            modelBin.write(pair.first.c_str(), keyLen);
-            modelBin.write((char*) &pair.second, sizeof(float));
-        }
+        featureEncodings[i].writeBin(modelBin);
     }
 
     if (task == CLASSIFICATION_TASK) {
@@ -325,6 +586,19 @@ void TabularData::loadFromBin(ifstream &modelBin) {
     task = string(taskLen, '\0');
     modelBin.read(task.data(), taskLen);
 
+    if (BinUtils::getReadRevision() >= 2) {
+        uint32_t formatRead;
+        modelBin.read((char*) &formatRead, sizeof(uint32_t));
+        featureFormat = (FeatureFormats) formatRead;
+    }
+
+    if (BinUtils::getReadRevision() >= 3) {
+        uint32_t numHashCols;
+        modelBin.read((char*) &numHashCols, sizeof(uint32_t));
+        hashBuckets.resize(numHashCols);
+        modelBin.read((char*) hashBuckets.data(), numHashCols * sizeof(uint32_t));
+    }
+
     uint32_t headerSize;
     modelBin.read((char*) &headerSize, sizeof(uint32_t));
     for (uint32_t i = 0; i < headerSize; i++) {
@@ -347,41 +621,54 @@ void TabularData::loadFromBin(ifstream &modelBin) {
 
     uint32_t numCatCols;
     modelBin.read((char*) &numCatCols, sizeof(uint32_t));
-    for (uint32_t i = 0; i < numCatCols; i++) {
-        featureEncodings.push_back(unordered_map<string, float>());
+    if (BinUtils::getReadRevision() >= 4) {
+        featureEncodings.resize(numCatCols);
+        for (uint32_t i = 0; i < numCatCols; i++) {
+            featureEncodings[i].loadFromBin(modelBin);
+        }
+    } else {
+        loadLegacyEncodings(modelBin, numCatCols);
+    }
+
+    if (task == CLASSIFICATION_TASK) {
         uint32_t mapSize;
         modelBin.read((char*) &mapSize, sizeof(uint32_t));
 
-        for (uint32_t j = 0; j < mapSize; j++) {
+        for (uint32_t i = 0; i < mapSize; i++) {
             uint32_t keyLen;
             modelBin.read((char*) &keyLen, sizeof(uint32_t));
 
             string key(keyLen, '\0');
             modelBin.read(key.data(), keyLen);
 
-            float value;
-            modelBin.read((char*) &value, sizeof(float));
+            uint32_t value;
+            modelBin.read((char*) &value, sizeof(uint32_t));
 
-            featureEncodings[i][key] = value;
+            labelMap[key] = value;
         }
     }
+}
 
-    if (task == CLASSIFICATION_TASK) {
+void TabularData::loadLegacyEncodings(ifstream &modelBin, uint32_t numCatCols) {
+    for (uint32_t i = 0; i < numCatCols; i++) {
+        unordered_map<string, float> encoding;
         uint32_t mapSize;
         modelBin.read((char*) &mapSize, sizeof(uint32_t));
 
-        for (uint32_t i = 0; i < mapSize; i++) {
+        for (uint32_t j = 0; j < mapSize; j++) {
             uint32_t keyLen;
             modelBin.read((char*) &keyLen, sizeof(uint32_t));
 
             string key(keyLen, '\0');
             modelBin.read(key.data(), keyLen);
 
-            uint32_t value;
-            modelBin.read((char*) &value, sizeof(uint32_t));
+            float value;
+            modelBin.read((char*) &value, sizeof(float));
 
-            labelMap[key] = value;
+            encoding[key] = value;
         }
+
+        featureEncodings.push_back(CategoryTable(encoding));
     }
 }
 
@@ -4,6 +4,7 @@
 #include <omp.h>
 #include "utils/ConsoleUtils.h"
 #include "core/gpu/GpuEngine.h"
+#include "utils/BinUtils.h"
 #include "utils/Im2ColUtils.h"
 #include "core/activations/ReLU.h"
 #include "core/activations/Linear.h"
@@ -24,18 +25,19 @@ Conv2D::Conv2D(
     const string &padIn, 
     Activation *activation,
     float kernelL2
-) : numKernels(numKernels), kRows(kRows), kCols(kCols), 
+) : numKernels(numKernels), kRows(kRows), kCols(kCols), isBf16Training(false),
     activation(activation), kernelL2(kernelL2) {
     initStride(strideIn);
     padding = Tensor::decodePadding(padIn);
 }
 
-Conv2D::Conv2D() : activation(nullptr) {}
+Conv2D::Conv2D() : isBf16Training(false), activation(nullptr) {}
 
 Conv2D::Conv2D(const Conv2D &other) 
     : numKernels(other.numKernels),
       kRows(other.kRows),
       kCols(other.kCols),
+      inDepth(other.inDepth),
       paddedInput(other.paddedInput),
       im2ColInBuf(other.im2ColInBuf),
       kernels(other.kernels),
@@ -51,6 +53,13 @@ Conv2D::Conv2D(const Conv2D &other)
       gradIm2ColBuf(other.gradIm2ColBuf),
       gradBuf(other.gradBuf),
       biases(other.biases),
+      packedKernels(other.packedKernels),
+      quantizedKernels(other.quantizedKernels),
+      paddedInputBf(other.paddedInputBf),
+      preActivationsBf(other.preActivationsBf),
+      gradBufBf(other.gradBufBf),
+      kernelsBf(other.kernelsBf),
+      isBf16Training(other.isBf16Training),
       winIn(other.winIn),
       winGrad(other.winGrad),
       activation(other.activation ? other.activation->clone() : nullptr),
@@ -120,15 +129,22 @@ void Conv2D::initGradBuf(bool isInference) {
         gradCols = stride * (gradCols - 1) + 1;
     }
 
+    const vector<size_t> &paddedShape = isBf16Training ? paddedInputBf.getShape() : paddedInput.getShape();
     winGrad = Tensor({getMaxBatchSize(), gradRows, gradCols, numKernels}).computeGradWindow(
-        kRows, kCols, paddedInput.getShape()[1], 
-        paddedInput.getShape()[2], stride, winIn
+        kRows, kCols, paddedShape[1], 
+        paddedShape[2], stride, winIn
     );
 
     gradRows += winGrad.padRows;
     gradCols += winGrad.padCols;
 
-    gradBuf = Tensor({getMaxBatchSize(), gradRows, gradCols, numKernels});
+    if (isBf16Training) {
+        gradBufBf = Bf16Tensor({getMaxBatchSize(), gradRows, gradCols, numKernels});
+        gradBuf = Tensor();
+    } else {
+        gradBufBf = Bf16Tensor();
+        gradBuf = Tensor({getMaxBatchSize(), gradRows, gradCols, numKernels});
+    }
 }
 
 void Conv2D::unflattenKernels() {
@@ -199,7 +215,7 @@ vector<uint32_t> Conv2D::generateThreadSeeds() const {
 }
 
 void Conv2D::initKernels() {
-    if (kernels.getSize() != 0 || fastKernels.getSize() != 0)
+    if (kernels.getSize() != 0 || fastKernels.getSize() != 0 || !packedKernels.isEmpty())
         return;
 
     kernels = Tensor({numKernels, kRows, kCols, inDepth});
@@ -228,6 +244,17 @@ void Conv2D::initKernels() {
     }
 }
 
+// Kernels loaded from a container are only kept as mapped panels until training or the GPU
+// needs them row-major.
+void Conv2D::ensureKernels() {
+    if (kernels.getSize() != 0 || fastKernels.getSize() != 0 || packedKernels.isEmpty())
+        return;
+
+    kernels = Tensor({numKernels, kRows, kCols, inDepth});
+    packedKernels.unpack(kernels);
+    unpackedKernels = Tensor();
+}
+
 void Conv2D::initBiases() {
     if (biases.getSize() !=  0)
         return;
@@ -247,11 +274,29 @@ void Conv2D::initParams() {
     initBiases();
 }
 
+// Mixed-precision training keeps the padded input and pre-activations, which live until
+// backprop, as bf16 instead.
 void Conv2D::allocateForwardBuffers(size_t inRows, size_t inCols) {
-    paddedInput = Tensor({getMaxBatchSize(), inRows + winIn.padRows, inCols + winIn.padCols, inDepth});
+    vector<size_t> paddedShape = {getMaxBatchSize(), inRows + winIn.padRows, inCols + winIn.padCols, inDepth};
+    vector<size_t> outShape = {getMaxBatchSize(), winIn.outRows, winIn.outCols, numKernels};
+
+    if (isBf16Training) {
+        paddedInputBf = Bf16Tensor(paddedShape);
+        preActivationsBf = Bf16Tensor(outShape);
+        kernelsBf = Bf16Tensor({kRows, kCols, inDepth, numKernels});
+        paddedInput = Tensor();
+        preActivations = Tensor();
+        activations = Tensor(outShape);
+        return;
+    }
+
+    paddedInputBf = Bf16Tensor();
+    preActivationsBf = Bf16Tensor();
+    kernelsBf = Bf16Tensor();
+    paddedInput = Tensor(paddedShape);
 
     if (executionMode != GPU_FAST) {
-        preActivations = Tensor({getMaxBatchSize(), winIn.outRows, winIn.outCols, numKernels});
+        preActivations = Tensor(outShape);
 
     } else {
         im2ColInBuf = Tensor({getMaxBatchSize() * winIn.outRows * winIn.outCols, kRows * kCols * inDepth});
@@ -303,16 +348,19 @@ void Conv2D::build(const vector<size_t> &inShape, bool isInference) {
     inDepth = inShape[3];
     
     winIn = Tensor({inShape}).computeInputWindow(kRows, kCols, padding, stride);
+    isBf16Training = isMixedPrecision() && !isInference && executionMode == CPU;
     allocateForwardBuffers(inRows, inCols);
     allocateGradientBuffers(inRows, inCols, isInference);
     initGradBuf(isInference);
+    ensureKernels();
     initParams();
     deallocateGradientBuffers(isInference);
 }
 
 vector<size_t> Conv2D::getBuildOutShape(const vector<size_t> &inShape) const {
     checkBuildSize(inShape);
-    return {getMaxBatchSize(), winIn.outRows, winIn.outCols, numKernels};
+    WindowDims win = Tensor::computeInputWindow(inShape, kRows, kCols, padding, stride);
+    return {inShape[0], win.outRows, win.outCols, numKernels};
 }
 
 void Conv2D::reShapeGpuFastBuffers(size_t currBatchSize, size_t inDepth) {
@@ -332,7 +380,9 @@ void Conv2D::reShapeCpuBuffers(size_t currBatchSize) {
     if (executionMode == GPU_FAST)
         return;
 
-    preActivations.reShapeInPlace({currBatchSize, winIn.outRows, winIn.outCols, numKernels});
+    if (!isBf16Training) {
+        preActivations.reShapeInPlace({currBatchSize, winIn.outRows, winIn.outCols, numKernels});
+    }
 
     if (gradBuf.getSize() > 0) {
         const vector<size_t> &gradShape = gradBuf.getShape();
@@ -347,11 +397,13 @@ void Conv2D::reShapeCpuBuffers(size_t currBatchSize) {
 }
 
 void Conv2D::reShapeBatch(size_t currBatchSize) {
-    const vector<size_t> &inPadShape = paddedInput.getShape();
-    size_t inPadRows = inPadShape[1];
-    size_t inPadCols = inPadShape[2];
+    if (!isBf16Training) {
+        const vector<size_t> &inPadShape = paddedInput.getShape();
+        size_t inPadRows = inPadShape[1];
+        size_t inPadCols = inPadShape[2];
+        paddedInput.reShapeInPlace({currBatchSize, inPadRows, inPadCols, inDepth});
+    }
 
-    paddedInput.reShapeInPlace({currBatchSize, inPadRows, inPadCols, inDepth});
     activations.reShapeInPlace({currBatchSize, winIn.outRows, winIn.outCols, numKernels});
 
     if (dX.getSize() > 0) {
@@ -370,6 +422,15 @@ void Conv2D::forward(const Tensor &input) {
         reShapeBatch(input.getShape()[0]);
     }
 
+    if (isBf16Training) {
+        kernelsBf.storeKernels(kernels);
+        paddedInputBf.storePadded(input, winIn);
+        paddedInputBf.conv2dForward(kernelsBf, stride, activations, biases);
+        preActivationsBf.store(activations);
+        activation->activate(activations, activations);
+        return;
+    }
+
     const Tensor &inputFwd = input.padIfNeeded(paddedInput, winIn, padding);
     inputFwd.conv2dForward(kernels, stride, preActivations, biases);
     activation->activate(preActivations, activations);
@@ -383,16 +444,30 @@ void Conv2D::backprop(
 ) {
     float scaleFactor = -learningRate / input.getShape()[0];
 
-    activation->calculateGradient(preActivations, dA);
+    if (isBf16Training) {
+        preActivationsBf.load(dA);
+        activation->calculateGradient(dA, dA);
+    } else {
+        activation->calculateGradient(preActivations, dA);
+    }
     grad.hadamard(dA);
 
-    if (!isFirstLayer) {
-        grad.padAndUpsampleGrad(gradBuf, winGrad, stride);
-        gradBuf.conv2dInput(kernels, dX);
-    }
+    if (isBf16Training) {
+        if (!isFirstLayer) {
+            gradBufBf.storeUpsampledGrad(grad, winGrad, stride);
+            gradBufBf.conv2dInput(kernelsBf, dX);
+        }
+        paddedInputBf.conv2dWeights(grad, numKernels, kRows, kCols, stride, dW);
 
-    const Tensor &inputBwd = input.padIfNeeded(paddedInput, winIn, padding);
-    inputBwd.conv2dWeights(grad, numKernels, kRows, kCols, stride, dW);
+    } else {
+        if (!isFirstLayer) {
+            grad.padAndUpsampleGrad(gradBuf, winGrad, stride);
+            gradBuf.conv2dInput(kernels, dX);
+        }
+
+        const Tensor &inputBwd = input.padIfNeeded(paddedInput, winIn, padding);
+        inputBwd.conv2dWeights(grad, numKernels, kRows, kCols, stride, dW);
+    }
     grad.reduceSumBias(dB);
 
     if (kernelL2 > 0.0f) {
@@ -404,6 +479,104 @@ void Conv2D::backprop(
     biases.applyGrad(dB, scaleFactor);
 }
 
+// Other sessions may be running infer() on this layer, so once it has kernels on the CPU only the
+// input depth is checked and nothing is written.
+void Conv2D::initInference(const vector<size_t> &inShape) {
+    checkBuildSize(inShape);
+    bool hasKernels = kernels.getSize() != 0 || fastKernels.getSize() != 0 || !packedKernels.isEmpty();
+    if (hasKernels && !GpuEngine::isUsingGpu()) {
+        if (inShape[3] != inDepth) {
+            ConsoleUtils::fatalError(
+                "Conv2D inference error: Expected input with " + to_string(inDepth) +
+                " channels, but got " + to_string(inShape[3]) + "."
+            );
+        }
+        return;
+    }
+
+    initExecutionMode(kRows, kCols);
+    inDepth = inShape[3];
+    initParams();
+}
+
+// Quantized layers keep the padded input and its gathered windows as bytes, four to a float
+// of scratch.
+vector<size_t> Conv2D::getInferScratchShape(const vector<size_t> &inShape) const {
+    checkBuildSize(inShape);
+    WindowDims win = Tensor::computeInputWindow(inShape, kRows, kCols, padding, stride);
+    size_t paddedRows = inShape[1] + win.padRows;
+    size_t paddedCols = inShape[2] + win.padCols;
+
+    if (!quantizedKernels.isEmpty()) {
+        vector<size_t> outShape = getBuildOutShape(inShape);
+        size_t paddedBytes = paddedRows * paddedCols * inShape[3];
+        size_t patchBytes = outShape[1] * outShape[2] * quantizedKernels.getRowStride();
+        return {inShape[0], (paddedBytes + patchBytes + 3) / 4};
+    }
+
+    if (padding == Tensor::Paddings::NONE)
+        return {};
+
+    return {inShape[0], paddedRows, paddedCols, inShape[3]};
+}
+
+void Conv2D::infer(const Tensor &input, Tensor &output, Tensor &scratch) const {
+    const vector<size_t> &inShape = input.getShape();
+    WindowDims win = Tensor::computeInputWindow(inShape, kRows, kCols, padding, stride);
+    const float *biasFlat = biases.getFlat().data();
+
+    if (!quantizedKernels.isEmpty()) {
+        uint8_t *inputQ = (uint8_t*) scratch.getFlat().data();
+        quantizedKernels.quantizeImage(input, win, inputQ);
+
+        vector<size_t> paddedShape = {
+            inShape[0], inShape[1] + win.padRows, inShape[2] + win.padCols, inShape[3]
+        };
+        uint8_t *patches = inputQ + paddedShape[0] * paddedShape[1] * paddedShape[2] * paddedShape[3];
+        quantizedKernels.conv2d(inputQ, paddedShape, kRows, kCols, stride, biasFlat, patches, output);
+    } else {
+        const Tensor &inputFwd = input.padIfNeeded(scratch, win, padding);
+
+        if (packedKernels.isEmpty()) {
+            inputFwd.conv2dForward(kernels, stride, output, biases);
+        } else {
+            packedKernels.conv2d(inputFwd, kRows, kCols, stride, biasFlat, output);
+        }
+    }
+    activation->activate(output, output);
+}
+
+// Kernels that only exist as loaded panels are already packed. Encoded panels are widened on
+// the first run unless the layer runs in int8.
+void Conv2D::packWeights() {
+    if (kernels.getSize() == 0) {
+        if (quantizedKernels.isEmpty()) {
+            packedKernels.widen();
+        }
+        return;
+    }
+
+    packedKernels.pack(kernels);
+}
+
+bool Conv2D::quantize(const vector<float> &inputRanges) {
+    if (inputRanges.empty() || !QuantizedMatrix::isFaster(kRows * kCols * inDepth)) {
+        quantizedKernels.clear();
+    } else if (kernels.getSize() != 0) {
+        quantizedKernels.quantize(kernels, inputRanges);
+    } else {
+        Tensor unpacked({numKernels, kRows, kCols, inDepth});
+        packedKernels.unpack(unpacked);
+        quantizedKernels.quantize(unpacked, inputRanges);
+    }
+
+    if (quantizedKernels.isEmpty()) {
+        packedKernels.widen();
+    }
+
+    return !quantizedKernels.isEmpty();
+}
+
 const Tensor& Conv2D::getOutput() const {
     return activations;
 }
@@ -443,10 +616,16 @@ void Conv2D::writeBinInternal(ofstream &modelBin) const {
     uint32_t paddingWrite = (uint32_t) padding;
     modelBin.write((char*) &paddingWrite, sizeof(uint32_t));
     
-    modelBin.write((char*) kernels.getFlat().data(), kernels.getSize() * sizeof(float));
+    packedKernels.writeWeights(modelBin, kernels);
     modelBin.write((char*) biases.getFlat().data(), biases.getSize() * sizeof(float));
 
     modelBin.write((char*) &kernelL2, sizeof(float));
+
+    uint8_t isQuantized = quantizedKernels.isEmpty() ? 0 : 1;
+    modelBin.write((char*) &isQuantized, sizeof(uint8_t));
+    if (isQuantized) {
+        quantizedKernels.writeBin(modelBin);
+    }
 }
 
 void Conv2D::loadActivation(ifstream &modelBin) {
@@ -491,14 +670,28 @@ void Conv2D::loadFromBin(ifstream &modelBin) {
     uint32_t paddingRead;
     modelBin.read((char*) &paddingRead, sizeof(uint32_t));
     padding = (Tensor::Paddings) paddingRead;
+    initExecutionMode(kRows, kCols);
 
-    kernels = Tensor({numKernels, kRows, kCols, inDepth});
-    modelBin.read((char*) kernels.getFlat().data(), sizeof(float) * kernels.getSize());
+    packedKernels.loadWeights(modelBin, {numKernels, kRows, kCols, inDepth}, kernels);
+    unpackedKernels = Tensor();
     
     biases = Tensor({numKernels});
     modelBin.read((char*) biases.getFlat().data(), sizeof(float) * numKernels);
 
     modelBin.read((char*) &kernelL2, sizeof(float));
+
+    quantizedKernels.clear();
+    if (BinUtils::getReadRevision() >= 6) {
+        uint8_t isQuantized;
+        modelBin.read((char*) &isQuantized, sizeof(uint8_t));
+        if (isQuantized) {
+            quantizedKernels.loadFromBin(modelBin);
+        }
+    }
+
+    if (GpuEngine::isUsingGpu()) {
+        ensureKernels();
+    }
     ensureGpu();
 }
 
@@ -506,12 +699,21 @@ Layer::Encodings Conv2D::getEncoding() const {
     return Layer::Encodings::Conv2D;
 }
 
+// Kernels loaded from a container are unpacked on first request, like ensureKernels() does for
+// training, and the copy is kept until the kernels are loaded again.
 const Tensor& Conv2D::getWeights() const {
     if (executionMode == GPU_FAST) {
         return fastKernels;
     }
-    
-    return kernels;
+
+    if (kernels.getSize() != 0 || packedKernels.isEmpty())
+        return kernels;
+
+    if (unpackedKernels.getSize() == 0) {
+        unpackedKernels = Tensor({numKernels, kRows, kCols, inDepth});
+        packedKernels.unpack(unpackedKernels);
+    }
+    return unpackedKernels;
 }
 
 const Tensor& Conv2D::getBiases() const {
@@ -4,6 +4,7 @@
 #include "utils/TrainingUtils.h"
 #include "core/activations/Activation.h"
 #include "core/tensor/MatrixT.h"
+#include "core/tensor/CsrTensor.h"
 #include <random>
 #include <sstream>
 #include "core/tensor/Matrix.h"
@@ -12,6 +13,7 @@
 #include "core/activations/Softmax.h"
 #include "utils/ConsoleUtils.h"
 #include "core/gpu/GpuEngine.h"
+#include "utils/BinUtils.h"
 
 const float Dense::HE_INT_GAIN = 2.0;
 
@@ -34,6 +36,8 @@ Dense::Dense(const Dense& other)
       dX(other.dX),
       dA(other.dA),
       biases(other.biases),
+      packedWeights(other.packedWeights),
+      quantizedWeights(other.quantizedWeights),
       activation(other.activation ? other.activation->clone() : nullptr),
       weightL2(other.weightL2)
 {}
@@ -79,6 +83,9 @@ void Dense::allocateGradientBuffers(size_t weightsPerNeuron, bool isInference) {
         
     if (executionMode == CPU) {
         dB = Tensor({numNeurons});
+    }
+
+    if (executionMode == CPU && !isSparseInput()) {
         dW = Tensor({numNeurons, weightsPerNeuron});
     }
     
@@ -86,7 +93,9 @@ void Dense::allocateGradientBuffers(size_t weightsPerNeuron, bool isInference) {
         dA = Tensor({getMaxBatchSize(), numNeurons});
     }
 
-    dX = Tensor({getMaxBatchSize(), weightsPerNeuron});
+    if (!isSparseInput()) {
+        dX = Tensor({getMaxBatchSize(), weightsPerNeuron});
+    }
 }
 
 void Dense::deallocateGradientBuffers(bool isInference) {
@@ -111,7 +120,7 @@ vector<uint32_t> Dense::generateThreadSeeds() const {
 }
 
 void Dense::initWeights(size_t weightsPerNeuron) {
-    if (weights.getSize() != 0)
+    if (weights.getSize() != 0 || !packedWeights.isEmpty())
         return;
 
     weights = Tensor({numNeurons, weightsPerNeuron});
@@ -157,6 +166,17 @@ void Dense::initParams(size_t weightsPerNeuron) {
     initBiases();
 }
 
+// Models loaded from a container keep their weights only as mapped panels. Training and the GPU
+// need a row-major copy.
+void Dense::ensureWeights() {
+    if (weights.getSize() != 0 || packedWeights.isEmpty())
+        return;
+
+    weights = Tensor({numNeurons, packedWeights.getNumCols()});
+    packedWeights.unpack(weights);
+    unpackedWeights = Tensor();
+}
+
 
 void Dense::build(const vector<size_t> &inShape, bool isInference) {
     checkBuildSize(inShape);
@@ -167,6 +187,7 @@ void Dense::build(const vector<size_t> &inShape, bool isInference) {
     
     allocateForwardBuffers();
     allocateGradientBuffers(weightsPerNeuron, isInference);
+    ensureWeights();
     initParams(weightsPerNeuron);
     deallocateGradientBuffers(isInference);
 }
@@ -174,7 +195,7 @@ void Dense::build(const vector<size_t> &inShape, bool isInference) {
 
 vector<size_t> Dense::getBuildOutShape(const vector<size_t> &inShape) const {
     checkBuildSize(inShape);
-    return {getMaxBatchSize(), numNeurons};
+    return {inShape[0], numNeurons};
 }
 
 void Dense::syncBuffers() {
@@ -190,18 +211,24 @@ void Dense::writeBinInternal(ofstream& modelBin) const {
     uint32_t activationEncoding = activation->getEncoding();
     modelBin.write((char*) &activationEncoding, sizeof(uint32_t));
 
-    Matrix weightsMat = weights.M();
     uint32_t numNeuronsWrite = (uint32_t) numNeurons;
     modelBin.write((char*) &numNeuronsWrite, sizeof(uint32_t));
 
-    uint32_t weightsPerNeuronWrite = (uint32_t) weightsMat.getNumCols();
+    size_t weightsPerNeuron = (weights.getSize() != 0) ?
+        weights.getShape()[1] : packedWeights.getNumCols();
+    uint32_t weightsPerNeuronWrite = (uint32_t) weightsPerNeuron;
     modelBin.write((char*) &weightsPerNeuronWrite, sizeof(uint32_t));
 
-    size_t numWeights = weightsMat.getNumRows() * weightsMat.getNumCols();
-    modelBin.write((char*) weights.getFlat().data(), numWeights * sizeof(float));
+    packedWeights.writeWeights(modelBin, weights);
     modelBin.write((char*) biases.getFlat().data(), biases.getSize() * sizeof(float));
 
     modelBin.write((char*) &weightL2, sizeof(float));
+
+    uint8_t isQuantized = quantizedWeights.isEmpty() ? 0 : 1;
+    modelBin.write((char*) &isQuantized, sizeof(uint8_t));
+    if (isQuantized) {
+        quantizedWeights.writeBin(modelBin);
+    }
 }
 
 void Dense::loadActivation(ifstream &modelBin) {
@@ -231,15 +258,25 @@ void Dense::loadFromBin(ifstream &modelBin) {
     uint32_t weightsPerNeuron;
     modelBin.read((char*) &weightsPerNeuron, sizeof(uint32_t));
 
-    weights = Tensor({numNeurons, weightsPerNeuron});
+    packedWeights.loadWeights(modelBin, {numNeurons, weightsPerNeuron}, weights);
+    unpackedWeights = Tensor();
     biases = Tensor({numNeurons});
-    
-    Matrix weightsMat = weights.M();
-    size_t numWeights = weightsMat.getNumRows() * weightsMat.getNumCols();
-    modelBin.read((char*) weights.getFlat().data(), numWeights * sizeof(float));
     modelBin.read((char*) biases.getFlat().data(), biases.getSize() * sizeof(float));
 
     modelBin.read((char*) &weightL2, sizeof(float));
+
+    quantizedWeights.clear();
+    if (BinUtils::getReadRevision() >= 6) {
+        uint8_t isQuantized;
+        modelBin.read((char*) &isQuantized, sizeof(uint8_t));
+        if (isQuantized) {
+            quantizedWeights.loadFromBin(modelBin);
+        }
+    }
+
+    if (GpuEngine::isUsingGpu()) {
+        ensureWeights();
+    }
     ensureGpu();
 }
 
@@ -270,6 +307,100 @@ void Dense::forward(const Tensor &prevActivations) {
     activation->activate(preActivations, activations); 
 }
 
+void Dense::forwardSparse(const CsrTensor &prevActivations) {
+    if (prevActivations.getNumRows() != activations.getShape()[0]) {
+        reShapeBatch(prevActivations.getNumRows());
+    }
+
+    prevActivations.mmT(weights, preActivations);
+    preActivations.M().addToRows(biases);
+    activation->activate(preActivations, activations);
+}
+
+void Dense::initInference(const vector<size_t> &inShape) {
+    checkBuildSize(inShape);
+    initParams(inShape[1]);
+}
+
+// Quantized layers quantize the input into the scratch buffer and run the int8 kernels.
+// Otherwise this runs on the packed weights once a session has packed them: a serial GEMV for
+// single samples, or the panel GEMM with the bias folded in.
+void Dense::infer(const Tensor &input, Tensor &output, Tensor &scratch) const {
+    size_t batchSize = input.getShape()[0];
+    const float *inFlat = input.getFlat().data();
+    float *outFlat = output.getFlat().data();
+
+    if (!quantizedWeights.isEmpty()) {
+        uint8_t *inputQ = (uint8_t*) scratch.getFlat().data();
+        quantizedWeights.quantizeInput(inFlat, batchSize, inputQ);
+
+        if (batchSize == 1) {
+            quantizedWeights.gemv(inputQ, biases.getFlat().data(), outFlat);
+        } else {
+            quantizedWeights.gemm(inputQ, batchSize, biases.getFlat().data(), outFlat);
+        }
+    } else if (packedWeights.isEmpty()) {
+        input.M().mmT(weights.M().T(), output);
+        output.M().addToRows(biases);
+    } else if (batchSize == 1) {
+        packedWeights.gemv(inFlat, biases.getFlat().data(), outFlat);
+    } else {
+        packedWeights.gemm(inFlat, batchSize, biases.getFlat().data(), outFlat);
+    }
+
+    activation->activate(output, output);
+}
+
+void Dense::inferSparse(const CsrTensor &input, Tensor &output) const {
+    if (packedWeights.isEmpty()) {
+        input.mmT(weights, output);
+        output.M().addToRows(biases);
+    } else {
+        packedWeights.sparseGemm(input, biases.getFlat().data(), output.getFlat().data());
+    }
+    activation->activate(output, output);
+}
+
+// Weights that only exist as loaded panels are already packed. Encoded panels are widened on
+// the first run unless the layer runs in int8.
+void Dense::packWeights() {
+    if (weights.getSize() == 0) {
+        if (quantizedWeights.isEmpty()) {
+            packedWeights.widen();
+        }
+        return;
+    }
+
+    packedWeights.pack(weights);
+}
+
+bool Dense::quantize(const vector<float> &inputRanges) {
+    size_t numInputs = (weights.getSize() != 0) ? weights.getShape()[1] : packedWeights.getNumCols();
+    if (inputRanges.empty() || !QuantizedMatrix::isFaster(numInputs)) {
+        quantizedWeights.clear();
+    } else if (weights.getSize() != 0) {
+        quantizedWeights.quantize(weights, inputRanges);
+    } else {
+        Tensor unpacked({numNeurons, numInputs});
+        packedWeights.unpack(unpacked);
+        quantizedWeights.quantize(unpacked, inputRanges);
+    }
+
+    if (quantizedWeights.isEmpty()) {
+        packedWeights.widen();
+    }
+
+    return !quantizedWeights.isEmpty();
+}
+
+// Quantized inputs are bytes, four to a float of scratch.
+vector<size_t> Dense::getInferScratchShape(const vector<size_t> &inShape) const {
+    if (quantizedWeights.isEmpty())
+        return {};
+
+    return {inShape[0], (quantizedWeights.getRowStride() + 3) / 4};
+}
+
 const Tensor& Dense::getOutput() const {
     return activations;
 }
@@ -305,6 +436,25 @@ void Dense::backprop(
     biases.applyGrad(dB, scaleFactor);
 }
 
+void Dense::backpropSparse(
+    const CsrTensor &prevActivations,
+    float learningRate,
+    Tensor &grad
+) {
+    if (!activation->isFused()) {
+        activation->calculateGradient(preActivations, dA);
+        grad.hadamard(dA);
+    }
+
+    Matrix gradMat = grad.M();
+    size_t batchSize = gradMat.getNumRows();
+    float scaleFactor = -learningRate/batchSize;
+
+    gradMat.colSums(dB);
+    prevActivations.applyWeightGrad(grad, scaleFactor, weightL2 * (float) batchSize, weights);
+    biases.applyGrad(dB, scaleFactor);
+}
+
 Tensor& Dense::getOutputGradient() {
     return dX;
 }
@@ -321,8 +471,17 @@ Layer* Dense::clone() const {
     return new Dense(*this);
 }
 
+// Layers loaded from a container only hold panels, so a row-major copy is unpacked on first
+// request and kept until the weights are loaded again.
 const Tensor& Dense::getWeights() const {
-    return weights;
+    if (weights.getSize() != 0 || packedWeights.isEmpty())
+        return weights;
+
+    if (unpackedWeights.getSize() == 0) {
+        unpackedWeights = Tensor({numNeurons, packedWeights.getNumCols()});
+        packedWeights.unpack(unpackedWeights);
+    }
+    return unpackedWeights;
 }
 
 const Tensor& Dense::getBiases() const {
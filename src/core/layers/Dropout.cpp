@@ -1,6 +1,7 @@
 #include "core/layers/Dropout.h"
 #include <random>
 #include <algorithm>
+#include <cstring>
 #include <omp.h>
 
 Dropout::Dropout() : rate(0.0f) {}
@@ -22,9 +23,7 @@ void Dropout::build(const vector<size_t> &inShape, bool isInference) {
 }
 
 vector<size_t> Dropout::getBuildOutShape(const vector<size_t> &inShape) const {
-    vector<size_t> outShape = inShape;
-    outShape[0] = getMaxBatchSize();
-    return outShape;
+    return inShape;
 }
 
 vector<uint32_t> Dropout::generateThreadSeeds() const {
@@ -85,6 +84,12 @@ void Dropout::forward(const Tensor &input) {
     input.applyMask(mask, output);
 }
 
+// Dropout is the identity at inference time.
+void Dropout::infer(const Tensor &input, Tensor &output, Tensor &scratch) const {
+    (void)scratch;
+    memcpy(output.getFlat().data(), input.getFlat().data(), input.getSize() * sizeof(float));
+}
+
 void Dropout::backprop(
     const Tensor &prevActivations,
     float learningRate,
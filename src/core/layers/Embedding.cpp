@@ -0,0 +1,232 @@
+#include "core/layers/Embedding.h"
+#include "utils/ConsoleUtils.h"
+#include "core/gpu/GpuEngine.h"
+#include "utils/BinUtils.h"
+#include "core/model/NeuralNet.h"
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <omp.h>
+
+Embedding::Embedding(const vector<size_t> &cardinalities, size_t embeddingDim) :
+    cardinalities(cardinalities), embeddingDim(embeddingDim), numPassThrough(0) 
+{
+    initOffsets();
+}
+
+Embedding::Embedding() : embeddingDim(0), numPassThrough(0) {}
+
+void Embedding::initOffsets() {
+    size_t numCatCols = cardinalities.size();
+    tableOffsets.resize(numCatCols);
+
+    size_t offset = 0;
+    for (size_t c = 0; c < numCatCols; c++) {
+        tableOffsets[c] = offset;
+        offset += cardinalities[c];
+    }
+}
+
+void Embedding::initTable() {
+    if (table.getSize() != 0)
+        return;
+
+    size_t numRows = 0;
+    for (size_t cardinality : cardinalities) {
+        numRows += cardinality;
+    }
+
+    table = Tensor({numRows, embeddingDim});
+    vector<float> &tableFlat = table.getFlat();
+    size_t size = table.getSize();
+
+    mt19937 &generator = NeuralNet::getGenerator();
+    normal_distribution<float> distribution(0, 1.0f/sqrt((float) embeddingDim));
+
+    for (size_t i = 0; i < size; i++) {
+        tableFlat[i] = distribution(generator);
+    }
+}
+
+void Embedding::checkBuildSize(const vector<size_t> &inShape) const {
+    if (inShape.size() != 2) {
+        ConsoleUtils::fatalError(
+            "Embedding build error: Expected 2D input (batch_size, features), "
+            "but got tensor with " + to_string(inShape.size()) + " dimensions."
+        );
+    }
+
+    if (inShape[1] < cardinalities.size()) {
+        ConsoleUtils::fatalError(
+            "Embedding build error: Expected at least " + to_string(cardinalities.size()) + 
+            " categorical id columns, but got " + to_string(inShape[1]) + " features."
+        );
+    }
+}
+
+size_t Embedding::getOutputWidth() const {
+    return cardinalities.size() * embeddingDim + numPassThrough;
+}
+
+// Ids outside the vocabulary fall back to the trailing out-of-vocabulary row.
+size_t Embedding::getRowIdx(size_t col, float id) const {
+    size_t cardinality = cardinalities[col];
+    size_t rowIdx = (id >= 0.0f && id < (float) cardinality) ? (size_t) id : cardinality - 1;
+    return tableOffsets[col] + rowIdx;
+}
+
+// Backprop updates the table rows in place, so training needs no extra buffers.
+void Embedding::build(const vector<size_t> &inShape, bool isInference) {
+    (void)isInference;
+    checkBuildSize(inShape);
+
+    if (GpuEngine::isUsingGpu()) {
+        ConsoleUtils::fatalError("Embedding layers are only supported on the CPU.");
+    }
+
+    Layer::build(inShape);
+    numPassThrough = inShape[1] - cardinalities.size();
+    output = Tensor({getMaxBatchSize(), getOutputWidth()});
+    initTable();
+}
+
+vector<size_t> Embedding::getBuildOutShape(const vector<size_t> &inShape) const {
+    checkBuildSize(inShape);
+    size_t numCatCols = cardinalities.size();
+    return {inShape[0], numCatCols * embeddingDim + inShape[1] - numCatCols};
+}
+
+void Embedding::forward(const Tensor &prevActivations) {
+    size_t batchSize = prevActivations.getShape()[0];
+    if (batchSize != output.getShape()[0]) {
+        output.reShapeInPlace({batchSize, getOutputWidth()});
+    }
+
+    gather(prevActivations, output);
+}
+
+void Embedding::initInference(const vector<size_t> &inShape) {
+    checkBuildSize(inShape);
+    initTable();
+}
+
+void Embedding::infer(const Tensor &input, Tensor &output, Tensor &scratch) const {
+    (void)scratch;
+    gather(input, output);
+}
+
+void Embedding::gather(const Tensor &prevActivations, Tensor &output) const {
+    size_t batchSize = prevActivations.getShape()[0];
+    size_t inWidth = prevActivations.getShape()[1];
+    size_t outWidth = output.getShape()[1];
+    size_t numCatCols = cardinalities.size();
+    size_t passThroughCols = inWidth - numCatCols;
+
+    const float *inFlat = prevActivations.getFlat().data();
+    const float *tableFlat = table.getFlat().data();
+    float *outFlat = output.getFlat().data();
+    size_t rowBytes = embeddingDim * sizeof(float);
+
+    #pragma omp parallel for
+    for (size_t i = 0; i < batchSize; i++) {
+        const float *inRow = inFlat + i * inWidth;
+        float *outRow = outFlat + i * outWidth;
+
+        for (size_t c = 0; c < numCatCols; c++) {
+            const float *embedRow = tableFlat + getRowIdx(c, inRow[c]) * embeddingDim;
+            memcpy(outRow + c * embeddingDim, embedRow, rowBytes);
+        }
+
+        memcpy(outRow + numCatCols * embeddingDim, inRow + numCatCols, passThroughCols * sizeof(float));
+    }
+}
+
+void Embedding::backprop(
+    const Tensor &prevActivations,
+    float learningRate,
+    Tensor &grad,
+    bool isFirstLayer
+) {
+    if (!isFirstLayer) {
+        ConsoleUtils::fatalError("Embedding must be the first layer of the network.");
+    }
+
+    size_t batchSize = prevActivations.getShape()[0];
+    size_t inWidth = prevActivations.getShape()[1];
+    size_t outWidth = getOutputWidth();
+    size_t numCatCols = cardinalities.size();
+    float scaleFactor = -learningRate/batchSize;
+
+    const float *inFlat = prevActivations.getFlat().data();
+    const float *gradFlat = grad.getFlat().data();
+    float *tableFlat = table.getFlat().data();
+
+    // Each column owns a disjoint slice of the table, so columns scatter in parallel.
+    #pragma omp parallel for
+    for (size_t c = 0; c < numCatCols; c++) {
+        for (size_t i = 0; i < batchSize; i++) {
+            float *embedRow = tableFlat + getRowIdx(c, inFlat[i * inWidth + c]) * embeddingDim;
+            const float *gradRow = gradFlat + i * outWidth + c * embeddingDim;
+
+            #pragma omp simd
+            for (size_t d = 0; d < embeddingDim; d++) {
+                embedRow[d] += scaleFactor * gradRow[d];
+            }
+        }
+    }
+}
+
+const Tensor& Embedding::getOutput() const {
+    return output;
+}
+
+Tensor& Embedding::getOutputGradient() {
+    return dX;
+}
+
+Layer::Encodings Embedding::getEncoding() const {
+    return Layer::Encodings::Embedding;
+}
+
+void Embedding::writeBinInternal(ofstream &modelBin) const {
+    uint32_t numCatCols = cardinalities.size();
+    modelBin.write((char*) &numCatCols, sizeof(uint32_t));
+    for (uint32_t c = 0; c < numCatCols; c++) {
+        uint32_t cardinality = cardinalities[c];
+        modelBin.write((char*) &cardinality, sizeof(uint32_t));
+    }
+
+    uint32_t embeddingDimWrite = embeddingDim;
+    modelBin.write((char*) &embeddingDimWrite, sizeof(uint32_t));
+    BinUtils::writeFloats(modelBin, table.getFlat().data(), table.getSize());
+}
+
+void Embedding::loadFromBin(ifstream &modelBin) {
+    uint32_t numCatCols;
+    modelBin.read((char*) &numCatCols, sizeof(uint32_t));
+
+    size_t numRows = 0;
+    cardinalities.resize(numCatCols);
+    for (uint32_t c = 0; c < numCatCols; c++) {
+        uint32_t cardinality;
+        modelBin.read((char*) &cardinality, sizeof(uint32_t));
+        cardinalities[c] = cardinality;
+        numRows += cardinality;
+    }
+
+    uint32_t embeddingDimRead;
+    modelBin.read((char*) &embeddingDimRead, sizeof(uint32_t));
+    embeddingDim = embeddingDimRead;
+
+    initOffsets();
+    table = Tensor({numRows, embeddingDim});
+    BinUtils::readFloats(modelBin, table.getFlat().data(), table.getSize());
+}
+
+const Tensor& Embedding::getWeights() const {
+    return table;
+}
+
+Layer* Embedding::clone() const {
+    return new Embedding(*this);
+}
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include "core/layers/Flatten.h"
 #include "utils/ConsoleUtils.h"
+#include <cstring>
 
 void Flatten::checkInputSize(const vector<size_t> &givenShape) const {
     if (givenShape.size() < 2) {
@@ -66,7 +67,19 @@ void Flatten::build(const vector<size_t> &givenShape, bool isInference) {
 
 vector<size_t> Flatten::getBuildOutShape(const vector<size_t> &givenShape) const {
     checkInputSize(givenShape);
-    return outShape;
+    size_t inSize = givenShape.size();
+
+    size_t flatSize = 1;
+    for (size_t i = 1; i < inSize; i++) {
+        flatSize *= givenShape[i];
+    }
+
+    return {givenShape[0], flatSize};
+}
+
+void Flatten::infer(const Tensor &input, Tensor &output, Tensor &scratch) const {
+    (void)scratch;
+    memcpy(output.getFlat().data(), input.getFlat().data(), input.getSize() * sizeof(float));
 }
 
 void Flatten::writeBinInternal(ofstream &modelBin) const {}
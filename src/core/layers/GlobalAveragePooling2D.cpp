@@ -28,7 +28,7 @@ void GlobalAveragePooling2D::build(const vector<size_t> &inShape, bool isInferen
 
 vector<size_t> GlobalAveragePooling2D::getBuildOutShape(const vector<size_t> &inShape) const {
     checkBuildSize(inShape);
-    return {getMaxBatchSize(), inShape[3]};
+    return {inShape[0], inShape[3]};
 }
 
 void GlobalAveragePooling2D::reShapeBatch(size_t currBatchSize) {
@@ -50,6 +50,11 @@ void GlobalAveragePooling2D::forward(const Tensor &input) {
     input.globalAvgPool2d(output);
 }
 
+void GlobalAveragePooling2D::infer(const Tensor &input, Tensor &output, Tensor &scratch) const {
+    (void)scratch;
+    input.globalAvgPool2d(output);
+}
+
 void GlobalAveragePooling2D::backprop(
     const Tensor &input,
     float learningRate,
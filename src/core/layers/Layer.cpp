@@ -1,7 +1,9 @@
 #include "core/layers/Layer.h"
 #include "core/tensor/Tensor.h"
+#include "core/tensor/CsrTensor.h"
+#include "utils/ConsoleUtils.h"
 
-Layer::Layer() : maxBatchSize(0) {}
+Layer::Layer() : maxBatchSize(0), sparseInput(false), mixedPrecision(false) {}
 
 void Layer::syncBuffers() {}
 
@@ -28,14 +30,69 @@ size_t Layer::getMaxBatchSize() const {
     return maxBatchSize;
 }
 
+void Layer::setSparseInput(bool sparse) {
+    sparseInput = sparse;
+}
+
+bool Layer::isSparseInput() const {
+    return sparseInput;
+}
+
+// Layers that support it keep their training buffers in bf16 from the next build on.
+void Layer::setMixedPrecision(bool isMixed) {
+    mixedPrecision = isMixed;
+}
+
+bool Layer::isMixedPrecision() const {
+    return mixedPrecision;
+}
+
+void Layer::forwardSparse(const CsrTensor &prevActivations) {
+    ConsoleUtils::fatalError(
+        "Sparse input is only supported when the first layer is Dense."
+    );
+}
+
+void Layer::backpropSparse(const CsrTensor &prevActivations, float learningRate, Tensor &grad) {
+    ConsoleUtils::fatalError(
+        "Sparse input is only supported when the first layer is Dense."
+    );
+}
+
+// Initializes any missing parameters without allocating training buffers.
+void Layer::initInference(const vector<size_t> &inShape) {}
+
+void Layer::inferSparse(const CsrTensor &input, Tensor &output) const {
+    ConsoleUtils::fatalError(
+        "Sparse input is only supported when the first layer is Dense."
+    );
+}
+
+vector<size_t> Layer::getInferScratchShape(const vector<size_t> &inShape) const {
+    return {};
+}
+
+// Rebuilds any inference-only copy of the weights after they change.
+void Layer::packWeights() {}
+
+// Layers with weights switch to int8 inference given the largest calibrated input per channel
+// and return whether they did. An empty list switches them back to fp32.
+bool Layer::quantize(const vector<float> &inputRanges) {
+    return false;
+}
+
+// Layers without parameters share an empty tensor, since a temporary would dangle.
 const Tensor& Layer::getWeights() const {
-    return Tensor();
+    static const Tensor empty;
+    return empty;
 }
 
 const Tensor& Layer::getBiases() const {
-    return Tensor();
+    static const Tensor empty;
+    return empty;
 }
 
 const Tensor& Layer::getDeltaInputs() const {
-    return Tensor();
+    static const Tensor empty;
+    return empty;
 }
\ No newline at end of file
@@ -64,7 +64,23 @@ void MaxPooling2D::initMaxIndices() {
 
 vector<size_t> MaxPooling2D::getBuildOutShape(const vector<size_t> &inShape) const {
     checkBuildSize(inShape);
-    return {getMaxBatchSize(), winIn.outRows, winIn.outCols, inShape[3]};
+    WindowDims win = Tensor::computeInputWindow(inShape, kRows, kCols, padding, stride);
+    return {inShape[0], win.outRows, win.outCols, inShape[3]};
+}
+
+vector<size_t> MaxPooling2D::getInferScratchShape(const vector<size_t> &inShape) const {
+    checkBuildSize(inShape);
+    if (padding == Tensor::Paddings::NONE)
+        return {};
+
+    WindowDims win = Tensor::computeInputWindow(inShape, kRows, kCols, padding, stride);
+    return {inShape[0], inShape[1] + win.padRows, inShape[2] + win.padCols, inShape[3]};
+}
+
+void MaxPooling2D::infer(const Tensor &input, Tensor &output, Tensor &scratch) const {
+    WindowDims win = Tensor::computeInputWindow(input.getShape(), kRows, kCols, padding, stride);
+    const Tensor &inputFwd = input.padIfNeeded(scratch, win, padding, numeric_limits<float>::lowest());
+    inputFwd.maxPool2d(kRows, kCols, stride, output, win);
 }
 
 void MaxPooling2D::reShapeBatch(size_t currBatchSize) {
@@ -23,30 +23,26 @@ void ProgressAccuracy::update(
     float batchTotalLoss
 ) {
     ProgressMetric::update(batch, loss, outputActivations, batchTotalLoss);
-    updateCorrectPredictions(
-        batch.getData(), batch.getTargets().getFlat(),
-        outputActivations, &batch.getIndices()
-    );
+    updateCorrectPredictions(batch.getTargets().getFlat(), outputActivations, &batch.getIndices());
 }
 
 void ProgressAccuracy::update(
-    const Tensor &features,
+    size_t numBatchSamples,
     const vector<float> &targets,
     const Loss *loss,
     const Tensor &outputActivations,
     float batchTotalLoss
 ) {
-    ProgressMetric::update(features, targets, loss, outputActivations, batchTotalLoss);
-    updateCorrectPredictions(features, targets, outputActivations);
+    ProgressMetric::update(numBatchSamples, targets, loss, outputActivations, batchTotalLoss);
+    updateCorrectPredictions(targets, outputActivations);
 }
 
 void ProgressAccuracy::updateCorrectPredictions(
-    const Tensor &features,
     const vector<float> &targets,
     const Tensor &outputActivations,
     const vector<size_t> *indices
 ) {
-    size_t batchSize = features.getShape()[0];
+    size_t batchSize = outputActivations.getShape()[0];
     Matrix probsMat = outputActivations.M();
     size_t numCols = probsMat.getNumCols();
     const vector<float> &probsFlat = outputActivations.getFlat();
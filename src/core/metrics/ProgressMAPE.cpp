@@ -22,29 +22,23 @@ void ProgressMAPE::update(
     float batchTotalLoss
 ) {
     ProgressMetric::update(batch, loss, outputActivations, batchTotalLoss);
-    accumulateMAPE(
-        batch.getData(), batch.getTargets().getFlat(), loss, 
-        outputActivations, batchTotalLoss
-    );
+    accumulateMAPE(batch.getTargets().getFlat(), outputActivations);
 }
 
 void ProgressMAPE::update(
-    const Tensor &features,
+    size_t numBatchSamples,
     const vector<float> &targets,
     const Loss *loss,
     const Tensor &outputActivations,
     float batchTotalLoss
 ) {
-    ProgressMetric::update(features, targets, loss, outputActivations, batchTotalLoss);
-    accumulateMAPE(features, targets, loss, outputActivations, batchTotalLoss);
+    ProgressMetric::update(numBatchSamples, targets, loss, outputActivations, batchTotalLoss);
+    accumulateMAPE(targets, outputActivations);
 }
 
 void ProgressMAPE::accumulateMAPE(
-    const Tensor &features,
     const vector<float> &targets,
-    const Loss *loss,
-    const Tensor &outputActivations,
-    float batchTotalLoss
+    const Tensor &outputActivations
 ) {
     const vector<float> &outputFlat = outputActivations.getFlat();
     size_t numBatchSamples = outputActivations.getSize();
@@ -23,13 +23,13 @@ void ProgressMetric::update(
 }
 
 void ProgressMetric::update(
-    const Tensor &features,
+    size_t numBatchSamples,
     const vector<float> &targets,
     const Loss *loss,
     const Tensor &outputActivations,
     float batchTotalLoss
 ) {
-    samplesProcessed += features.getShape()[0];
+    samplesProcessed += numBatchSamples;
     updateCommon(loss, outputActivations, batchTotalLoss);
 }
 
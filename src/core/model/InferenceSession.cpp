@@ -0,0 +1,314 @@
+#include "core/model/InferenceSession.h"
+#include "core/model/NeuralNet.h"
+#include "core/layers/Layer.h"
+#include "core/tensor/CsrTensor.h"
+#include "utils/ConsoleUtils.h"
+#include <cstring>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+const size_t InferenceSession::AUTO_BATCH_SIZE = 0;
+const vector<size_t> InferenceSession::TUNE_CANDIDATES = {8, 16, 32, 64, 128, 256, 512, 1024};
+const size_t InferenceSession::TUNE_BATCHES = 2;
+const size_t InferenceSession::TUNE_REPEATS = 3;
+
+// Sessions only read the model's weights (repacking them under a lock after training), so any
+// number of them may run concurrently on one NeuralNet as long as it is not trained meanwhile.
+InferenceSession::InferenceSession(
+    NeuralNet &model,
+    size_t maxBatchSize,
+    const vector<size_t> &sampleShape,
+    bool isSparse
+) : model(model), maxBatchSize(maxBatchSize), currBatchSize(maxBatchSize), 
+    sampleShape(sampleShape), isSparse(isSparse), layoutGeneration(0), channelRanges(nullptr) {
+    if (maxBatchSize == 0) {
+        ConsoleUtils::fatalError("Inference session batch size must be greater than 0.");
+    }
+
+    if (isSparse && model.getLayers()[0]->getEncoding() != Layer::Encodings::Dense) {
+        ConsoleUtils::fatalError("Sparse input is only supported when the first layer is Dense.");
+    }
+
+    allocateWorkspace();
+}
+
+// Sizes every layer's output (and padding scratch) for the max batch once up front.
+void InferenceSession::allocateWorkspace() {
+    batchShape = {maxBatchSize};
+    batchShape.insert(batchShape.end(), sampleShape.begin(), sampleShape.end());
+
+    if (!isSparse) {
+        batchInput = Tensor(batchShape);
+    }
+
+    allocateLayerWorkspace();
+}
+
+void InferenceSession::allocateLayerWorkspace() {
+    const vector<Layer*> &layers = model.getLayers();
+    size_t numLayers = layers.size();
+    layoutGeneration = model.getLayoutGeneration();
+    currBatchSize = maxBatchSize;
+
+    vector<size_t> inShape = {maxBatchSize};
+    inShape.insert(inShape.end(), sampleShape.begin(), sampleShape.end());
+
+    outputs.resize(numLayers);
+    scratch.resize(numLayers);
+    outShapes.resize(numLayers);
+    scratchShapes.resize(numLayers);
+
+    model.initInference(inShape);
+    for (size_t i = 0; i < numLayers; i++) {
+        scratchShapes[i] = layers[i]->getInferScratchShape(inShape);
+        scratch[i] = scratchShapes[i].empty() ? Tensor() : Tensor(scratchShapes[i]);
+
+        outShapes[i] = layers[i]->getBuildOutShape(inShape);
+        outputs[i] = Tensor(outShapes[i]);
+        inShape = outShapes[i];
+    }
+
+    model.packWeights();
+}
+
+// Quantizing the model changes how much scratch its layers need, so the layer workspace is
+// rebuilt before the next run of a session created earlier.
+bool InferenceSession::isStale() const {
+    return layoutGeneration != model.getLayoutGeneration();
+}
+
+void InferenceSession::checkLayout() {
+    if (isStale()) {
+        allocateLayerWorkspace();
+    }
+}
+
+void InferenceSession::checkBatchSize(size_t batchSize) const {
+    if (batchSize == 0 || batchSize > maxBatchSize) {
+        ConsoleUtils::fatalError(
+            "Inference batch of " + to_string(batchSize) + " samples does not fit the session "
+            "(max batch size " + to_string(maxBatchSize) + ")."
+        );
+    }
+}
+
+void InferenceSession::reShapeWorkspace(size_t batchSize) {
+    if (batchSize == currBatchSize)
+        return;
+
+    currBatchSize = batchSize;
+    size_t numLayers = outputs.size();
+    for (size_t i = 0; i < numLayers; i++) {
+        outShapes[i][0] = batchSize;
+        outputs[i].reShapeInPlace(outShapes[i]);
+
+        if (!scratchShapes[i].empty()) {
+            scratchShapes[i][0] = batchSize;
+            scratch[i].reShapeInPlace(scratchShapes[i]);
+        }
+    }
+}
+
+const Tensor& InferenceSession::runLayers(const Tensor &input, size_t firstLayer) {
+    const vector<Layer*> &layers = model.getLayers();
+    size_t numLayers = layers.size();
+    const Tensor *prevActivations = &input;
+
+    for (size_t i = firstLayer; i < numLayers; i++) {
+        if (channelRanges != nullptr) {
+            trackRanges(*prevActivations, (*channelRanges)[i]);
+        }
+
+        layers[i]->infer(*prevActivations, outputs[i], scratch[i]);
+        prevActivations = &outputs[i];
+    }
+
+    return outputs.back();
+}
+
+const Tensor& InferenceSession::run(const Tensor &batch) {
+    size_t batchSize = batch.getShape()[0];
+    checkBatchSize(batchSize);
+    checkLayout();
+    reShapeWorkspace(batchSize);
+    model.packWeights();
+
+    return runLayers(batch, 0);
+}
+
+const Tensor& InferenceSession::run(const CsrTensor &batch) {
+    size_t batchSize = batch.getNumRows();
+    checkBatchSize(batchSize);
+    checkLayout();
+    reShapeWorkspace(batchSize);
+    model.packWeights();
+
+    model.getLayers()[0]->inferSparse(batch, outputs[0]);
+    return runLayers(outputs[0], 1);
+}
+
+void InferenceSession::cpyBatchToOutput(
+    const Tensor &batchOutput,
+    size_t start,
+    size_t batchSize,
+    Tensor &output
+) const {
+    size_t outputFloats = getOutputSize();
+    memcpy(
+        output.getFlat().data() + start * outputFloats, 
+        batchOutput.getFlat().data(), 
+        batchSize * outputFloats * sizeof(float)
+    );
+}
+
+const Tensor& InferenceSession::runRange(const SampleView &features, size_t start, size_t batchSize) {
+    if (isSparse) {
+        CsrTensor batch = features.gatherRangeSparse(start, batchSize);
+        return run(batch);
+    }
+
+    batchShape[0] = batchSize;
+    batchInput.reShapeInPlace(batchShape);
+    features.gatherRange(start, batchSize, batchInput.getFlat().data());
+    return run(batchInput);
+}
+
+Tensor InferenceSession::predict(const SampleView &features) {
+    if (!isCompatible(features.getShape(), features.isSparse())) {
+        ConsoleUtils::fatalError("Sample shape does not match the inference session.");
+    }
+
+    size_t numSamples = features.getNumSamples();
+    vector<size_t> outputShape = outShapes.back();
+    outputShape[0] = numSamples;
+    Tensor output(outputShape);
+
+    for (size_t start = 0; start < numSamples; start += maxBatchSize) {
+        size_t batchSize = min(maxBatchSize, numSamples - start);
+        cpyBatchToOutput(runRange(features, start, batchSize), start, batchSize, output);
+    }
+
+    return output;
+}
+
+// Predicts like predict() while recording, for the input of every layer, the largest absolute
+// value seen on each channel (the last dimension). A sparse first layer gets no ranges.
+Tensor InferenceSession::calibrate(const SampleView &features, vector<vector<float> > &ranges) {
+    ranges.assign(model.getLayers().size(), vector<float>());
+    channelRanges = &ranges;
+    Tensor output = predict(features);
+    channelRanges = nullptr;
+
+    return output;
+}
+
+void InferenceSession::trackRanges(const Tensor &input, vector<float> &ranges) const {
+    const vector<size_t> &shape = input.getShape();
+    size_t numChannels = shape.back();
+    size_t numPixels = input.getSize() / numChannels;
+    const float *inFlat = input.getFlat().data();
+
+    ranges.resize(numChannels, 0.0f);
+    for (size_t i = 0; i < numPixels; i++) {
+        const float *pixel = inFlat + i * numChannels;
+        for (size_t c = 0; c < numChannels; c++) {
+            ranges[c] = max(ranges[c], fabs(pixel[c]));
+        }
+    }
+}
+
+double InferenceSession::timeRange(const SampleView &features, size_t numSamples) {
+    runRange(features, 0, min(maxBatchSize, numSamples));
+
+    double bestSeconds = 0.0;
+    for (size_t r = 0; r < TUNE_REPEATS; r++) {
+        auto startTime = chrono::steady_clock::now();
+        for (size_t start = 0; start < numSamples; start += maxBatchSize) {
+            runRange(features, start, min(maxBatchSize, numSamples - start));
+        }
+        chrono::duration<double> elapsed = chrono::steady_clock::now() - startTime;
+
+        if (r == 0 || elapsed.count() < bestSeconds) {
+            bestSeconds = elapsed.count();
+        }
+    }
+
+    return bestSeconds;
+}
+
+// Times each candidate batch size whose workspace fits in maxWorkspaceBytes on the same
+// leading samples and keeps the fastest session.
+InferenceSession* InferenceSession::tune(
+    NeuralNet &model,
+    const SampleView &features,
+    size_t maxWorkspaceBytes
+) {
+    vector<size_t> sampleShape(features.getShape().begin() + 1, features.getShape().end());
+    bool sparse = features.isSparse();
+    size_t numSamples = features.getNumSamples();
+
+    size_t sampleBytes = InferenceSession(model, 1, sampleShape, sparse).getWorkspaceBytes();
+    size_t maxFit = max((size_t) 1, maxWorkspaceBytes / max(sampleBytes, (size_t) 1));
+
+    vector<size_t> candidates;
+    for (size_t candidate : TUNE_CANDIDATES) {
+        if (candidate <= maxFit && (candidates.empty() || candidates.back() < numSamples)) {
+            candidates.push_back(candidate);
+        }
+    }
+
+    if (candidates.size() <= 1) {
+        size_t batchSize = candidates.empty() ? maxFit : candidates[0];
+        return new InferenceSession(model, min(batchSize, max(numSamples, (size_t) 1)), sampleShape, sparse);
+    }
+
+    size_t tuneSamples = min(numSamples, candidates.back() * TUNE_BATCHES);
+    InferenceSession *best = nullptr;
+    double bestSeconds = 0.0;
+
+    for (size_t candidate : candidates) {
+        InferenceSession *session = new InferenceSession(model, candidate, sampleShape, sparse);
+        double seconds = session->timeRange(features, tuneSamples);
+
+        if (best == nullptr || seconds < bestSeconds) {
+            delete best;
+            best = session;
+            bestSeconds = seconds;
+        } else {
+            delete session;
+        }
+    }
+
+    return best;
+}
+
+bool InferenceSession::isCompatible(const vector<size_t> &featureShape, bool sparse) const {
+    if (sparse != isSparse || featureShape.size() != sampleShape.size() + 1)
+        return false;
+
+    return equal(sampleShape.begin(), sampleShape.end(), featureShape.begin() + 1);
+}
+
+size_t InferenceSession::getMaxBatchSize() const {
+    return maxBatchSize;
+}
+
+size_t InferenceSession::getWorkspaceBytes() const {
+    size_t numFloats = batchInput.getFlat().size();
+    for (size_t i = 0; i < outputs.size(); i++) {
+        numFloats += outputs[i].getFlat().size() + scratch[i].getFlat().size();
+    }
+
+    return numFloats * sizeof(float);
+}
+
+size_t InferenceSession::getOutputSize() const {
+    const vector<size_t> &outShape = outShapes.back();
+    size_t outputSize = 1;
+    for (size_t i = 1; i < outShape.size(); i++) {
+        outputSize *= outShape[i];
+    }
+
+    return outputSize;
+}
\ No newline at end of file
@@ -18,24 +18,50 @@
 #include <cstring>
 #include "core/layers/Dropout.h"
 #include "core/layers/GlobalAveragePooling2D.h"
+#include "core/layers/Embedding.h"
 #include <cerrno>
+#include <chrono>
 #include "utils/EarlyStop.h"
+#include "core/tensor/CsrTensor.h"
+#include "core/model/InferenceSession.h"
+#include "utils/TrainingUtils.h"
+#include <iomanip>
 
 const size_t NeuralNet::INFERENCE_BATCH_SIZE = 8;
+const float NeuralNet::INFERENCE_MEMORY_MB = 256.0f;
+const float NeuralNet::BYTES_PER_MEGABYTE = 1024.0f * 1024.0f;
+const size_t NeuralNet::CALIBRATION_BATCH_SIZE = 64;
 
 random_device NeuralNet::rd;
 mt19937 NeuralNet::generator(NeuralNet::rd());
 
 NeuralNet::NeuralNet(vector<Layer*> layers, Loss *loss) : 
-    layers(layers), loss(loss) {}
+    layers(layers), loss(loss), shuffleBlockSize(0), 
+    shuffleWindowBlocks(0), gatherBandwidth(0.0f), session(nullptr), sessionBatchSize(0),
+    inferenceBatchSize(INFERENCE_BATCH_SIZE), inferenceMemoryMb(INFERENCE_MEMORY_MB), isPacked(false),
+    layoutGeneration(0), mixedPrecision(false) {}
 
-NeuralNet::NeuralNet() : loss(nullptr) {}
+NeuralNet::NeuralNet() : 
+    loss(nullptr), shuffleBlockSize(0), shuffleWindowBlocks(0), 
+    gatherBandwidth(0.0f), session(nullptr), sessionBatchSize(0),
+    inferenceBatchSize(INFERENCE_BATCH_SIZE), inferenceMemoryMb(INFERENCE_MEMORY_MB), isPacked(false),
+    layoutGeneration(0), mixedPrecision(false) {}
 
 NeuralNet::NeuralNet(const NeuralNet &other)
     : avgLosses(other.avgLosses),
       loss(other.loss ? other.loss->clone() : nullptr),
       maxBatchSize(other.maxBatchSize),
-      dL(other.dL)
+      dL(other.dL),
+      shuffleBlockSize(other.shuffleBlockSize),
+      shuffleWindowBlocks(other.shuffleWindowBlocks),
+      gatherBandwidth(other.gatherBandwidth),
+      session(nullptr),
+      sessionBatchSize(0),
+      inferenceBatchSize(other.inferenceBatchSize),
+      inferenceMemoryMb(other.inferenceMemoryMb),
+      isPacked(false),
+      layoutGeneration(0),
+      mixedPrecision(other.mixedPrecision)
 {
     layers.reserve(other.layers.size());
     for (const Layer *layer : other.layers) {
@@ -47,35 +73,49 @@ NeuralNet* NeuralNet::clone() const {
     return new NeuralNet(*this);
 }
 
+// Shared by the shuffles and the layers that draw their initial parameters serially.
+mt19937& NeuralNet::getGenerator() {
+    return generator;
+}
+
 void NeuralNet::fit(
-    const Tensor &features,
+    const SampleView &features,
     const vector<float> &targets,
     float learningRate,
     float learningDecay,
     size_t numEpochs,
     size_t batchSize,
     ProgressMetric &metric,
-    const Tensor &xVal,
+    const SampleView &xVal,
     const vector<float> &yVal,
-    EarlyStop *stop
+    EarlyStop *stop,
+    const ImageAugment2D *augment
 ) {
     float initialLR = learningRate;
     avgLosses.resize(numEpochs);
-    bool hasVal = (xVal.getSize() != 0 && yVal.size() != 0);
+    bool hasVal = (!xVal.isEmpty() && yVal.size() != 0);
 
-    if (!hasVal) {
+    // Validation on the GPU reuses the training buffers, so they must be rebuilt each epoch.
+    bool rebuildEachEpoch = hasVal && GpuEngine::isUsingGpu();
+    if (!rebuildEachEpoch) {
         build(batchSize, features);
     }
 
+    clearQuantization();
+    invalidatePackedWeights();
     bool stopEpochs = false;
     for (size_t k = 0; k < numEpochs && !stopEpochs; k++) {
-        if (hasVal) {
+        if (rebuildEachEpoch) {
             build(batchSize, features);
         }
         
         cout << endl << "Epoch: " << k+1 << "/" << numEpochs << endl;
 
-        float avgLoss = runEpoch(features, targets, learningRate, batchSize, metric);
+        float avgLoss = runEpoch(features, targets, learningRate, batchSize, metric, augment, k);
+        invalidatePackedWeights();
+        if (shuffleBlockSize > 0) {
+            ConsoleUtils::printGatherBandwidth(gatherBandwidth);
+        }
         stopEpochs = validateEpoch(xVal, yVal, metric, stop, k);
 
         avgLosses[k] = avgLoss;
@@ -86,13 +126,30 @@ void NeuralNet::fit(
     ConsoleUtils::printSepLine();
 }
 
-void NeuralNet::build(size_t batchSize, const Tensor &features, bool isInference) {
+void NeuralNet::build(size_t batchSize, const SampleView &features, bool isInference) {
+    build(batchSize, features.getShape(), features.isSparse(), isInference);
+}
+
+void NeuralNet::build(size_t batchSize, vector<size_t> inShape, bool isSparse, bool isInference) {
     size_t numLayers = layers.size();
     maxBatchSize = batchSize;
-    vector<size_t> inShape = features.getShape();
     inShape[0] = maxBatchSize;
 
+    if (isSparse && GpuEngine::isUsingGpu()) {
+        ConsoleUtils::fatalError("Sparse features are only supported on the CPU.");
+    }
+    layers[0]->setSparseInput(isSparse);
+
+    if (mixedPrecision && !isInference && GpuEngine::isUsingGpu()) {
+        ConsoleUtils::fatalError("Mixed precision training is only supported on the CPU.");
+    }
+
     for (size_t i = 0; i < numLayers; i++) {
+        if (i > 0 && layers[i]->getEncoding() == Layer::Encodings::Embedding) {
+            ConsoleUtils::fatalError("Embedding must be the first layer of the network.");
+        }
+
+        layers[i]->setMixedPrecision(mixedPrecision);
         layers[i]->build(inShape, isInference);
         inShape = layers[i]->getBuildOutShape(inShape);
     }
@@ -108,20 +165,28 @@ void NeuralNet::build(size_t batchSize, const Tensor &features, bool isInference
 }
 
 float NeuralNet::runEpoch(
-    const Tensor &features,
+    const SampleView &features,
     const vector<float> &targets,
     float learningRate,
     size_t batchSize,
-    ProgressMetric &metric
+    ProgressMetric &metric,
+    const ImageAugment2D *augment,
+    size_t epoch
 ) {
     metric.init(targets.size());
     size_t numBatches = (targets.size() + batchSize - 1)/batchSize;
     vector<size_t> shuffledIndices = generateShuffledIndices(features);
+    float gatherSeconds = 0.0f;
 
     for (size_t b = 0; b < numBatches; b++) {
         size_t start = b * batchSize;
         size_t end = min((b + 1) * batchSize, targets.size());
-        Batch batch = makeBatch(start, end, features, targets, shuffledIndices);
+
+        chrono::steady_clock::time_point gatherStart = chrono::steady_clock::now();
+        Batch batch = makeBatch(
+            start, end, features, targets, shuffledIndices, augment, epoch
+        );
+        gatherSeconds += chrono::duration<float>(chrono::steady_clock::now() - gatherStart).count();
         
         fitBatch(batch, learningRate);
         float batchTotalLoss = loss->calculateTotalLoss(batch.getTargets(), layers.back()->getOutput());
@@ -130,6 +195,9 @@ float NeuralNet::runEpoch(
         ConsoleUtils::printProgressBar(metric);
     }
 
+    float gatherMegabytes = (float) targets.size() * features.getSampleBytes() / BYTES_PER_MEGABYTE;
+    gatherBandwidth = (gatherSeconds > 0.0f) ? gatherMegabytes / gatherSeconds : 0.0f;
+
     return metric.getTotalLoss()/targets.size();
 }
 
@@ -139,7 +207,11 @@ void NeuralNet::fitBatch(const Batch &batch, float learningRate) {
             fitBatchGpu(batch, learningRate);
         #endif
     } else {
-        forwardPass(batch.getData());
+        if (batch.isSparse()) {
+            forwardPassSparse(batch.getSparseData());
+        } else {
+            forwardPass(batch.getData());
+        }
         backprop(batch, learningRate);
     }
 }
@@ -147,14 +219,16 @@ void NeuralNet::fitBatch(const Batch &batch, float learningRate) {
 Batch NeuralNet::makeBatch(
     size_t start,
     size_t end,
-    const Tensor &features,
+    const SampleView &features,
     const vector<float> &targets,
-    const vector<size_t> &shuffledIndices
+    const vector<size_t> &shuffledIndices,
+    const ImageAugment2D *augment,
+    size_t epoch
 ) const {
     size_t batchSize = end - start;
     Batch batch = Batch(layers.size() + 1, batchSize);
     batch.setBatchIndices(start, end, shuffledIndices);
-    batch.setBatch(features, targets);
+    batch.setBatch(features, targets, augment, epoch);
 
     return batch;
 }
@@ -169,6 +243,17 @@ void NeuralNet::forwardPass(const Tensor &batch) {
     }
 }
 
+void NeuralNet::forwardPassSparse(const CsrTensor &batch) {
+    layers[0]->forwardSparse(batch);
+    const Tensor *prevActivations = &layers[0]->getOutput();
+    size_t numLayers = layers.size();
+
+    for (size_t j = 1; j < numLayers; j++) {
+        layers[j]->forward(*prevActivations);
+        prevActivations = &layers[j]->getOutput();
+    }
+}
+
 void NeuralNet::reShapeDL(size_t currBatchSize) {
     if (dL.getSize() == 0)
         return;
@@ -189,6 +274,11 @@ void NeuralNet::backprop(const Batch &batch, float learningRate) {
     Tensor *grad = &dL;
     for (int i = numLayers - 1; i >= 0; i--) {
         bool isFirstLayer = (i == 0);
+        if (isFirstLayer && batch.isSparse()) {
+            layers[i]->backpropSparse(batch.getSparseData(), learningRate, *grad);
+            break;
+        }
+
         const Tensor &prevActivations = ((i == 0) 
             ? batch.getData() 
             : layers[i-1]->getOutput());
@@ -200,13 +290,13 @@ void NeuralNet::backprop(const Batch &batch, float learningRate) {
 }
 
 bool NeuralNet::validateEpoch(
-    const Tensor &xVal,
+    const SampleView &xVal,
     const vector<float> &yVal,
     ProgressMetric &metric,
     EarlyStop *stop,
     size_t epoch
 ) {
-    if (xVal.getSize() == 0 || yVal.size() == 0)
+    if (xVal.isEmpty() || yVal.size() == 0)
         return false;
 
     metric.init(yVal.size());
@@ -215,7 +305,7 @@ bool NeuralNet::validateEpoch(
     Tensor yValTensor = Tensor(yVal, {yVal.size()});
     float totalLoss = loss->calculateTotalLoss(yValTensor, preds);
 
-    metric.update(xVal, yVal, loss, preds, totalLoss);
+    metric.update(yVal.size(), yVal, loss, preds, totalLoss);
     ConsoleUtils::printValidationMetrics(metric);
 
     if (stop == nullptr)
@@ -227,16 +317,12 @@ bool NeuralNet::validateEpoch(
 Tensor NeuralNet::makeInferenceBatch(
     size_t start,
     size_t batchSize,
-    size_t sampleFloats,
-    const Tensor &features
+    const SampleView &features
 ) const {
     vector<size_t> batchShape = features.getShape();
     batchShape[0] = batchSize;
     Tensor batch = Tensor(batchShape);
-
-    size_t sampleStartFloat = start * sampleFloats;
-    size_t bytes = batchSize * sampleFloats * sizeof(float);
-    memcpy(batch.getFlat().data(), features.getFlat().data() + sampleStartFloat, bytes);
+    features.gatherRange(start, batchSize, batch.getFlat().data());
 
     return batch;
 }
@@ -251,12 +337,25 @@ void NeuralNet::forwardPassInference(const Tensor &batch) {
     }
 }
 
+void NeuralNet::forwardInferenceBatch(
+    size_t start,
+    size_t batchSize,
+    const SampleView &features
+) {
+    if (features.isSparse()) {
+        CsrTensor batch = features.gatherRangeSparse(start, batchSize);
+        forwardPassSparse(batch);
+    } else {
+        Tensor batch = makeInferenceBatch(start, batchSize, features);
+        forwardPassInference(batch);
+    }
+}
+
 void NeuralNet::cpyBatchToOutput(
     size_t start,
     size_t batchSize,
     size_t batchIdx,
     size_t numSamples,
-    const Tensor &batch,
     Tensor &output
 ) const {
     const Tensor &endLayerOutput = layers.back()->getOutput();
@@ -272,33 +371,226 @@ void NeuralNet::cpyBatchToOutput(
     memcpy(output.getFlat().data() + (outputStartFloat), endLayerOutput.getFlat().data(), outBytes);
 }
 
-Tensor NeuralNet::predict(const Tensor &features) {
-    build(INFERENCE_BATCH_SIZE, features, true);
+Tensor NeuralNet::predict(const SampleView &features) {
+    return predict(features, inferenceBatchSize);
+}
 
-    size_t numSamples = features.getShape()[0];
-    size_t numBatches = (numSamples + INFERENCE_BATCH_SIZE - 1) / INFERENCE_BATCH_SIZE;
-    size_t sampleFloats = features.getSize() / numSamples;
+Tensor NeuralNet::predict(const SampleView &features, size_t batchSize) {
+    if (GpuEngine::isUsingGpu()) {
+        return predictGpu(features, batchSize == InferenceSession::AUTO_BATCH_SIZE ? INFERENCE_BATCH_SIZE : batchSize);
+    }
+
+    if (session == nullptr || sessionBatchSize != batchSize ||
+        !session->isCompatible(features.getShape(), features.isSparse())
+    ) {
+        resetSession();
+        if (batchSize == InferenceSession::AUTO_BATCH_SIZE) {
+            size_t maxWorkspaceBytes = (size_t) (inferenceMemoryMb * BYTES_PER_MEGABYTE);
+            session = InferenceSession::tune(*this, features, maxWorkspaceBytes);
+        } else {
+            vector<size_t> sampleShape(features.getShape().begin() + 1, features.getShape().end());
+            session = new InferenceSession(*this, batchSize, sampleShape, features.isSparse());
+        }
+        sessionBatchSize = batchSize;
+    }
+
+    return session->predict(features);
+}
+
+Tensor NeuralNet::predictGpu(const SampleView &features, size_t batchSize) {
+    build(batchSize, features, true);
+
+    size_t numSamples = features.getNumSamples();
+    size_t numBatches = (numSamples + batchSize - 1) / batchSize;
 
     Tensor output;
     for (size_t i = 0; i < numBatches; i++) {
-        size_t start = i * INFERENCE_BATCH_SIZE;
-        size_t end = min((i + 1) * INFERENCE_BATCH_SIZE, numSamples);
-        size_t batchSize = end - start;
+        size_t start = i * batchSize;
+        size_t end = min((i + 1) * batchSize, numSamples);
+        size_t currBatchSize = end - start;
 
-        Tensor batch = makeInferenceBatch(start, batchSize, sampleFloats, features);
-        forwardPassInference(batch);
-        cpyBatchToOutput(start, batchSize, i, numSamples, batch, output);
+        forwardInferenceBatch(start, currBatchSize, features);
+        cpyBatchToOutput(start, currBatchSize, i, numSamples, output);
     }
 
     return output;
 }
 
-vector<size_t> NeuralNet::generateShuffledIndices(const Tensor &features) const {
+void NeuralNet::resetSession() {
+    delete session;
+    session = nullptr;
+}
+
+const vector<Layer*>& NeuralNet::getLayers() const {
+    return layers;
+}
+
+// Creates any missing parameters once per sample shape. Sessions on other threads may be
+// inferring while a new shape is initialized, so on the CPU the layers only write state they do
+// not have yet and leave existing parameters and settings alone. A new shape does not repack:
+// parameters are only created while nothing is packed, and fit() and loadBestWeights()
+// invalidate the panels when the weights change.
+void NeuralNet::initInference(const vector<size_t> &batchShape) {
+    lock_guard<mutex> lock(inferenceMutex);
+    bool isInitialized = equal(
+        batchShape.begin() + 1, batchShape.end(), 
+        inferenceSampleShape.begin(), inferenceSampleShape.end()
+    );
+
+    if (isInitialized && !GpuEngine::isUsingGpu())
+        return;
+
+    vector<size_t> inShape = batchShape;
+    size_t numLayers = layers.size();
+    for (size_t i = 0; i < numLayers; i++) {
+        if (i > 0 && layers[i]->getEncoding() == Layer::Encodings::Embedding) {
+            ConsoleUtils::fatalError("Embedding must be the first layer of the network.");
+        }
+
+        layers[i]->initInference(inShape);
+        if (GpuEngine::isUsingGpu()) {
+            layers[i]->syncBuffers();
+        }
+
+        inShape = layers[i]->getBuildOutShape(inShape);
+    }
+
+    inferenceSampleShape.assign(batchShape.begin() + 1, batchShape.end());
+}
+
+// Called before every inference run; only repacks after the weights changed.
+void NeuralNet::packWeights() {
+    if (isPacked.load(memory_order_acquire))
+        return;
+
+    lock_guard<mutex> lock(inferenceMutex);
+    if (isPacked.load(memory_order_relaxed))
+        return;
+
+    for (Layer *layer : layers) {
+        if (GpuEngine::isUsingGpu()) {
+            layer->syncBuffers();
+        }
+        layer->packWeights();
+    }
+
+    isPacked.store(true, memory_order_release);
+}
+
+void NeuralNet::invalidatePackedWeights() {
+    isPacked.store(false);
+}
+
+// Sessions compare this with the generation they were sized for and rebuild their workspace when
+// quantization changed the layers.
+size_t NeuralNet::getLayoutGeneration() const {
+    return layoutGeneration.load(memory_order_acquire);
+}
+
+// Calibrates per-channel input ranges on the given samples, then switches Dense and Conv2D
+// layers to int8 inference where it is faster. Outputs on the eval set (or the calibration set) are compared
+// against fp32. Sessions created before this call resize their scratch on their next run.
+void NeuralNet::quantize(const SampleView &calibration, const SampleView &xEval, const vector<float> &yEval) {
+    if (GpuEngine::isUsingGpu()) {
+        ConsoleUtils::fatalError("Quantization is only supported on the CPU.");
+    }
+
+    if (calibration.isEmpty() || calibration.getNumSamples() == 0) {
+        ConsoleUtils::fatalError("Quantization requires at least one calibration sample.");
+    }
+
+    clearQuantization();
+    vector<size_t> sampleShape(calibration.getShape().begin() + 1, calibration.getShape().end());
+    vector<vector<float> > ranges;
+    InferenceSession calibrator(*this, CALIBRATION_BATCH_SIZE, sampleShape, calibration.isSparse());
+    Tensor calibrationOut = calibrator.calibrate(calibration, ranges);
+
+    const SampleView &eval = xEval.isEmpty() ? calibration : xEval;
+    Tensor floatOut = xEval.isEmpty() ? calibrationOut : predict(eval, CALIBRATION_BATCH_SIZE);
+
+    size_t numQuantized = 0;
+    {
+        lock_guard<mutex> lock(inferenceMutex);
+        size_t numLayers = layers.size();
+        for (size_t i = 0; i < numLayers; i++) {
+            if (layers[i]->quantize(ranges[i])) {
+                numQuantized++;
+            }
+        }
+        layoutGeneration.fetch_add(1, memory_order_release);
+    }
+
+    resetSession();
+    cout << "Int8 Layers: " << numQuantized << "/" << layers.size() << endl;
+    if (numQuantized == 0)
+        return;
+
+    Tensor quantOut = predict(eval, CALIBRATION_BATCH_SIZE);
+    printQuantizationReport(floatOut, quantOut, xEval.isEmpty() ? vector<float>() : yEval);
+}
+
+void NeuralNet::clearQuantization() {
+    {
+        lock_guard<mutex> lock(inferenceMutex);
+        for (Layer *layer : layers) {
+            layer->quantize(vector<float>());
+        }
+        layoutGeneration.fetch_add(1, memory_order_release);
+    }
+    resetSession();
+}
+
+void NeuralNet::printQuantizationReport(
+    const Tensor &floatOut, 
+    const Tensor &quantOut, 
+    const vector<float> &targets
+) const {
+    const vector<float> &floatFlat = floatOut.getFlat();
+    const vector<float> &quantFlat = quantOut.getFlat();
+    size_t size = floatFlat.size();
+    size_t numOutputs = floatOut.getShape().back();
+
+    float maxDelta = 0.0f;
+    double sumDelta = 0.0;
+    for (size_t i = 0; i < size; i++) {
+        float delta = fabs(floatFlat[i] - quantFlat[i]);
+        maxDelta = max(maxDelta, delta);
+        sumDelta += delta;
+    }
+
+    cout << fixed << setprecision(6)
+         << "Int8 Output Delta (max/mean): " << maxDelta << " / " << sumDelta / size << endl;
+
+    if (numOutputs > 1) {
+        vector<float> floatPreds = TrainingUtils::getPredictions(floatOut);
+        vector<float> quantPreds = TrainingUtils::getPredictions(quantOut);
+        cout << setprecision(2)
+             << "Int8 Top-1 Agreement: " << 100.0f * TrainingUtils::getAccuracy(floatPreds, quantPreds) << "%" << endl;
+
+        if (!targets.empty()) {
+            cout << "Accuracy (fp32/int8): " 
+                 << 100.0f * TrainingUtils::getAccuracy(targets, floatPreds) << "% / "
+                 << 100.0f * TrainingUtils::getAccuracy(targets, quantPreds) << "%" << endl;
+        }
+    } else if (!targets.empty()) {
+        cout << "RMSE (fp32/int8): " 
+             << TrainingUtils::getRMSE(floatOut, targets) << " / "
+             << TrainingUtils::getRMSE(quantOut, targets) << endl;
+    }
+
+    cout << defaultfloat << setprecision(6);
+}
+
+vector<size_t> NeuralNet::generateShuffledIndices(const SampleView &features) const {
     if (features.getShape().size() == 0) {
         return vector<size_t>();
     }
 
-    size_t size = features.getShape()[0];
+    size_t size = features.getNumSamples();
+    if (shuffleBlockSize > 0) {
+        return generateBlockShuffledIndices(size);
+    }
+
     vector<size_t> indices(size, 0);
     
     for (size_t i = 0; i < size; i++) {
@@ -309,12 +601,82 @@ vector<size_t> NeuralNet::generateShuffledIndices(const Tensor &features) const
     return indices;
 }
 
+vector<size_t> NeuralNet::generateBlockShuffledIndices(size_t size) const {
+    size_t numBlocks = (size + shuffleBlockSize - 1) / shuffleBlockSize;
+    vector<size_t> blocks(numBlocks, 0);
+    for (size_t i = 0; i < numBlocks; i++) {
+        blocks[i] = i;
+    }
+    shuffle(blocks.begin(), blocks.end(), generator);
+
+    vector<size_t> indices;
+    indices.reserve(size);
+    for (size_t w = 0; w < numBlocks; w += shuffleWindowBlocks) {
+        size_t windowStart = indices.size();
+        size_t windowEnd = min(w + shuffleWindowBlocks, numBlocks);
+
+        for (size_t b = w; b < windowEnd; b++) {
+            size_t blockStart = blocks[b] * shuffleBlockSize;
+            size_t blockEnd = min(blockStart + shuffleBlockSize, size);
+            for (size_t i = blockStart; i < blockEnd; i++) {
+                indices.push_back(i);
+            }
+        }
+
+        shuffle(indices.begin() + windowStart, indices.end(), generator);
+    }
+
+    return indices;
+}
+
+void NeuralNet::setBlockShuffle(size_t blockSize, size_t windowBlocks) {
+    if (blockSize > 0 && windowBlocks == 0) {
+        ConsoleUtils::fatalError("Block shuffle window must contain at least one block.");
+    }
+
+    shuffleBlockSize = blockSize;
+    shuffleWindowBlocks = windowBlocks;
+}
+
+// Trains Conv2D layers with their saved inputs, pre-activations and upsampled gradients
+// stored in bf16 next to fp32 master weights. Takes effect on the next fit().
+void NeuralNet::setMixedPrecision(bool isMixed) {
+    mixedPrecision = isMixed;
+}
+
+float NeuralNet::getGatherBandwidth() const {
+    return gatherBandwidth;
+}
+
+// A batch size of InferenceSession::AUTO_BATCH_SIZE benchmarks candidate sizes on the first
+// predict call and keeps the fastest one whose workspace fits in maxWorkspaceMb.
+void NeuralNet::setInferenceBatchSize(size_t batchSize, float maxWorkspaceMb) {
+    if (maxWorkspaceMb <= 0.0f) {
+        ConsoleUtils::fatalError("Inference workspace limit must be greater than 0 MB.");
+    }
+
+    inferenceBatchSize = batchSize;
+    inferenceMemoryMb = maxWorkspaceMb;
+    resetSession();
+}
+
+size_t NeuralNet::getInferenceBatchSize() const {
+    if (session != nullptr) {
+        return session->getMaxBatchSize();
+    }
+
+    return inferenceBatchSize;
+}
+
 NeuralNet::~NeuralNet() {
     delete loss;
     deleteLayers();
 }
 
 void NeuralNet::deleteLayers() {
+    resetSession();
+    inferenceSampleShape.clear();
+    invalidatePackedWeights();
     size_t numLayers = layers.size();
     for (size_t i = 0; i < numLayers; i++) {
         delete layers[i];
@@ -393,6 +755,8 @@ Layer* NeuralNet::loadLayer(ifstream &modelBin) {
         layer = new Dropout();
     } else if (layerEncoding == Layer::Encodings::GlobalAveragePooling2D) {
         layer = new GlobalAveragePooling2D();
+    } else if (layerEncoding == Layer::Encodings::Embedding) {
+        layer = new Embedding();
     } 
 
     if (layer) {
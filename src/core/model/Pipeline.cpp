@@ -7,8 +7,11 @@
 #include "core/data/TabularData.h"
 #include "utils/Greyscale.h"
 #include "utils/Minmax.h"
+#include "utils/Standard.h"
 #include "utils/ImageTransform2D.h"
 #include "core/data/ImageData2D.h"
+#include "core/model/InferenceSession.h"
+#include <cstring>
 
 Pipeline::Pipeline() : 
     data(nullptr), 
@@ -16,7 +19,10 @@ Pipeline::Pipeline() :
     targetScalar(nullptr), 
     model(nullptr),
     imageTransformer(nullptr),
-    isLoadedPipeline(false) 
+    isLoadedPipeline(false),
+    recordData(nullptr),
+    recordSession(nullptr),
+    maxRecords(0)
 {}
 
 Pipeline::Pipeline(const Pipeline &other) 
@@ -25,10 +31,14 @@ Pipeline::Pipeline(const Pipeline &other)
       targetScalar(other.targetScalar ? other.targetScalar->clone() : nullptr),
       model(other.model ? other.model->clone() : nullptr),
       imageTransformer(other.imageTransformer ? other.imageTransformer->clone() : nullptr),
-      isLoadedPipeline(other.isLoadedPipeline)
+      isLoadedPipeline(other.isLoadedPipeline),
+      recordData(nullptr),
+      recordSession(nullptr),
+      maxRecords(0)
 {}
 
 Pipeline::~Pipeline() {
+    delete recordSession;
     delete model;
     delete data;
     delete featureScalar;
@@ -47,6 +57,7 @@ void Pipeline::checkIsLoadedPipeline(const string &message) const {
 
 void Pipeline::setData(Data *newData) {
     checkIsLoadedPipeline("Replacing the data object");
+    resetRecordInference();
     if (data != nullptr) {
         delete data;
     }
@@ -55,6 +66,7 @@ void Pipeline::setData(Data *newData) {
 
 void Pipeline::setFeatureScalar(Scalar *newFeatureScalar) {
     checkIsLoadedPipeline("Replacing the feature scalar");
+    resetRecordInference();
     if (featureScalar != nullptr) {
         delete featureScalar;
     }
@@ -63,6 +75,7 @@ void Pipeline::setFeatureScalar(Scalar *newFeatureScalar) {
 
 void Pipeline::setTargetScalar(Scalar *newTargetScalar) {
     checkIsLoadedPipeline("Replacing the target scalar");
+    resetRecordInference();
     if (targetScalar != nullptr) {
         delete targetScalar;
     }
@@ -71,12 +84,20 @@ void Pipeline::setTargetScalar(Scalar *newTargetScalar) {
 
 void Pipeline::setModel(NeuralNet *nn) {
     checkIsLoadedPipeline("Replacing the neural network");\
+    resetRecordInference();
     if (model != nullptr) {
         delete model;
     }
     model = nn;
 }
 
+void Pipeline::resetRecordInference() {
+    delete recordSession;
+    recordSession = nullptr;
+    recordData = nullptr;
+    maxRecords = 0;
+}
+
 void Pipeline::setImageTransformer2D(ImageTransform2D *transformer) {
     checkIsLoadedPipeline("Replacing the image transformer");
     if (imageTransformer != nullptr) {
@@ -105,8 +126,8 @@ ImageTransform2D* Pipeline::getImageTransformer() const {
     return imageTransformer;
 }
 
-void Pipeline::saveToBin(const string &filename) const {
-    BinUtils::savePipeline(*this, filename);
+void Pipeline::saveToBin(const string &filename, BinUtils::WeightFormats format) const {
+    BinUtils::savePipeline(*this, filename, format);
 }
 
 void Pipeline::writeBin(ofstream &modelBin) const {
@@ -185,6 +206,8 @@ void Pipeline::loadFeatureScalar(ifstream &modelBin) {
         featureScalar = new Greyscale();
     } else if(scalarEncoding == Scalar::Encodings::Minmax)  {
         featureScalar = new Minmax();
+    } else if(scalarEncoding == Scalar::Encodings::Standard)  {
+        featureScalar = new Standard();
     } else if (scalarEncoding != Scalar::Encodings::None) {
         ConsoleUtils::fatalError(
             "Unsupported scalar encoding \"" + to_string(scalarEncoding) + "\"."
@@ -204,6 +227,8 @@ void Pipeline::loadTargetScalar(ifstream &modelBin) {
         targetScalar = new Greyscale();
     } else if(scalarEncoding == Scalar::Encodings::Minmax)  {
         targetScalar = new Minmax();
+    } else if(scalarEncoding == Scalar::Encodings::Standard)  {
+        targetScalar = new Standard();
     } else if (scalarEncoding != Scalar::Encodings::None) {
         ConsoleUtils::fatalError(
             "Unsupported scalar encoding \"" + to_string(scalarEncoding) + "\"."
@@ -232,4 +257,221 @@ void Pipeline::loadComponents(ifstream &modelBin) {
     loadTargetScalar(modelBin);
     loadImageTransformer2D(modelBin);
     isLoadedPipeline = true;
+}
+
+void Pipeline::prepareScalars() {
+    featureScale.clear();
+    featureShift.clear();
+    targetScale.clear();
+    targetShift.clear();
+
+    if (featureScalar != nullptr) {
+        if (recordData->getFeatureFormat() == TabularData::Sparse) {
+            ConsoleUtils::fatalError("Feature scalars cannot be applied to sparse records.");
+        }
+
+        if (!featureScalar->getAffine(featureScale, featureShift)) {
+            ConsoleUtils::fatalError("The feature scalar does not support record inference.");
+        }
+    }
+
+    if (targetScalar != nullptr && !targetScalar->getAffine(targetScale, targetShift)) {
+        ConsoleUtils::fatalError("The target scalar does not support record inference.");
+    }
+}
+
+// Allocates all record buffers up front; predict() then reuses them for up to maxRecords rows.
+void Pipeline::prepareInference(size_t numRecords) {
+    recordData = dynamic_cast<TabularData*>(data);
+    if (model == nullptr || recordData == nullptr) {
+        ConsoleUtils::fatalError("Record prediction requires a pipeline with a model and tabular data.");
+    }
+
+    if (numRecords == 0) {
+        ConsoleUtils::fatalError("Record prediction requires at least one record.");
+    }
+
+    recordData->prepareRecords();
+    prepareScalars();
+
+    size_t recordWidth = recordData->getRecordWidth();
+    bool isSparse = recordData->getFeatureFormat() == TabularData::Sparse;
+    maxRecords = numRecords;
+    resetRecordSession();
+
+    if (isSparse) {
+        sparseRecordInput = CsrTensor(0, recordWidth);
+        sparseRecordInput.reserve(numRecords, numRecords * recordData->getNumFeatureFields());
+    } else {
+        recordShape = {numRecords, recordWidth};
+        recordInput = Tensor(recordShape);
+    }
+}
+
+// Quantizing the model after prepareInference() changes its layers, so the record session is
+// replaced while the encoded record buffers are kept.
+void Pipeline::resetRecordSession() {
+    size_t recordWidth = recordData->getRecordWidth();
+    bool isSparse = recordData->getFeatureFormat() == TabularData::Sparse;
+    delete recordSession;
+    recordSession = new InferenceSession(*model, maxRecords, {recordWidth}, isSparse);
+}
+
+size_t Pipeline::getNumFields() const {
+    if (recordData == nullptr) {
+        ConsoleUtils::fatalError("Call prepareInference() before record prediction.");
+    }
+
+    return recordData->getNumFeatureFields();
+}
+
+size_t Pipeline::getOutputSize() const {
+    if (recordData == nullptr) {
+        ConsoleUtils::fatalError("Call prepareInference() before record prediction.");
+    }
+
+    return recordSession->getOutputSize();
+}
+
+void Pipeline::applyAffine(
+    float *values,
+    size_t numRows,
+    size_t numCols,
+    const vector<float> &scale,
+    const vector<float> &shift
+) const {
+    bool broadcast = scale.size() == 1;
+    for (size_t i = 0; i < numRows; i++) {
+        float *row = values + i * numCols;
+        for (size_t j = 0; j < numCols; j++) {
+            size_t k = broadcast ? 0 : j;
+            row[j] = row[j] * scale[k] + shift[k];
+        }
+    }
+}
+
+void Pipeline::writeRecordOutput(const Tensor &modelOutput, size_t numRecords, float *output) const {
+    size_t outputSize = recordSession->getOutputSize();
+    const float *outFlat = modelOutput.getFlat().data();
+    memcpy(output, outFlat, numRecords * outputSize * sizeof(float));
+
+    if (targetScale.empty())
+        return;
+
+    bool broadcast = targetScale.size() == 1;
+    for (size_t i = 0; i < numRecords; i++) {
+        float *row = output + i * outputSize;
+        for (size_t j = 0; j < outputSize; j++) {
+            size_t k = broadcast ? 0 : j;
+            row[j] = (row[j] - targetShift[k]) / targetScale[k];
+        }
+    }
+}
+
+// Fields are the raw feature values of each record in column order (target excluded).
+void Pipeline::predict(const string_view *fields, size_t numRecords, float *output) {
+    if (numRecords == 0)
+        return;
+
+    if (numRecords > maxRecords) {
+        prepareInference(numRecords);
+    }
+
+    size_t numFields = recordData->getNumFeatureFields();
+
+    if (recordData->getFeatureFormat() == TabularData::Sparse) {
+        sparseRecordInput.clearRows();
+        for (size_t i = 0; i < numRecords; i++) {
+            encodeRecord(fields + i * numFields, sparseRecordInput);
+        }
+        predictEncoded(sparseRecordInput, output);
+    } else {
+        size_t recordWidth = recordShape[1];
+        recordShape[0] = numRecords;
+        recordInput.reShapeInPlace(recordShape);
+
+        float *inputFlat = recordInput.getFlat().data();
+        for (size_t i = 0; i < numRecords; i++) {
+            encodeRecord(fields + i * numFields, inputFlat + i * recordWidth);
+        }
+        predictEncoded(recordInput, output);
+    }
+}
+
+void Pipeline::encodeRecord(const string_view *fields, float *dst) const {
+    if (!tryEncodeRecord(fields, dst)) {
+        recordData->reportInvalidRecord(fields);
+    }
+}
+
+void Pipeline::encodeRecord(const string_view *fields, CsrTensor &dst) const {
+    if (!recordData->encodeSparseRecord(fields, dst)) {
+        recordData->reportInvalidRecord(fields);
+    }
+}
+
+// Thread safe once prepareInference() has been called. Returns false instead of exiting when a
+// numeric field does not parse, so records encoded in parallel can report errors afterwards.
+bool Pipeline::tryEncodeRecord(const string_view *fields, float *dst) const {
+    if (!recordData->encodeRecord(fields, dst))
+        return false;
+
+    if (!featureScale.empty()) {
+        applyAffine(dst, 1, recordData->getRecordWidth(), featureScale, featureShift);
+    }
+    return true;
+}
+
+// Sparse form of tryEncodeRecord(). cols and values must hold getNumFields() entries.
+bool Pipeline::tryEncodeRecord(
+    const string_view *fields, 
+    uint32_t *cols, 
+    float *values, 
+    size_t &nnz
+) const {
+    return recordData->encodeSparseRecord(fields, cols, values, nnz);
+}
+
+void Pipeline::predictEncoded(const Tensor &input, float *output) {
+    size_t numRecords = input.getShape()[0];
+    if (numRecords == 0)
+        return;
+
+    if (numRecords > maxRecords) {
+        prepareInference(numRecords);
+    } else if (recordSession->isStale()) {
+        resetRecordSession();
+    }
+
+    writeRecordOutput(recordSession->run(input), numRecords, output);
+}
+
+void Pipeline::predictEncoded(const CsrTensor &input, float *output) {
+    size_t numRecords = input.getNumRows();
+    if (numRecords == 0)
+        return;
+
+    if (numRecords > maxRecords) {
+        prepareInference(numRecords);
+    } else if (recordSession->isStale()) {
+        resetRecordSession();
+    }
+
+    writeRecordOutput(recordSession->run(input), numRecords, output);
+}
+
+void Pipeline::predict(const vector<string_view> &fields, float *output) {
+    if (maxRecords == 0) {
+        prepareInference();
+    }
+
+    size_t numFields = recordData->getNumFeatureFields();
+    if (numFields == 0 || fields.size() % numFields != 0) {
+        ConsoleUtils::fatalError(
+            "Expected a multiple of " + to_string(numFields) + " fields, but got " + 
+            to_string(fields.size()) + "."
+        );
+    }
+
+    predict(fields.data(), fields.size() / numFields, output);
 }
\ No newline at end of file
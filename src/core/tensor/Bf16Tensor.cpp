@@ -0,0 +1,352 @@
+#include "core/tensor/Bf16Tensor.h"
+#include "core/tensor/Tensor.h"
+#include <cstring>
+#include <algorithm>
+
+Bf16Tensor::Bf16Tensor(const vector<size_t> &shape) : shape(shape) {
+    data = vector<uint16_t>(getSize(), 0);
+}
+
+Bf16Tensor::Bf16Tensor() {}
+
+const vector<size_t>& Bf16Tensor::getShape() const {
+    return shape;
+}
+
+size_t Bf16Tensor::getSize() const {
+    if (shape.empty()) {
+        return 0;
+    }
+
+    size_t size = 1;
+    size_t dims = shape.size();
+    for (size_t i = 0; i < dims; i++) {
+        size *= shape[i];
+    }
+    return size;
+}
+
+const uint16_t* Bf16Tensor::getData() const {
+    return data.data();
+}
+
+// Keeps the allocation when shrinking for a smaller batch.
+void Bf16Tensor::reShapeInPlace(const vector<size_t> &newShape) {
+    shape = newShape;
+    if (getSize() > data.size()) {
+        data.resize(getSize());
+    }
+}
+
+// Rounds to nearest even. NaNs stay NaN instead of rounding into infinity.
+uint16_t Bf16Tensor::fromFloat(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(float));
+
+    if ((bits & 0x7FFFFFFFu) > 0x7F800000u) {
+        return (uint16_t) ((bits >> 16) | 0x0040u);
+    }
+
+    bits += 0x7FFFu + ((bits >> 16) & 1u);
+    return (uint16_t) (bits >> 16);
+}
+
+float Bf16Tensor::toFloat(uint16_t value) {
+    uint32_t bits = (uint32_t) value << 16;
+    float result;
+    memcpy(&result, &bits, sizeof(float));
+    return result;
+}
+
+void Bf16Tensor::store(const Tensor &ten) {
+    reShapeInPlace(ten.getShape());
+    size_t size = ten.getSize();
+    const float *tenFlat = ten.getFlat().data();
+    uint16_t *bfFlat = data.data();
+
+    #pragma omp parallel for simd
+    for (size_t i = 0; i < size; i++) {
+        bfFlat[i] = fromFloat(tenFlat[i]);
+    }
+}
+
+void Bf16Tensor::load(Tensor &ten) const {
+    ten.reShapeInPlace(shape);
+    size_t size = getSize();
+    float *tenFlat = ten.getFlat().data();
+    const uint16_t *bfFlat = data.data();
+
+    #pragma omp parallel for simd
+    for (size_t i = 0; i < size; i++) {
+        tenFlat[i] = toFloat(bfFlat[i]);
+    }
+}
+
+// Stores an NHWC input with the zero border of the window, like Tensor::padWindowInput.
+void Bf16Tensor::storePadded(const Tensor &input, const WindowDims &win) {
+    const vector<size_t> &inShape = input.getShape();
+    size_t numSamples = inShape[0];
+    size_t inRows = inShape[1];
+    size_t inCols = inShape[2];
+    size_t depth = inShape[3];
+    size_t newRows = inRows + win.padRows;
+    size_t newCols = inCols + win.padCols;
+
+    reShapeInPlace({numSamples, newRows, newCols, depth});
+    if (win.padRows > 0 || win.padCols > 0) {
+        fill(data.begin(), data.begin() + getSize(), 0);
+    }
+
+    const float *inFlat = input.getFlat().data();
+    uint16_t *padFlat = data.data();
+
+    #pragma omp parallel for collapse(2)
+    for (size_t n = 0; n < numSamples; n++) {
+        for (size_t r = 0; r < inRows; r++) {
+            const float *inRow = inFlat + (n * inRows + r) * inCols * depth;
+            uint16_t *padRow = padFlat + ((n * newRows + r + win.padTop) * newCols + win.padLeft) * depth;
+
+            for (size_t i = 0; i < inCols * depth; i++) {
+                padRow[i] = fromFloat(inRow[i]);
+            }
+        }
+    }
+}
+
+// Stores the gradient dilated by the stride and padded for the full convolution, like
+// Tensor::padAndUpsampleGrad.
+void Bf16Tensor::storeUpsampledGrad(const Tensor &grad, const WindowDims &winGrad, size_t stride) {
+    const vector<size_t> &gradShape = grad.getShape();
+    size_t batchSize = gradShape[0];
+    size_t gradRows = gradShape[1];
+    size_t gradCols = gradShape[2];
+    size_t numKernels = gradShape[3];
+
+    size_t outRows = (stride > 1) ? stride * (gradRows - 1) + 1 : gradRows;
+    size_t outCols = (stride > 1) ? stride * (gradCols - 1) + 1 : gradCols;
+    outRows += winGrad.padRows;
+    outCols += winGrad.padCols;
+
+    reShapeInPlace({batchSize, outRows, outCols, numKernels});
+    fill(data.begin(), data.begin() + getSize(), 0);
+
+    const float *gradFlat = grad.getFlat().data();
+    uint16_t *outFlat = data.data();
+
+    #pragma omp parallel for collapse(2)
+    for (size_t n = 0; n < batchSize; n++) {
+        for (size_t r = 0; r < gradRows; r++) {
+            size_t upRow = r * stride + winGrad.padTop;
+
+            for (size_t c = 0; c < gradCols; c++) {
+                size_t upCol = c * stride + winGrad.padLeft;
+                const float *inPixel = gradFlat + ((n * gradRows + r) * gradCols + c) * numKernels;
+                uint16_t *upPixel = outFlat + ((n * outRows + upRow) * outCols + upCol) * numKernels;
+
+                for (size_t d = 0; d < numKernels; d++) {
+                    upPixel[d] = fromFloat(inPixel[d]);
+                }
+            }
+        }
+    }
+}
+
+// Copies {outDepth, kRows, kCols, inDepth} kernels as {kRows, kCols, inDepth, outDepth}, so
+// every input value meets a contiguous row of weights in the forward pass and every gradient
+// pixel a contiguous row in the input gradient.
+void Bf16Tensor::storeKernels(const Tensor &kernels) {
+    const vector<size_t> &kShape = kernels.getShape();
+    size_t numKernels = kShape[0];
+    size_t windowSize = kShape[1] * kShape[2] * kShape[3];
+
+    reShapeInPlace({kShape[1], kShape[2], kShape[3], numKernels});
+    const float *kFlat = kernels.getFlat().data();
+    uint16_t *bfFlat = data.data();
+
+    #pragma omp parallel for
+    for (size_t w = 0; w < windowSize; w++) {
+        for (size_t k = 0; k < numKernels; k++) {
+            bfFlat[w * numKernels + k] = fromFloat(kFlat[k * windowSize + w]);
+        }
+    }
+}
+
+// Valid convolution of this padded bf16 input with kernels from storeKernels(). Each output
+// pixel accumulates in fp32, one input value times a row of weights at a time.
+void Bf16Tensor::conv2dForward(
+    const Bf16Tensor &kernels,
+    size_t stride,
+    Tensor &output,
+    const Tensor &biases
+) const {
+    const vector<size_t> &kShape = kernels.shape;
+    size_t kRows = kShape[0];
+    size_t kCols = kShape[1];
+    size_t outDepth = kShape[3];
+
+    size_t numSamples = shape[0];
+    size_t inRows = shape[1];
+    size_t inCols = shape[2];
+    size_t inDepth = shape[3];
+
+    const vector<size_t> &outShape = output.getShape();
+    size_t outRows = outShape[1];
+    size_t outCols = outShape[2];
+
+    float *outFlat = output.getFlat().data();
+    const float *biasFlat = biases.getFlat().data();
+    const uint16_t *inFlat = data.data();
+    const uint16_t *kFlat = kernels.data.data();
+
+    #pragma omp parallel for collapse(3)
+    for (size_t n = 0; n < numSamples; n++) {
+        for (size_t r = 0; r < outRows; r++) {
+            for (size_t c = 0; c < outCols; c++) {
+                float *outPixel = outFlat + ((n * outRows + r) * outCols + c) * outDepth;
+                copy(biasFlat, biasFlat + outDepth, outPixel);
+
+                for (size_t i = 0; i < kRows; i++) {
+                    for (size_t j = 0; j < kCols; j++) {
+                        const uint16_t *inPixel = inFlat + ((n * inRows + r * stride + i) * inCols + c * stride + j) * inDepth;
+                        const uint16_t *kWindow = kFlat + (i * kCols + j) * inDepth * outDepth;
+
+                        for (size_t d = 0; d < inDepth; d++) {
+                            float value = toFloat(inPixel[d]);
+                            const uint16_t *kRow = kWindow + d * outDepth;
+
+                            #pragma omp simd
+                            for (size_t o = 0; o < outDepth; o++) {
+                                outPixel[o] += value * toFloat(kRow[o]);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+// Kernel gradients from this padded bf16 input and the fp32 output gradient. Samples are split
+// across threads, each accumulating into its own {kRows, kCols, inDepth, numKernels} buffer so
+// the inner loop runs over a gradient pixel. The buffers are summed, then dW is written in the
+// kernel layout.
+void Bf16Tensor::conv2dWeights(
+    const Tensor &grad,
+    size_t numKernels,
+    size_t kRows,
+    size_t kCols,
+    size_t stride,
+    Tensor &dW
+) const {
+    const vector<size_t> &gradShape = grad.getShape();
+    size_t gradRows = gradShape[1];
+    size_t gradCols = gradShape[2];
+
+    size_t batchSize = shape[0];
+    size_t inRows = shape[1];
+    size_t inCols = shape[2];
+    size_t inDepth = shape[3];
+
+    size_t windowSize = kRows * kCols * inDepth;
+    size_t dwSize = windowSize * numKernels;
+    vector<float> dwWindows(dwSize, 0.0f);
+    const float *gradFlat = grad.getFlat().data();
+    const uint16_t *inFlat = data.data();
+
+    #pragma omp parallel
+    {
+        vector<float> threadWindows(dwSize, 0.0f);
+
+        #pragma omp for
+        for (size_t n = 0; n < batchSize; n++) {
+            for (size_t i = 0; i < kRows; i++) {
+                for (size_t j = 0; j < kCols; j++) {
+                    float *dwWindow = threadWindows.data() + (i * kCols + j) * inDepth * numKernels;
+
+                    for (size_t r = 0; r < gradRows; r++) {
+                        for (size_t c = 0; c < gradCols; c++) {
+                            const float *gradPixel = gradFlat + ((n * gradRows + r) * gradCols + c) * numKernels;
+                            const uint16_t *inPixel = inFlat + ((n * inRows + r * stride + i) * inCols + c * stride + j) * inDepth;
+
+                            for (size_t d = 0; d < inDepth; d++) {
+                                float value = toFloat(inPixel[d]);
+                                float *dwRow = dwWindow + d * numKernels;
+
+                                #pragma omp simd
+                                for (size_t k = 0; k < numKernels; k++) {
+                                    dwRow[k] += value * gradPixel[k];
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        #pragma omp critical
+        {
+            for (size_t w = 0; w < dwSize; w++) {
+                dwWindows[w] += threadWindows[w];
+            }
+        }
+    }
+
+    float *dwFlat = dW.getFlat().data();
+
+    #pragma omp parallel for
+    for (size_t k = 0; k < numKernels; k++) {
+        for (size_t w = 0; w < windowSize; w++) {
+            dwFlat[k * windowSize + w] = dwWindows[w * numKernels + k];
+        }
+    }
+}
+
+// Input gradients from this upsampled bf16 gradient and kernels from storeKernels(), rotated
+// by 180 degrees. Each value is a dot product over the kernels of a gradient pixel.
+void Bf16Tensor::conv2dInput(const Bf16Tensor &kernels, Tensor &dX) const {
+    const vector<size_t> &kShape = kernels.shape;
+    size_t kRows = kShape[0];
+    size_t kCols = kShape[1];
+    size_t inDepth = kShape[2];
+    size_t numKernels = kShape[3];
+
+    size_t numSamples = shape[0];
+    size_t gradRows = shape[1];
+    size_t gradCols = shape[2];
+
+    const vector<size_t> &dxShape = dX.getShape();
+    size_t dxRows = dxShape[1];
+    size_t dxCols = dxShape[2];
+
+    const uint16_t *gradFlat = data.data();
+    const uint16_t *kFlat = kernels.data.data();
+    float *dxFlat = dX.getFlat().data();
+
+    #pragma omp parallel for collapse(3)
+    for (size_t n = 0; n < numSamples; n++) {
+        for (size_t r = 0; r < dxRows; r++) {
+            for (size_t c = 0; c < dxCols; c++) {
+                float *dxPixel = dxFlat + ((n * dxRows + r) * dxCols + c) * inDepth;
+
+                for (size_t d = 0; d < inDepth; d++) {
+                    float value = 0.0f;
+
+                    for (size_t i = 0; i < kRows; i++) {
+                        for (size_t j = 0; j < kCols; j++) {
+                            const uint16_t *gradPixel = gradFlat + ((n * gradRows + r + i) * gradCols + c + j) * numKernels;
+                            size_t flipWindow = (kRows - 1 - i) * kCols + (kCols - 1 - j);
+                            const uint16_t *kRow = kFlat + (flipWindow * inDepth + d) * numKernels;
+
+                            #pragma omp simd reduction(+:value)
+                            for (size_t k = 0; k < numKernels; k++) {
+                                value += toFloat(kRow[k]) * toFloat(gradPixel[k]);
+                            }
+                        }
+                    }
+
+                    dxPixel[d] = value;
+                }
+            }
+        }
+    }
+}
\ No newline at end of file
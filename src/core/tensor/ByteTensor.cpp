@@ -0,0 +1,138 @@
+#include "core/tensor/ByteTensor.h"
+#include "utils/MappedFile.h"
+#include "utils/ConsoleUtils.h"
+
+ByteTensor::ByteTensor(const vector<size_t> &shape, float scale, float shift) : 
+    shape(shape), segmentSamples(0), scale(scale), shift(shift) {
+    size_t size = 1;
+    size_t dims = shape.size();
+    for (size_t i = 0; i < dims; i++) {
+        size *= shape[i];
+    }
+
+    data = vector<uint8_t>(dims > 0 ? size : 0, 0);
+}
+
+ByteTensor::ByteTensor() : segmentSamples(0), scale(1.0f), shift(0.0f) {}
+
+ByteTensor ByteTensor::view(
+    const vector<size_t> &shape,
+    size_t segmentSamples,
+    float scale,
+    float shift
+) {
+    ByteTensor tensor;
+    tensor.shape = shape;
+    tensor.segmentSamples = segmentSamples;
+    tensor.scale = scale;
+    tensor.shift = shift;
+    return tensor;
+}
+
+void ByteTensor::addSegment(shared_ptr<const MappedFile> mapping, const uint8_t *segment) {
+    mappings.push_back(mapping);
+    segments.push_back(segment);
+}
+
+const vector<size_t>& ByteTensor::getShape() const {
+    return shape;
+}
+
+size_t ByteTensor::getSize() const {
+    if (shape.empty()) {
+        return 0;
+    }
+
+    size_t size = 1;
+    size_t dims = shape.size();
+    for (size_t i = 0; i < dims; i++) {
+        size *= shape[i];
+    }
+    return size;
+}
+
+size_t ByteTensor::getSampleSize() const {
+    if (shape.empty() || shape[0] == 0) {
+        return 0;
+    }
+
+    return getSize() / shape[0];
+}
+
+bool ByteTensor::isView() const {
+    return !segments.empty();
+}
+
+const uint8_t* ByteTensor::getData() const {
+    if (isView()) {
+        if (segments.size() != 1) {
+            ConsoleUtils::fatalError("Sharded byte tensor has no contiguous data.");
+        }
+        return segments[0];
+    }
+
+    return data.data();
+}
+
+uint8_t* ByteTensor::getData() {
+    if (isView()) {
+        ConsoleUtils::fatalError("Cannot write to a memory-mapped byte tensor.");
+    }
+
+    return data.data();
+}
+
+const uint8_t* ByteTensor::getSample(size_t idx) const {
+    size_t sampleSize = getSampleSize();
+    if (!isView()) {
+        return data.data() + idx * sampleSize;
+    }
+
+    return segments[idx / segmentSamples] + (idx % segmentSamples) * sampleSize;
+}
+
+float ByteTensor::getScale() const {
+    return scale;
+}
+
+float ByteTensor::getShift() const {
+    return shift;
+}
+
+void ByteTensor::setScaling(float newScale, float newShift) {
+    scale = newScale;
+    shift = newShift;
+}
+
+void ByteTensor::setMinmaxScaling() {
+    size_t numSamples = shape.empty() ? 0 : shape[0];
+    size_t sampleSize = getSampleSize();
+    uint8_t minVal = 255;
+    uint8_t maxVal = 0;
+
+    #pragma omp parallel for reduction(min:minVal) reduction(max:maxVal)
+    for (size_t n = 0; n < numSamples; n++) {
+        const uint8_t *sample = getSample(n);
+        for (size_t i = 0; i < sampleSize; i++) {
+            uint8_t val = sample[i];
+            if (val < minVal) minVal = val;
+            if (val > maxVal) maxVal = val;
+        }
+    }
+
+    float range = (float) maxVal - (float) minVal;
+    if (range == 0.0f) {
+        range = 1.0f;
+    }
+
+    scale = 1.0f / range;
+    shift = -((float) minVal) / range;
+}
+
+void ByteTensor::clear() {
+    vector<size_t>().swap(shape);
+    vector<uint8_t>().swap(data);
+    vector<shared_ptr<const MappedFile> >().swap(mappings);
+    vector<const uint8_t*>().swap(segments);
+    segmentSamples = 0;
+}
\ No newline at end of file
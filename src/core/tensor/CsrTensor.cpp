@@ -0,0 +1,210 @@
+#include "core/tensor/CsrTensor.h"
+#include "core/tensor/Tensor.h"
+#include "utils/ConsoleUtils.h"
+#include <algorithm>
+#include <cstring>
+
+CsrTensor::CsrTensor(size_t numRows, size_t numCols) : 
+    shape({numRows, numCols}), rowPtr(numRows + 1, 0) {}
+
+CsrTensor::CsrTensor() : rowPtr(1, 0) {}
+
+const vector<size_t>& CsrTensor::getShape() const {
+    return shape;
+}
+
+size_t CsrTensor::getNumRows() const {
+    if (shape.empty()) {
+        return 0;
+    }
+
+    return shape[0];
+}
+
+size_t CsrTensor::getNumCols() const {
+    if (shape.empty()) {
+        return 0;
+    }
+
+    return shape[1];
+}
+
+size_t CsrTensor::getNnz() const {
+    return values.size();
+}
+
+vector<size_t>& CsrTensor::getRowPtr() {
+    return rowPtr;
+}
+
+vector<uint32_t>& CsrTensor::getColIdx() {
+    return colIdx;
+}
+
+vector<float>& CsrTensor::getValues() {
+    return values;
+}
+
+const vector<size_t>& CsrTensor::getRowPtr() const {
+    return rowPtr;
+}
+
+const vector<uint32_t>& CsrTensor::getColIdx() const {
+    return colIdx;
+}
+
+const vector<float>& CsrTensor::getValues() const {
+    return values;
+}
+
+CsrTensor CsrTensor::gatherRows(const size_t *rows, size_t count) const {
+    CsrTensor output(count, getNumCols());
+    vector<size_t> &outPtr = output.rowPtr;
+
+    for (size_t i = 0; i < count; i++) {
+        size_t row = rows[i];
+        outPtr[i + 1] = outPtr[i] + (rowPtr[row + 1] - rowPtr[row]);
+    }
+
+    output.colIdx.resize(outPtr[count]);
+    output.values.resize(outPtr[count]);
+
+    #pragma omp parallel for
+    for (size_t i = 0; i < count; i++) {
+        size_t start = rowPtr[rows[i]];
+        size_t rowNnz = outPtr[i + 1] - outPtr[i];
+        memcpy(output.colIdx.data() + outPtr[i], colIdx.data() + start, rowNnz * sizeof(uint32_t));
+        memcpy(output.values.data() + outPtr[i], values.data() + start, rowNnz * sizeof(float));
+    }
+
+    return output;
+}
+
+void CsrTensor::densifyRow(size_t row, float *dst) const {
+    memset(dst, 0, getNumCols() * sizeof(float));
+    for (size_t k = rowPtr[row]; k < rowPtr[row + 1]; k++) {
+        dst[colIdx[k]] = values[k];
+    }
+}
+
+Tensor CsrTensor::toDense() const {
+    size_t numRows = getNumRows();
+    size_t numCols = getNumCols();
+    Tensor output({numRows, numCols});
+    float *outFlat = output.getFlat().data();
+
+    #pragma omp parallel for
+    for (size_t i = 0; i < numRows; i++) {
+        densifyRow(i, outFlat + i * numCols);
+    }
+
+    return output;
+}
+
+void CsrTensor::mmT(const Tensor &weights, Tensor &output) const {
+    const vector<size_t> &weightShape = weights.getShape();
+    size_t numOutputs = weightShape[0];
+    size_t numCols = weightShape[1];
+
+    if (numCols != getNumCols()) {
+        ConsoleUtils::fatalError(
+            "Sparse mmT error: input has " + to_string(getNumCols()) +
+            " columns but weights expect " + to_string(numCols) + "."
+        );
+    }
+
+    size_t numRows = getNumRows();
+    const float *weightsFlat = weights.getFlat().data();
+    float *outFlat = output.getFlat().data();
+
+    #pragma omp parallel for
+    for (size_t i = 0; i < numRows; i++) {
+        size_t rowStart = rowPtr[i];
+        size_t rowEnd = rowPtr[i + 1];
+        float *outRow = outFlat + i * numOutputs;
+
+        for (size_t n = 0; n < numOutputs; n++) {
+            const float *weightRow = weightsFlat + n * numCols;
+            float sum = 0.0f;
+            for (size_t k = rowStart; k < rowEnd; k++) {
+                sum += values[k] * weightRow[colIdx[k]];
+            }
+            outRow[n] = sum;
+        }
+    }
+}
+
+// Applies weights += scaleFactor * (grad^T * this + 2 * l2 * weights) without forming
+// a dense dW. L2 decay is applied lazily to the columns present in the batch.
+void CsrTensor::applyWeightGrad(
+    const Tensor &grad, 
+    float scaleFactor, 
+    float l2, 
+    Tensor &weights
+) const {
+    size_t numRows = getNumRows();
+    size_t numOutputs = weights.getShape()[0];
+    size_t numCols = weights.getShape()[1];
+    const float *gradFlat = grad.getFlat().data();
+    float *weightsFlat = weights.getFlat().data();
+
+    vector<uint32_t> activeCols;
+    if (l2 > 0.0f) {
+        activeCols = colIdx;
+        sort(activeCols.begin(), activeCols.end());
+        activeCols.erase(unique(activeCols.begin(), activeCols.end()), activeCols.end());
+    }
+
+    size_t numActive = activeCols.size();
+    float decay = scaleFactor * 2 * l2;
+
+    #pragma omp parallel for
+    for (size_t n = 0; n < numOutputs; n++) {
+        float *weightRow = weightsFlat + n * numCols;
+
+        for (size_t j = 0; j < numActive; j++) {
+            weightRow[activeCols[j]] += decay * weightRow[activeCols[j]];
+        }
+
+        for (size_t i = 0; i < numRows; i++) {
+            float g = scaleFactor * gradFlat[i * numOutputs + n];
+            if (g == 0.0f)
+                continue;
+
+            for (size_t k = rowPtr[i]; k < rowPtr[i + 1]; k++) {
+                weightRow[colIdx[k]] += g * values[k];
+            }
+        }
+    }
+}
+
+void CsrTensor::reserve(size_t numRows, size_t nnz) {
+    rowPtr.reserve(numRows + 1);
+    colIdx.reserve(nnz);
+    values.reserve(nnz);
+}
+
+// Row building keeps the reserved capacity, so refilling a workspace does not allocate.
+void CsrTensor::clearRows() {
+    rowPtr.resize(1);
+    colIdx.clear();
+    values.clear();
+    shape[0] = 0;
+}
+
+void CsrTensor::appendEntry(uint32_t col, float value) {
+    colIdx.push_back(col);
+    values.push_back(value);
+}
+
+void CsrTensor::finishRow() {
+    rowPtr.push_back(values.size());
+    shape[0]++;
+}
+
+void CsrTensor::clear() {
+    vector<size_t>().swap(shape);
+    vector<size_t>(1, 0).swap(rowPtr);
+    vector<uint32_t>().swap(colIdx);
+    vector<float>().swap(values);
+}
\ No newline at end of file
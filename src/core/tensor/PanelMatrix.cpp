@@ -0,0 +1,680 @@
+#include "core/tensor/PanelMatrix.h"
+#include "core/tensor/Tensor.h"
+#include "core/tensor/CsrTensor.h"
+#include "core/tensor/Bf16Tensor.h"
+#include "utils/ConsoleUtils.h"
+#include "utils/BinUtils.h"
+#include "utils/MappedFile.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+const size_t PanelMatrix::PANEL_ROWS = 16;
+const size_t PanelMatrix::BLOCK_COLS = 2048;
+const size_t PanelMatrix::ROW_BLOCK = 4;
+const uint32_t PanelMatrix::ROW_MAJOR_LAYOUT = 0;
+const uint32_t PanelMatrix::PANEL_LAYOUT = 1;
+const uint32_t PanelMatrix::ENCODED_LAYOUT = 2;
+const size_t PanelMatrix::QUANT_BLOCK = 64;
+const float PanelMatrix::MAX_LEVEL = 127.0f;
+
+size_t PanelMatrix::numThreads = 1;
+
+PanelMatrix::PanelMatrix() :
+    numRows(0), numCols(0), numPanels(0), data(nullptr),
+    format(BinUtils::FP32), encodedData(nullptr) {}
+
+PanelMatrix::PanelMatrix(const PanelMatrix &other) : data(nullptr), encodedData(nullptr) {
+    *this = other;
+}
+
+// Mapped panels stay shared with the source; owned panels are copied and re-pointed.
+PanelMatrix& PanelMatrix::operator=(const PanelMatrix &other) {
+    if (this == &other)
+        return *this;
+
+    numRows = other.numRows;
+    numCols = other.numCols;
+    numPanels = other.numPanels;
+    panels = other.panels;
+    mapping = other.mapping;
+    data = (mapping != nullptr) ? other.data : (panels.empty() ? nullptr : panels.data());
+    format = other.format;
+    encoded = other.encoded;
+    encodedData = (mapping != nullptr) ? other.encodedData : (encoded.empty() ? nullptr : encoded.data());
+    return *this;
+}
+
+// Packs the tensor as a {shape[0], remaining dims} matrix. Panel p holds rows
+// [p * PANEL_ROWS, (p + 1) * PANEL_ROWS) stored column by column; rows past the end are zero.
+void PanelMatrix::pack(const Tensor &mat) {
+    const vector<size_t> &shape = mat.getShape();
+    if (shape.size() < 2 || shape[0] == 0) {
+        ConsoleUtils::fatalError("Only non-empty tensors with at least 2 dimensions can be packed.");
+    }
+
+    numRows = shape[0];
+    numCols = mat.getSize() / numRows;
+    numPanels = (numRows + PANEL_ROWS - 1) / PANEL_ROWS;
+    mapping.reset();
+    panels.assign(getPanelSize(), 0.0f);
+    data = panels.data();
+    format = BinUtils::FP32;
+    vector<int8_t>().swap(encoded);
+    encodedData = nullptr;
+
+    const vector<float> &matFlat = mat.getFlat();
+
+    #pragma omp parallel for
+    for (size_t p = 0; p < numPanels; p++) {
+        float *panel = panels.data() + p * numCols * PANEL_ROWS;
+        size_t panelRows = min(PANEL_ROWS, numRows - p * PANEL_ROWS);
+
+        for (size_t j = 0; j < panelRows; j++) {
+            const float *row = matFlat.data() + (p * PANEL_ROWS + j) * numCols;
+            for (size_t k = 0; k < numCols; k++) {
+                panel[k * PANEL_ROWS + j] = row[k];
+            }
+        }
+    }
+}
+
+// Writes the panels back into a row-major tensor of any shape holding numRows * numCols values.
+void PanelMatrix::unpack(Tensor &mat) const {
+    if (mat.getSize() != numRows * numCols) {
+        ConsoleUtils::fatalError("Cannot unpack panels into a tensor of a different size.");
+    }
+
+    vector<float> &matFlat = mat.getFlat();
+    vector<float> decoded;
+    const float *source = getPanels(decoded);
+
+    #pragma omp parallel for
+    for (size_t p = 0; p < numPanels; p++) {
+        const float *panel = source + p * numCols * PANEL_ROWS;
+        size_t panelRows = min(PANEL_ROWS, numRows - p * PANEL_ROWS);
+
+        for (size_t j = 0; j < panelRows; j++) {
+            float *row = matFlat.data() + (p * PANEL_ROWS + j) * numCols;
+            for (size_t k = 0; k < numCols; k++) {
+                row[k] = panel[k * PANEL_ROWS + j];
+            }
+        }
+    }
+}
+
+void PanelMatrix::clear() {
+    numRows = 0;
+    numCols = 0;
+    numPanels = 0;
+    panels.clear();
+    panels.shrink_to_fit();
+    mapping.reset();
+    data = nullptr;
+    format = BinUtils::FP32;
+    vector<int8_t>().swap(encoded);
+    encodedData = nullptr;
+}
+
+// Expands encoded panels into owned fp32 panels and releases the encoded ones. Layers call this
+// when they first run inference, so a loaded model only widens the layers it uses.
+void PanelMatrix::widen() {
+    if (encodedData == nullptr)
+        return;
+
+    panels.resize(getPanelSize());
+    decode(encodedData, panels.size(), format, panels.data());
+    data = panels.data();
+
+    format = BinUtils::FP32;
+    vector<int8_t>().swap(encoded);
+    encodedData = nullptr;
+    mapping.reset();
+}
+
+bool PanelMatrix::isEmpty() const {
+    return data == nullptr && encodedData == nullptr;
+}
+
+bool PanelMatrix::isMapped() const {
+    return mapping != nullptr;
+}
+
+bool PanelMatrix::isEncoded() const {
+    return encodedData != nullptr;
+}
+
+size_t PanelMatrix::getPanelSize() const {
+    return numPanels * numCols * PANEL_ROWS;
+}
+
+// Encoded panels are decoded into the given storage, fp32 panels are returned as they are.
+const float* PanelMatrix::getPanels(vector<float> &decoded) const {
+    if (encodedData == nullptr)
+        return data;
+
+    decoded.resize(getPanelSize());
+    decode(encodedData, decoded.size(), format, decoded.data());
+    return decoded.data();
+}
+
+// The kernels read fp32 panels only, encoded panels must be widened first.
+void PanelMatrix::checkWidened() const {
+    if (data == nullptr) {
+        ConsoleUtils::fatalError(
+            isEncoded() ? 
+            "Encoded weight panels must be widened before running inference." :
+            "Weight panels must be packed before running inference."
+        );
+    }
+}
+
+size_t PanelMatrix::getNumRows() const {
+    return numRows;
+}
+
+size_t PanelMatrix::getNumCols() const {
+    return numCols;
+}
+
+void PanelMatrix::writeDims(ofstream &modelBin) const {
+    uint32_t panelRowsWrite = (uint32_t) PANEL_ROWS;
+    uint32_t numRowsWrite = (uint32_t) numRows;
+    uint32_t numColsWrite = (uint32_t) numCols;
+
+    modelBin.write((char*) &panelRowsWrite, sizeof(uint32_t));
+    modelBin.write((char*) &numRowsWrite, sizeof(uint32_t));
+    modelBin.write((char*) &numColsWrite, sizeof(uint32_t));
+}
+
+void PanelMatrix::readDims(ifstream &modelBin) {
+    uint32_t panelRowsRead;
+    uint32_t numRowsRead;
+    uint32_t numColsRead;
+
+    modelBin.read((char*) &panelRowsRead, sizeof(uint32_t));
+    modelBin.read((char*) &numRowsRead, sizeof(uint32_t));
+    modelBin.read((char*) &numColsRead, sizeof(uint32_t));
+
+    if (panelRowsRead != PANEL_ROWS || numRowsRead == 0) {
+        ConsoleUtils::fatalError(
+            "Packed weights use " + to_string(panelRowsRead) + "-row panels, but this build "
+            "expects " + to_string(PANEL_ROWS) + "."
+        );
+    }
+
+    numRows = numRowsRead;
+    numCols = numColsRead;
+    numPanels = (numRows + PANEL_ROWS - 1) / PANEL_ROWS;
+}
+
+void PanelMatrix::writeBin(ofstream &modelBin) const {
+    writeDims(modelBin);
+    vector<float> decoded;
+    BinUtils::writeFloats(modelBin, getPanels(decoded), getPanelSize());
+}
+
+void PanelMatrix::loadFromBin(ifstream &modelBin) {
+    clear();
+    readDims(modelBin);
+    data = BinUtils::readFloats(modelBin, panels, getPanelSize(), mapping);
+}
+
+void PanelMatrix::writeEncoded(ofstream &modelBin, uint32_t encoding) const {
+    modelBin.write((char*) &encoding, sizeof(uint32_t));
+    writeDims(modelBin);
+
+    vector<float> decoded;
+    vector<int8_t> bytes(getEncodedSize(getPanelSize(), encoding));
+    encode(getPanels(decoded), getPanelSize(), encoding, bytes.data());
+    BinUtils::writeBytes(modelBin, bytes.data(), bytes.size());
+}
+
+// Encoded panels stay a view into the mapped file until widen().
+void PanelMatrix::loadEncoded(ifstream &modelBin) {
+    uint32_t encoding;
+    modelBin.read((char*) &encoding, sizeof(uint32_t));
+    if (encoding != BinUtils::FP16 && encoding != BinUtils::BF16 && encoding != BinUtils::INT8) {
+        ConsoleUtils::fatalError("Unsupported weight format \"" + to_string(encoding) + "\".");
+    }
+
+    clear();
+    readDims(modelBin);
+    format = encoding;
+    encodedData = BinUtils::readBytes(
+        modelBin, encoded, getEncodedSize(getPanelSize(), format), mapping
+    );
+}
+
+void PanelMatrix::writePanels(ofstream &modelBin, uint32_t weightFormat) const {
+    if (weightFormat == BinUtils::FP32) {
+        writeBin(modelBin);
+    } else {
+        writeEncoded(modelBin, weightFormat);
+    }
+}
+
+// Inside a model container the weights are stored as panels, so loading can map them straight
+// into the inference kernels, and encoded if the save asked for a compressed weight format.
+// Everywhere else they stay row-major. rowMajor may be empty when the weights only exist as
+// these panels.
+void PanelMatrix::writeWeights(ofstream &modelBin, const Tensor &rowMajor) const {
+    bool isPanels = BinUtils::isWritingContainer();
+    uint32_t weightFormat = BinUtils::getWeightFormat();
+    uint32_t layout = ROW_MAJOR_LAYOUT;
+    if (weightFormat != BinUtils::FP32) {
+        layout = ENCODED_LAYOUT;
+    } else if (isPanels) {
+        layout = PANEL_LAYOUT;
+    }
+    modelBin.write((char*) &layout, sizeof(uint32_t));
+
+    if (!isPanels && rowMajor.getSize() == 0) {
+        Tensor unpacked({numRows, numCols});
+        unpack(unpacked);
+        BinUtils::writeFloats(modelBin, unpacked.getFlat().data(), unpacked.getSize());
+    } else if (!isPanels) {
+        BinUtils::writeFloats(modelBin, rowMajor.getFlat().data(), rowMajor.getSize());
+    } else if (rowMajor.getSize() != 0) {
+        PanelMatrix packed;
+        packed.pack(rowMajor);
+        packed.writePanels(modelBin, weightFormat);
+    } else {
+        writePanels(modelBin, weightFormat);
+    }
+}
+
+// Row-major weights are read into rowMajor with the given shape and these panels are cleared.
+// Stored panels are loaded here instead and rowMajor is left empty.
+void PanelMatrix::loadWeights(ifstream &modelBin, const vector<size_t> &shape, Tensor &rowMajor) {
+    uint32_t layout = ROW_MAJOR_LAYOUT;
+    if (BinUtils::getReadRevision() >= 5) {
+        modelBin.read((char*) &layout, sizeof(uint32_t));
+    }
+
+    if (layout == ROW_MAJOR_LAYOUT) {
+        clear();
+        rowMajor = Tensor(shape);
+        BinUtils::readFloats(modelBin, rowMajor.getFlat().data(), rowMajor.getSize());
+        return;
+    }
+
+    if (layout == PANEL_LAYOUT) {
+        loadFromBin(modelBin);
+    } else if (layout == ENCODED_LAYOUT) {
+        loadEncoded(modelBin);
+    } else {
+        ConsoleUtils::fatalError("Unsupported weight layout \"" + to_string(layout) + "\".");
+    }
+    rowMajor = Tensor();
+
+    size_t size = 1;
+    for (size_t dim : shape) {
+        size *= dim;
+    }
+
+    if (shape.empty() || numRows != shape[0] || numRows * numCols != size) {
+        ConsoleUtils::fatalError("Packed weights do not match the layer shape.");
+    }
+}
+
+// y = Mx (+ bias if not null). Columns are processed in blocks of BLOCK_COLS so the slice of x
+// stays in L1 while every panel streams past it. Runs serially unless setNumThreads() was raised.
+void PanelMatrix::gemv(const float *x, const float *bias, float *y) const {
+    checkWidened();
+
+    #pragma omp parallel num_threads(numThreads) if(numThreads > 1)
+    for (size_t kStart = 0; kStart < numCols; kStart += BLOCK_COLS) {
+        size_t kEnd = min(kStart + BLOCK_COLS, numCols);
+
+        #pragma omp for
+        for (size_t p = 0; p < numPanels; p++) {
+            size_t rowStart = p * PANEL_ROWS;
+            size_t panelRows = min(PANEL_ROWS, numRows - rowStart);
+            const float *panel = data + p * numCols * PANEL_ROWS;
+
+            float acc[PANEL_ROWS];
+            for (size_t j = 0; j < PANEL_ROWS; j++) {
+                if (j >= panelRows) {
+                    acc[j] = 0.0f;
+                } else if (kStart > 0) {
+                    acc[j] = y[rowStart + j];
+                } else {
+                    acc[j] = (bias != nullptr) ? bias[rowStart + j] : 0.0f;
+                }
+            }
+
+            for (size_t k = kStart; k < kEnd; k++) {
+                float xk = x[k];
+                const float *w = panel + k * PANEL_ROWS;
+
+                #pragma omp simd
+                for (size_t j = 0; j < PANEL_ROWS; j++) {
+                    acc[j] += w[j] * xk;
+                }
+            }
+
+            for (size_t j = 0; j < panelRows; j++) {
+                y[rowStart + j] = acc[j];
+            }
+        }
+    }
+}
+
+// y = xM^T (+ bias) for a {batchSize, numCols} x. Each task multiplies ROW_BLOCK rows of x by one
+// panel, holding a ROW_BLOCK x PANEL_ROWS tile of y in registers.
+void PanelMatrix::gemm(const float *x, size_t batchSize, const float *bias, float *y) const {
+    checkWidened();
+    size_t numRowBlocks = (batchSize + ROW_BLOCK - 1) / ROW_BLOCK;
+
+    #pragma omp parallel for collapse(2)
+    for (size_t b = 0; b < numRowBlocks; b++) {
+        for (size_t p = 0; p < numPanels; p++) {
+            size_t xStart = b * ROW_BLOCK;
+            size_t blockRows = min(ROW_BLOCK, batchSize - xStart);
+            size_t rowStart = p * PANEL_ROWS;
+            size_t panelRows = min(PANEL_ROWS, numRows - rowStart);
+            const float *panel = data + p * numCols * PANEL_ROWS;
+
+            // Tail blocks repeat the last row of x and discard the result.
+            const float *xRows[ROW_BLOCK];
+            for (size_t r = 0; r < ROW_BLOCK; r++) {
+                xRows[r] = x + (xStart + min(r, blockRows - 1)) * numCols;
+            }
+
+            float acc[ROW_BLOCK][PANEL_ROWS];
+            for (size_t r = 0; r < ROW_BLOCK; r++) {
+                for (size_t j = 0; j < PANEL_ROWS; j++) {
+                    acc[r][j] = (bias != nullptr && j < panelRows) ? bias[rowStart + j] : 0.0f;
+                }
+            }
+
+            for (size_t k = 0; k < numCols; k++) {
+                const float *w = panel + k * PANEL_ROWS;
+                for (size_t r = 0; r < ROW_BLOCK; r++) {
+                    float xk = xRows[r][k];
+
+                    #pragma omp simd
+                    for (size_t j = 0; j < PANEL_ROWS; j++) {
+                        acc[r][j] += w[j] * xk;
+                    }
+                }
+            }
+
+            for (size_t r = 0; r < blockRows; r++) {
+                float *yRow = y + (xStart + r) * numRows + rowStart;
+                for (size_t j = 0; j < panelRows; j++) {
+                    yRow[j] = acc[r][j];
+                }
+            }
+        }
+    }
+}
+
+// y = xM^T (+ bias) for a sparse {batchSize, numCols} x. Each stored entry scales one row of
+// PANEL_ROWS weights, so a panel is touched only at the columns present in the row.
+void PanelMatrix::sparseGemm(const CsrTensor &x, const float *bias, float *y) const {
+    checkWidened();
+    if (x.getNumCols() != numCols) {
+        ConsoleUtils::fatalError(
+            "Sparse GEMM error: input has " + to_string(x.getNumCols()) +
+            " columns but weights expect " + to_string(numCols) + "."
+        );
+    }
+
+    size_t batchSize = x.getNumRows();
+    const vector<size_t> &rowPtr = x.getRowPtr();
+    const vector<uint32_t> &colIdx = x.getColIdx();
+    const vector<float> &values = x.getValues();
+
+    #pragma omp parallel for collapse(2)
+    for (size_t i = 0; i < batchSize; i++) {
+        for (size_t p = 0; p < numPanels; p++) {
+            size_t rowStart = p * PANEL_ROWS;
+            size_t panelRows = min(PANEL_ROWS, numRows - rowStart);
+            const float *panel = data + p * numCols * PANEL_ROWS;
+
+            float acc[PANEL_ROWS];
+            for (size_t j = 0; j < PANEL_ROWS; j++) {
+                acc[j] = (bias != nullptr && j < panelRows) ? bias[rowStart + j] : 0.0f;
+            }
+
+            for (size_t k = rowPtr[i]; k < rowPtr[i + 1]; k++) {
+                float xk = values[k];
+                const float *w = panel + colIdx[k] * PANEL_ROWS;
+
+                #pragma omp simd
+                for (size_t j = 0; j < PANEL_ROWS; j++) {
+                    acc[j] += w[j] * xk;
+                }
+            }
+
+            float *yRow = y + i * numRows + rowStart;
+            for (size_t j = 0; j < panelRows; j++) {
+                yRow[j] = acc[j];
+            }
+        }
+    }
+}
+
+// Valid convolution of an already padded NHWC input with kernels packed from {outDepth, kRows,
+// kCols, inDepth}. Each task computes ROW_BLOCK neighbouring output pixels for one panel of
+// output channels, reading the input patches in place instead of building im2col rows.
+void PanelMatrix::conv2d(
+    const Tensor &input,
+    size_t kRows,
+    size_t kCols,
+    size_t stride,
+    const float *bias,
+    Tensor &output
+) const {
+    const vector<size_t> &inShape = input.getShape();
+    const vector<size_t> &outShape = output.getShape();
+    size_t numSamples = inShape[0];
+    size_t inRows = inShape[1];
+    size_t inCols = inShape[2];
+    size_t inDepth = inShape[3];
+    size_t outRows = outShape[1];
+    size_t outCols = outShape[2];
+
+    checkWidened();
+    if (numCols != kRows * kCols * inDepth || outShape[3] != numRows) {
+        ConsoleUtils::fatalError("Packed kernels do not match the convolution shapes.");
+    }
+
+    const float *inFlat = input.getFlat().data();
+    float *outFlat = output.getFlat().data();
+    size_t numColBlocks = (outCols + ROW_BLOCK - 1) / ROW_BLOCK;
+
+    #pragma omp parallel for collapse(4)
+    for (size_t n = 0; n < numSamples; n++) {
+        for (size_t r = 0; r < outRows; r++) {
+            for (size_t cb = 0; cb < numColBlocks; cb++) {
+                for (size_t p = 0; p < numPanels; p++) {
+                    size_t colStart = cb * ROW_BLOCK;
+                    size_t blockCols = min(ROW_BLOCK, outCols - colStart);
+                    size_t rowStart = p * PANEL_ROWS;
+                    size_t panelRows = min(PANEL_ROWS, numRows - rowStart);
+                    const float *panel = data + p * numCols * PANEL_ROWS;
+
+                    const float *patches[ROW_BLOCK];
+                    for (size_t q = 0; q < ROW_BLOCK; q++) {
+                        size_t c = colStart + min(q, blockCols - 1);
+                        patches[q] = inFlat + ((n * inRows + r * stride) * inCols + c * stride) * inDepth;
+                    }
+
+                    float acc[ROW_BLOCK][PANEL_ROWS];
+                    for (size_t q = 0; q < ROW_BLOCK; q++) {
+                        for (size_t j = 0; j < PANEL_ROWS; j++) {
+                            acc[q][j] = (bias != nullptr && j < panelRows) ? bias[rowStart + j] : 0.0f;
+                        }
+                    }
+
+                    for (size_t i = 0; i < kRows; i++) {
+                        for (size_t j = 0; j < kCols; j++) {
+                            size_t inOffset = (i * inCols + j) * inDepth;
+                            const float *w = panel + (i * kCols + j) * inDepth * PANEL_ROWS;
+
+                            for (size_t d = 0; d < inDepth; d++) {
+                                for (size_t q = 0; q < ROW_BLOCK; q++) {
+                                    float xd = patches[q][inOffset + d];
+
+                                    #pragma omp simd
+                                    for (size_t o = 0; o < PANEL_ROWS; o++) {
+                                        acc[q][o] += w[d * PANEL_ROWS + o] * xd;
+                                    }
+                                }
+                            }
+                        }
+                    }
+
+                    for (size_t q = 0; q < blockCols; q++) {
+                        float *outPixel = outFlat + ((n * outRows + r) * outCols + colStart + q) * numRows;
+                        for (size_t o = 0; o < panelRows; o++) {
+                            outPixel[rowStart + o] = acc[q][o];
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+// Threads used by gemv(). Pin them with OMP_PROC_BIND / OMP_PLACES.
+void PanelMatrix::setNumThreads(size_t threads) {
+    if (threads == 0) {
+        ConsoleUtils::fatalError("GEMV thread count must be at least 1.");
+    }
+
+    numThreads = threads;
+}
+
+size_t PanelMatrix::getNumThreads() {
+    return numThreads;
+}
+
+// fp16 and bf16 take two bytes per weight. INT8 stores each block of QUANT_BLOCK weights as its
+// fp32 scale followed by one byte per weight.
+size_t PanelMatrix::getEncodedSize(size_t count, uint32_t encoding) {
+    if (encoding == BinUtils::INT8) {
+        size_t numBlocks = (count + QUANT_BLOCK - 1) / QUANT_BLOCK;
+        return numBlocks * sizeof(float) + count;
+    }
+
+    return count * sizeof(uint16_t);
+}
+
+void PanelMatrix::encode(const float *values, size_t count, uint32_t encoding, int8_t *out) {
+    if (encoding != BinUtils::INT8) {
+        uint16_t *halves = (uint16_t*) out;
+        bool isHalf = encoding == BinUtils::FP16;
+
+        #pragma omp parallel for
+        for (size_t i = 0; i < count; i++) {
+            halves[i] = isHalf ? halfFromFloat(values[i]) : Bf16Tensor::fromFloat(values[i]);
+        }
+        return;
+    }
+
+    size_t numBlocks = (count + QUANT_BLOCK - 1) / QUANT_BLOCK;
+
+    #pragma omp parallel for
+    for (size_t b = 0; b < numBlocks; b++) {
+        size_t start = b * QUANT_BLOCK;
+        size_t blockSize = min(QUANT_BLOCK, count - start);
+        int8_t *block = out + b * (sizeof(float) + QUANT_BLOCK);
+
+        float maxAbs = 0.0f;
+        for (size_t i = 0; i < blockSize; i++) {
+            maxAbs = max(maxAbs, fabs(values[start + i]));
+        }
+
+        float scale = maxAbs / MAX_LEVEL;
+        float invScale = (scale > 0.0f) ? 1.0f / scale : 0.0f;
+        memcpy(block, &scale, sizeof(float));
+
+        for (size_t i = 0; i < blockSize; i++) {
+            float level = min(max(nearbyint(values[start + i] * invScale), -MAX_LEVEL), MAX_LEVEL);
+            block[sizeof(float) + i] = (int8_t) level;
+        }
+    }
+}
+
+void PanelMatrix::decode(const int8_t *in, size_t count, uint32_t encoding, float *values) {
+    if (encoding != BinUtils::INT8) {
+        const uint16_t *halves = (const uint16_t*) in;
+
+        if (encoding == BinUtils::FP16) {
+            #pragma omp parallel for
+            for (size_t i = 0; i < count; i++) {
+                values[i] = halfToFloat(halves[i]);
+            }
+        } else {
+            #pragma omp parallel for
+            for (size_t i = 0; i < count; i++) {
+                values[i] = Bf16Tensor::toFloat(halves[i]);
+            }
+        }
+        return;
+    }
+
+    size_t numBlocks = (count + QUANT_BLOCK - 1) / QUANT_BLOCK;
+
+    #pragma omp parallel for
+    for (size_t b = 0; b < numBlocks; b++) {
+        size_t start = b * QUANT_BLOCK;
+        size_t blockSize = min(QUANT_BLOCK, count - start);
+        const int8_t *block = in + b * (sizeof(float) + QUANT_BLOCK);
+
+        float scale;
+        memcpy(&scale, block, sizeof(float));
+
+        for (size_t i = 0; i < blockSize; i++) {
+            values[start + i] = block[sizeof(float) + i] * scale;
+        }
+    }
+}
+
+// IEEE half precision, rounded to nearest even. Values past the fp16 range become infinity and
+// values below it become subnormals or zero.
+uint16_t PanelMatrix::halfFromFloat(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(float));
+    uint16_t sign = (uint16_t) ((bits >> 16) & 0x8000);
+    uint32_t absBits = bits & 0x7FFFFFFF;
+
+    if (absBits > 0x7F800000)
+        return sign | 0x7E00;
+
+    if (absBits >= 0x47800000)
+        return sign | 0x7C00;
+
+    if (absBits < 0x38800000) {
+        float absValue = fabs(value);
+        return sign | (uint16_t) nearbyint(absValue * 16777216.0f);
+    }
+
+    uint32_t rounded = absBits + 0xFFF + ((absBits >> 13) & 1);
+    return sign | (uint16_t) ((rounded - 0x38000000) >> 13);
+}
+
+float PanelMatrix::halfToFloat(uint16_t half) {
+    uint32_t sign = (uint32_t) (half & 0x8000) << 16;
+    uint32_t exponent = (half >> 10) & 0x1F;
+    uint32_t mantissa = half & 0x3FF;
+    uint32_t bits;
+
+    if (exponent == 0) {
+        float subnormal = mantissa * 5.9604645e-8f;
+        memcpy(&bits, &subnormal, sizeof(float));
+        bits |= sign;
+    } else if (exponent == 0x1F) {
+        bits = sign | 0x7F800000 | (mantissa << 13);
+    } else {
+        bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+    }
+
+    float value;
+    memcpy(&value, &bits, sizeof(float));
+    return value;
+}
\ No newline at end of file
@@ -0,0 +1,391 @@
+#include "core/tensor/QuantizedMatrix.h"
+#include "core/tensor/Tensor.h"
+#include "core/tensor/PanelMatrix.h"
+#include "utils/ConsoleUtils.h"
+#include "utils/BinUtils.h"
+#include "utils/MappedFile.h"
+#include <algorithm>
+#include <cmath>
+#include <climits>
+
+const size_t QuantizedMatrix::ROW_BLOCK = 4;
+const size_t QuantizedMatrix::ROW_ALIGNMENT = 64;
+const size_t QuantizedMatrix::MIN_FASTER_COLS = 256;
+const int32_t QuantizedMatrix::MAX_LEVEL = 127;
+const int32_t QuantizedMatrix::ZERO_POINT = 128;
+const float QuantizedMatrix::SMOOTHING_ALPHA = 0.5f;
+
+QuantizedMatrix::QuantizedMatrix() : numRows(0), numCols(0), rowStride(0), numChannels(0), data(nullptr) {}
+
+QuantizedMatrix::QuantizedMatrix(const QuantizedMatrix &other) : data(nullptr) {
+    *this = other;
+}
+
+QuantizedMatrix& QuantizedMatrix::operator=(const QuantizedMatrix &other) {
+    if (this == &other)
+        return *this;
+
+    numRows = other.numRows;
+    numCols = other.numCols;
+    rowStride = other.rowStride;
+    numChannels = other.numChannels;
+    weights = other.weights;
+    rowSums = other.rowSums;
+    outScales = other.outScales;
+    channelMultipliers = other.channelMultipliers;
+    mapping = other.mapping;
+    data = (mapping != nullptr) ? other.data : (weights.empty() ? nullptr : weights.data());
+    return *this;
+}
+
+// Balances the range of each input channel against the weights it multiplies:
+// s = maxInput^alpha / maxWeight^(1 - alpha). Dead channels keep a factor of 1.
+vector<float> QuantizedMatrix::computeSmoothing(
+    const Tensor &mat,
+    const vector<float> &inputRanges
+) const {
+    const vector<float> &matFlat = mat.getFlat();
+    vector<float> weightRanges(numChannels, 0.0f);
+
+    for (size_t i = 0; i < numRows; i++) {
+        const float *row = matFlat.data() + i * numCols;
+        for (size_t k = 0; k < numCols; k++) {
+            size_t c = k % numChannels;
+            weightRanges[c] = max(weightRanges[c], fabs(row[k]));
+        }
+    }
+
+    vector<float> smoothing(numChannels, 1.0f);
+    for (size_t c = 0; c < numChannels; c++) {
+        if (inputRanges[c] > 0.0f && weightRanges[c] > 0.0f) {
+            smoothing[c] = powf(inputRanges[c], SMOOTHING_ALPHA) / 
+                powf(weightRanges[c], 1.0f - SMOOTHING_ALPHA);
+        }
+    }
+
+    return smoothing;
+}
+
+// Quantizes the tensor as a {shape[0], remaining dims} matrix. inputRanges holds the largest
+// absolute calibration input per channel, where the channel of column k is k % channels.
+// Rows are zero-padded to a multiple of 64 bytes: the vectorized dot products fall back to
+// scalar code on any remainder, which dominates for short rows such as 3x3 windows.
+void QuantizedMatrix::quantize(const Tensor &mat, const vector<float> &inputRanges) {
+    const vector<size_t> &shape = mat.getShape();
+    if (shape.size() < 2 || shape[0] == 0 || inputRanges.empty()) {
+        ConsoleUtils::fatalError("Only non-empty tensors with at least 2 dimensions can be quantized.");
+    }
+
+    numRows = shape[0];
+    numCols = mat.getSize() / numRows;
+    numChannels = inputRanges.size();
+    rowStride = (numCols + ROW_ALIGNMENT - 1) / ROW_ALIGNMENT * ROW_ALIGNMENT;
+
+    if (numCols % numChannels != 0) {
+        ConsoleUtils::fatalError(
+            "Calibration found " + to_string(numChannels) + " input channels, which do not "
+            "divide the " + to_string(numCols) + " weight columns."
+        );
+    }
+
+    size_t maxCols = INT_MAX / ((MAX_LEVEL + ZERO_POINT) * MAX_LEVEL);
+    if (numCols > maxCols) {
+        ConsoleUtils::fatalError(
+            "Layers with more than " + to_string(maxCols) +
+            " inputs cannot be quantized without overflowing the int32 accumulators."
+        );
+    }
+
+    vector<float> smoothing = computeSmoothing(mat, inputRanges);
+    float inputRange = 0.0f;
+    for (size_t c = 0; c < numChannels; c++) {
+        inputRange = max(inputRange, inputRanges[c] / smoothing[c]);
+    }
+
+    float inputScale = (inputRange > 0.0f) ? inputRange / MAX_LEVEL : 1.0f;
+    channelMultipliers.resize(numChannels);
+    for (size_t c = 0; c < numChannels; c++) {
+        channelMultipliers[c] = 1.0f / (smoothing[c] * inputScale);
+    }
+
+    mapping.reset();
+    weights.assign(numRows * rowStride, 0);
+    rowSums.assign(numRows, 0);
+    outScales.assign(numRows, 0.0f);
+    data = weights.data();
+    const vector<float> &matFlat = mat.getFlat();
+
+    #pragma omp parallel for
+    for (size_t i = 0; i < numRows; i++) {
+        const float *row = matFlat.data() + i * numCols;
+        float rowRange = 0.0f;
+        for (size_t k = 0; k < numCols; k++) {
+            rowRange = max(rowRange, fabs(row[k] * smoothing[k % numChannels]));
+        }
+
+        float rowScale = (rowRange > 0.0f) ? rowRange / MAX_LEVEL : 1.0f;
+        int8_t *qRow = weights.data() + i * rowStride;
+        int32_t rowSum = 0;
+        for (size_t k = 0; k < numCols; k++) {
+            qRow[k] = (int8_t) nearbyintf(row[k] * smoothing[k % numChannels] / rowScale);
+            rowSum += qRow[k];
+        }
+
+        rowSums[i] = rowSum;
+        outScales[i] = rowScale * inputScale;
+    }
+}
+
+// Every int8 dot product ends in a horizontal reduction, so below a few hundred inputs per
+// output the packed fp32 kernels win and the layer is better left unquantized.
+bool QuantizedMatrix::isFaster(size_t numInputs) {
+    return numInputs >= MIN_FASTER_COLS;
+}
+
+void QuantizedMatrix::clear() {
+    numRows = 0;
+    numCols = 0;
+    rowStride = 0;
+    numChannels = 0;
+    weights.clear();
+    weights.shrink_to_fit();
+    rowSums.clear();
+    outScales.clear();
+    channelMultipliers.clear();
+    mapping.reset();
+    data = nullptr;
+}
+
+bool QuantizedMatrix::isEmpty() const {
+    return data == nullptr;
+}
+
+size_t QuantizedMatrix::getRowStride() const {
+    return rowStride;
+}
+
+// Quantizes a {numSamples, numCols} batch into rows of rowStride bytes.
+void QuantizedMatrix::quantizeInput(const float *x, size_t numSamples, uint8_t *xq) const {
+    size_t numPixels = numCols / numChannels;
+
+    #pragma omp parallel for
+    for (size_t i = 0; i < numSamples; i++) {
+        uint8_t *qRow = xq + i * rowStride;
+        quantizePixels(x + i * numCols, numPixels, qRow);
+        fill(qRow + numCols, qRow + rowStride, (uint8_t) ZERO_POINT);
+    }
+}
+
+void QuantizedMatrix::quantizePixels(const float *x, size_t numPixels, uint8_t *xq) const {
+    const float *multipliers = channelMultipliers.data();
+    float maxLevel = (float) MAX_LEVEL;
+
+    for (size_t i = 0; i < numPixels; i++) {
+        const float *pixel = x + i * numChannels;
+        uint8_t *qPixel = xq + i * numChannels;
+
+        #pragma omp simd
+        for (size_t c = 0; c < numChannels; c++) {
+            float level = min(max(pixel[c] * multipliers[c], -maxLevel), maxLevel);
+            qPixel[c] = (uint8_t) ((int32_t) nearbyintf(level) + ZERO_POINT);
+        }
+    }
+}
+
+// Quantizes an NHWC batch into the padded layout the window needs, with zeros in the border.
+void QuantizedMatrix::quantizeImage(const Tensor &input, const WindowDims &win, uint8_t *xq) const {
+    const vector<size_t> &inShape = input.getShape();
+    size_t numSamples = inShape[0];
+    size_t inRows = inShape[1];
+    size_t inCols = inShape[2];
+    size_t newRows = inRows + win.padRows;
+    size_t newCols = inCols + win.padCols;
+
+    if (win.padRows > 0 || win.padCols > 0) {
+        fill(xq, xq + numSamples * newRows * newCols * numChannels, (uint8_t) ZERO_POINT);
+    }
+
+    const float *inFlat = input.getFlat().data();
+
+    #pragma omp parallel for collapse(2)
+    for (size_t n = 0; n < numSamples; n++) {
+        for (size_t r = 0; r < inRows; r++) {
+            const float *inRow = inFlat + (n * inRows + r) * inCols * numChannels;
+            size_t padRow = (n * newRows + r + win.padTop) * newCols + win.padLeft;
+            quantizePixels(inRow, inCols, xq + padRow * numChannels);
+        }
+    }
+}
+
+// Dots ROW_BLOCK u8 rows against one s8 weight row. The reductions are left to the
+// auto-vectorizer, which turns them into vpdpbusd: GCC does not match the dot-product pattern
+// inside omp simd reductions.
+void QuantizedMatrix::dotBlock(
+    const uint8_t* const *xRows,
+    const int8_t *w,
+    size_t n,
+    int32_t *acc
+) {
+    const uint8_t *x0 = xRows[0];
+    const uint8_t *x1 = xRows[1];
+    const uint8_t *x2 = xRows[2];
+    const uint8_t *x3 = xRows[3];
+    int32_t a0 = 0, a1 = 0, a2 = 0, a3 = 0;
+    for (size_t k = 0; k < n; k++) {
+        int32_t wk = w[k];
+        a0 += x0[k] * wk;
+        a1 += x1[k] * wk;
+        a2 += x2[k] * wk;
+        a3 += x3[k] * wk;
+    }
+
+    acc[0] += a0;
+    acc[1] += a1;
+    acc[2] += a2;
+    acc[3] += a3;
+}
+
+int32_t QuantizedMatrix::dotRow(const uint8_t *x, const int8_t *w, size_t n) {
+    int32_t acc = 0;
+    for (size_t k = 0; k < n; k++) {
+        acc += x[k] * (int32_t) w[k];
+    }
+
+    return acc;
+}
+
+// Removes the input zero point from a dot product and dequantizes it.
+float QuantizedMatrix::dequantize(int32_t acc, size_t row) const {
+    return (acc - ZERO_POINT * rowSums[row]) * outScales[row];
+}
+
+// y = dequantize(Wx) + bias for one quantized sample. Uses PanelMatrix::setNumThreads().
+void QuantizedMatrix::gemv(const uint8_t *xq, const float *bias, float *y) const {
+    size_t numThreads = PanelMatrix::getNumThreads();
+
+    #pragma omp parallel for num_threads(numThreads) if(numThreads > 1)
+    for (size_t i = 0; i < numRows; i++) {
+        float out = dequantize(dotRow(xq, data + i * rowStride, rowStride), i);
+        y[i] = (bias != nullptr) ? out + bias[i] : out;
+    }
+}
+
+// y = dequantize(xW^T) + bias for a {batchSize, rowStride} quantized x, ROW_BLOCK samples at a time.
+void QuantizedMatrix::gemm(const uint8_t *xq, size_t batchSize, const float *bias, float *y) const {
+    size_t numRowBlocks = (batchSize + ROW_BLOCK - 1) / ROW_BLOCK;
+
+    #pragma omp parallel for collapse(2)
+    for (size_t b = 0; b < numRowBlocks; b++) {
+        for (size_t i = 0; i < numRows; i++) {
+            size_t xStart = b * ROW_BLOCK;
+            size_t blockRows = min(ROW_BLOCK, batchSize - xStart);
+
+            // Tail blocks repeat the last sample and discard the result.
+            const uint8_t *xRows[ROW_BLOCK];
+            for (size_t r = 0; r < ROW_BLOCK; r++) {
+                xRows[r] = xq + (xStart + min(r, blockRows - 1)) * rowStride;
+            }
+
+            int32_t acc[ROW_BLOCK] = {};
+            dotBlock(xRows, data + i * rowStride, rowStride, acc);
+
+            for (size_t r = 0; r < blockRows; r++) {
+                float out = dequantize(acc[r], i);
+                y[(xStart + r) * numRows + i] = (bias != nullptr) ? out + bias[i] : out;
+            }
+        }
+    }
+}
+
+// Valid convolution of a quantized, already padded NHWC input with kernels quantized from
+// {outDepth, kRows, kCols, inDepth}. Each window is gathered into a row of patches, which must
+// hold outRows * outCols * rowStride bytes per sample, so the convolution runs as a gemm with
+// dot products over the whole window.
+void QuantizedMatrix::conv2d(
+    const uint8_t *xq,
+    const vector<size_t> &paddedShape,
+    size_t kRows,
+    size_t kCols,
+    size_t stride,
+    const float *bias,
+    uint8_t *patches,
+    Tensor &output
+) const {
+    const vector<size_t> &outShape = output.getShape();
+    size_t numSamples = paddedShape[0];
+    size_t inRows = paddedShape[1];
+    size_t inCols = paddedShape[2];
+    size_t inDepth = paddedShape[3];
+    size_t outRows = outShape[1];
+    size_t outCols = outShape[2];
+
+    if (numCols != kRows * kCols * inDepth || outShape[3] != numRows) {
+        ConsoleUtils::fatalError("Quantized kernels do not match the convolution shapes.");
+    }
+
+    size_t segment = kCols * inDepth;
+
+    #pragma omp parallel for collapse(3)
+    for (size_t n = 0; n < numSamples; n++) {
+        for (size_t r = 0; r < outRows; r++) {
+            for (size_t c = 0; c < outCols; c++) {
+                uint8_t *patch = patches + ((n * outRows + r) * outCols + c) * rowStride;
+                const uint8_t *window = xq + ((n * inRows + r * stride) * inCols + c * stride) * inDepth;
+
+                for (size_t i = 0; i < kRows; i++) {
+                    const uint8_t *inRow = window + i * inCols * inDepth;
+                    copy(inRow, inRow + segment, patch + i * segment);
+                }
+                fill(patch + numCols, patch + rowStride, (uint8_t) ZERO_POINT);
+            }
+        }
+    }
+
+    gemm(patches, numSamples * outRows * outCols, bias, output.getFlat().data());
+}
+
+void QuantizedMatrix::writeBin(ofstream &modelBin) const {
+    uint32_t numRowsWrite = (uint32_t) numRows;
+    uint32_t numColsWrite = (uint32_t) numCols;
+    uint32_t rowStrideWrite = (uint32_t) rowStride;
+    uint32_t numChannelsWrite = (uint32_t) numChannels;
+
+    modelBin.write((char*) &numRowsWrite, sizeof(uint32_t));
+    modelBin.write((char*) &numColsWrite, sizeof(uint32_t));
+    modelBin.write((char*) &rowStrideWrite, sizeof(uint32_t));
+    modelBin.write((char*) &numChannelsWrite, sizeof(uint32_t));
+    modelBin.write((char*) rowSums.data(), numRows * sizeof(int32_t));
+    modelBin.write((char*) outScales.data(), numRows * sizeof(float));
+    modelBin.write((char*) channelMultipliers.data(), numChannels * sizeof(float));
+    BinUtils::writeBytes(modelBin, data, numRows * rowStride);
+}
+
+void QuantizedMatrix::loadFromBin(ifstream &modelBin) {
+    uint32_t numRowsRead;
+    uint32_t numColsRead;
+    uint32_t rowStrideRead;
+    uint32_t numChannelsRead;
+
+    modelBin.read((char*) &numRowsRead, sizeof(uint32_t));
+    modelBin.read((char*) &numColsRead, sizeof(uint32_t));
+    modelBin.read((char*) &rowStrideRead, sizeof(uint32_t));
+    modelBin.read((char*) &numChannelsRead, sizeof(uint32_t));
+
+    if (numRowsRead == 0 || numChannelsRead == 0 || numColsRead % numChannelsRead != 0 ||
+        rowStrideRead < numColsRead) {
+        ConsoleUtils::fatalError("Quantized weights in the model file are malformed.");
+    }
+
+    numRows = numRowsRead;
+    numCols = numColsRead;
+    rowStride = rowStrideRead;
+    numChannels = numChannelsRead;
+
+    rowSums.resize(numRows);
+    outScales.resize(numRows);
+    channelMultipliers.resize(numChannels);
+    modelBin.read((char*) rowSums.data(), numRows * sizeof(int32_t));
+    modelBin.read((char*) outScales.data(), numRows * sizeof(float));
+    modelBin.read((char*) channelMultipliers.data(), numChannels * sizeof(float));
+    data = BinUtils::readBytes(modelBin, weights, numRows * rowStride, mapping);
+}
\ No newline at end of file
@@ -169,6 +169,16 @@ WindowDims Tensor::computeInputWindow(
     Tensor::Paddings padding,
     size_t stride
 ) const {
+    return computeInputWindow(shape, kRows, kCols, padding, stride);
+}
+
+WindowDims Tensor::computeInputWindow(
+    const vector<size_t> &shape,
+    size_t kRows,
+    size_t kCols,
+    Tensor::Paddings padding,
+    size_t stride
+) {
     WindowDims win;
     if (padding == Paddings::NONE) {
 
@@ -278,6 +288,9 @@ const Tensor& Tensor::padIfNeeded(
     return toPad;
 }
 
+// Valid convolution with {outDepth, kRows, kCols, inDepth} kernels. The kernels are copied window
+// major, so each input value meets a contiguous row of weights and the inner loop runs over the
+// output channels of a pixel.
 void Tensor::conv2dForward(
     const Tensor &kernals,
     size_t stride,
@@ -302,37 +315,54 @@ void Tensor::conv2dForward(
     vector<float> &outFlat = output.data;
     const vector<float> &biasFlat = biases.data;
     const vector<float> &inFlat = data;
-    const vector<float> &kernalsFlat = kernals.data;
+    vector<float> kWindows;
+    kernals.toWindowMajor(kWindows);
 
-    #pragma omp parallel for collapse(4)
+    #pragma omp parallel for collapse(3)
     for (size_t n = 0; n < numSamples; n++) {
         for (size_t r = 0; r < outRows; r++) {
             for (size_t c = 0; c < outCols; c++) {
-                for (size_t o = 0; o < outDepth; o++) {
+                float *outPixel = outFlat.data() + ((n * outRows + r) * outCols + c) * outDepth;
+                copy(biasFlat.begin(), biasFlat.begin() + outDepth, outPixel);
 
-                    float value = biasFlat[o];
-                    for (size_t i = 0; i < kRows; i++) {
-                        size_t inRow = r*stride + i;
+                for (size_t i = 0; i < kRows; i++) {
+                    size_t inRow = r*stride + i;
 
-                        for (size_t j = 0; j < kCols; j++) {
-                            size_t inCol = c*stride + j;
+                    for (size_t j = 0; j < kCols; j++) {
+                        size_t inCol = c*stride + j;
+                        const float *inPixel = inFlat.data() + ((n * inRows + inRow) * inCols + inCol) * inDepth;
+                        const float *kWindow = kWindows.data() + (i * kCols + j) * inDepth * outDepth;
 
-                            for (size_t d = 0; d < inDepth; d++) {
-                                size_t kIdx = (((o * kRows + i) * kCols + j) * inDepth) + d;
-                                size_t inIdx = (((n * inRows + inRow) * inCols + inCol) * inDepth) + d;
-                                value += inFlat[inIdx] * kernalsFlat[kIdx];
+                        for (size_t d = 0; d < inDepth; d++) {
+                            float value = inPixel[d];
+                            const float *kRow = kWindow + d * outDepth;
+
+                            #pragma omp simd
+                            for (size_t o = 0; o < outDepth; o++) {
+                                outPixel[o] += value * kRow[o];
                             }
                         }
                     }
-
-                    size_t outIdx = (((n * outRows + r) * outCols + c) * outDepth) + o;
-                    outFlat[outIdx] = value;
                 }
             }
         }
     }
 }
 
+// Copies {numKernels, kRows, kCols, inDepth} kernels as {kRows, kCols, inDepth, numKernels}.
+void Tensor::toWindowMajor(vector<float> &windows) const {
+    size_t numKernals = shape[0];
+    size_t windowSize = getSize() / numKernals;
+    windows.resize(getSize());
+
+    #pragma omp parallel for
+    for (size_t w = 0; w < windowSize; w++) {
+        for (size_t k = 0; k < numKernals; k++) {
+            windows[w * numKernals + k] = data[k * windowSize + w];
+        }
+    }
+}
+
 void Tensor::maxPool2d(
     vector<size_t> &maxIndices,
     size_t kRows,
@@ -340,6 +370,29 @@ void Tensor::maxPool2d(
     size_t stride,
     Tensor &pooledOutput,
     const WindowDims &winIn
+) const {
+    maxIndices.assign(pooledOutput.getSize(), SIZE_MAX);
+    maxPool2dInternal(maxIndices.data(), kRows, kCols, stride, pooledOutput, winIn);
+}
+
+// Inference variant that skips recording the argmax indices needed for backprop.
+void Tensor::maxPool2d(
+    size_t kRows,
+    size_t kCols,
+    size_t stride,
+    Tensor &pooledOutput,
+    const WindowDims &winIn
+) const {
+    maxPool2dInternal(nullptr, kRows, kCols, stride, pooledOutput, winIn);
+}
+
+void Tensor::maxPool2dInternal(
+    size_t *maxIndices,
+    size_t kRows,
+    size_t kCols,
+    size_t stride,
+    Tensor &pooledOutput,
+    const WindowDims &winIn
 ) const {
     // Add error checking
     size_t batchSize = shape[0];
@@ -350,8 +403,6 @@ void Tensor::maxPool2d(
     size_t origRows = inRows - winIn.padRows;
     size_t origCols = inCols - winIn.padCols;
 
-    maxIndices.assign(pooledOutput.getSize(), SIZE_MAX);
-
     const vector<float> &inFlat = data;
     vector<float> &outFlat = pooledOutput.data;
 
@@ -383,13 +434,18 @@ void Tensor::maxPool2d(
 
                     size_t outIdx = (((b * winIn.outRows + r) * winIn.outCols + c) * inDepth) + d;
                     outFlat[outIdx] = maxVal;
-                    maxIndices[outIdx] = maxIdx;
+                    if (maxIndices != nullptr) {
+                        maxIndices[outIdx] = maxIdx;
+                    }
                 }
             }
         }
     }
 }
 
+// Kernel gradients of a valid convolution. Samples are split across threads, each accumulating
+// window-major gradients in its own buffer so the inner loop runs over a gradient pixel. The
+// buffers are summed, then dW is written in the kernel layout.
 void Tensor::conv2dWeights(
     const Tensor &grad,
     size_t numKernals,
@@ -409,35 +465,58 @@ void Tensor::conv2dWeights(
     size_t inCols = shape[2];
     size_t inDepth = shape[3];
 
+    size_t windowSize = kRows * kCols * inDepth;
+    size_t dwSize = windowSize * numKernals;
+    vector<float> dwWindows(dwSize, 0.0f);
     const vector<float> &gradFlat = grad.data;
     vector<float> &dwFlat = dW.data;
 
-    #pragma omp parallel for collapse(4)
-    for (size_t k = 0; k < numKernals; k++) {
-        for (size_t i = 0; i < kRows; i++) {
-            for (size_t j = 0; j < kCols; j++) {
-                for (size_t d = 0; d < inDepth; d++) {
+    #pragma omp parallel
+    {
+        vector<float> threadWindows(dwSize, 0.0f);
+
+        #pragma omp for
+        for (size_t n = 0; n < batchSize; n++) {
+            for (size_t i = 0; i < kRows; i++) {
+                for (size_t j = 0; j < kCols; j++) {
+                    float *dwWindow = threadWindows.data() + (i * kCols + j) * inDepth * numKernals;
+
+                    for (size_t r = 0; r < gradRows; r++) {
+                        size_t inRow = r * stride + i;
 
-                    float value = 0.0;
-                    for (size_t n = 0; n < batchSize; n++) {
-                        for (size_t r = 0; r < gradRows; r++) {
-                            size_t inRow = r * stride + i;
+                        for (size_t c = 0; c < gradCols; c++) {
+                            size_t inCol = c * stride + j;
+                            const float *gradPixel = gradFlat.data() + ((n * gradRows + r) * gradCols + c) * numKernals;
+                            const float *inPixel = data.data() + ((n * inRows + inRow) * inCols + inCol) * inDepth;
 
-                            for (size_t c = 0; c < gradCols; c++) {
-                                size_t inCol = c * stride + j;
-                                size_t inIdx = (((n * inRows + inRow) * inCols + inCol) * inDepth) + d;
-                                size_t gradIdx = (((n * gradRows + r) * gradCols + c) * numKernals) + k;
+                            for (size_t d = 0; d < inDepth; d++) {
+                                float value = inPixel[d];
+                                float *dwRow = dwWindow + d * numKernals;
 
-                                value += (gradFlat[gradIdx] * data[inIdx]);
+                                #pragma omp simd
+                                for (size_t k = 0; k < numKernals; k++) {
+                                    dwRow[k] += value * gradPixel[k];
+                                }
                             }
                         }
                     }
-
-                    size_t dwIdx = (((k * kRows + i) * kCols + j) * inDepth) + d;
-                    dwFlat[dwIdx] = value;
                 }
             }
         }
+
+        #pragma omp critical
+        {
+            for (size_t w = 0; w < dwSize; w++) {
+                dwWindows[w] += threadWindows[w];
+            }
+        }
+    }
+
+    #pragma omp parallel for
+    for (size_t k = 0; k < numKernals; k++) {
+        for (size_t w = 0; w < windowSize; w++) {
+            dwFlat[k * windowSize + w] = dwWindows[w * numKernals + k];
+        }
     }
 }
 
@@ -514,6 +593,8 @@ void Tensor::padAndUpsampleGrad(
     }
 }
 
+// Input gradients from this upsampled gradient and the kernels rotated by 180 degrees. Each
+// value is a dot product over the window-major kernels of a gradient pixel.
 void Tensor::conv2dInput(
     const Tensor &kernals,
     Tensor &dX
@@ -532,16 +613,19 @@ void Tensor::conv2dInput(
     size_t dxCols = dX.shape[2];
 
     const vector<float> &gradFlat = data;
-    const vector<float> &kFlat = kernals.data;
     vector<float> &dxFlat = dX.data;
+    vector<float> kWindows;
+    kernals.toWindowMajor(kWindows);
 
-    #pragma omp parallel for collapse(4)
+    #pragma omp parallel for collapse(3)
     for (size_t n = 0; n < numSamples; n++) {
         for (size_t r = 0; r < dxRows; r++) {
             for (size_t c = 0; c < dxCols; c++) {
+                float *dxPixel = dxFlat.data() + ((n * dxRows + r) * dxCols + c) * inDepth;
+
                 for (size_t d = 0; d < inDepth; d++) {
+                    float value = 0.0f;
 
-                    float value = 0.0;
                     for (size_t i = 0; i < kRows; i++) {
                         size_t gradRow = r + i;
                         size_t flipI = kRows - 1 - i;
@@ -549,18 +633,17 @@ void Tensor::conv2dInput(
                         for (size_t j = 0; j < kCols; j++) {
                             size_t gradCol = c + j;
                             size_t flipJ = kCols - 1 - j;
+                            const float *gradPixel = gradFlat.data() + ((n * gradRows + gradRow) * gradCols + gradCol) * numkernals;
+                            const float *kRow = kWindows.data() + ((flipI * kCols + flipJ) * inDepth + d) * numkernals;
 
+                            #pragma omp simd reduction(+:value)
                             for (size_t k = 0; k < numkernals; k++) {
-                                size_t kIdx = (((k * kRows + flipI) * kCols + flipJ) * inDepth) + d;
-                                size_t gradIdx = (((n * gradRows + gradRow) * gradCols + gradCol) * numkernals) + k;
-                                value += (kFlat[kIdx] * gradFlat[gradIdx]);
-
+                                value += kRow[k] * gradPixel[k];
                             }
                         }
                     }
 
-                    size_t dxIdx = (((n * dxRows + r) * dxCols + c) * inDepth) + d;
-                    dxFlat[dxIdx] = value;
+                    dxPixel[d] = value;
                 }
             }
         }
@@ -0,0 +1,121 @@
+// #include <string>
+// #include <vector>
+// #include <fstream>
+// #include <iostream>
+// #include <thread>
+// #include <atomic>
+// #include <mutex>
+// #include <chrono>
+// #include "core/model/Pipeline.h"
+// #include "utils/ConsoleUtils.h"
+// #include "utils/DynamicBatcher.h"
+// #include "utils/LatencyHistogram.h"
+
+// // Reads feature fields per row, in training column order, skipping the target column.
+// vector<vector<string> > readRows(const string &path, size_t targetCol, size_t maxRows) {
+//     ifstream file(path);
+//     string line;
+//     getline(file, line);
+
+//     vector<vector<string> > rows;
+//     while (rows.size() < maxRows && getline(file, line)) {
+//         vector<string> fields;
+//         size_t start = 0;
+//         size_t end;
+//         size_t col = 0;
+//         do {
+//             end = line.find(',', start);
+//             if (col != targetCol) {
+//                 fields.push_back(line.substr(start, end == string::npos ? string::npos : end - start));
+//             }
+//             start = end + 1;
+//             col++;
+//         } while (end != string::npos);
+//         rows.push_back(fields);
+//     }
+
+//     return rows;
+// }
+
+// int main() {
+
+//     // Welcome Message
+//     ConsoleUtils::printTitle();
+
+//     // Data Path
+//     const string inputPath = "DataFiles/MNIST/mnist_test.csv";
+//     const size_t TARGET_COL = 0;
+//     const size_t MAX_ROWS = 10000;
+
+//     // Load Generator (open loop: clients send at a fixed total rate)
+//     const size_t NUM_CLIENTS = 4;
+//     const size_t REQUESTS_PER_CLIENT = 2500;
+//     const double REQUESTS_PER_SECOND = 2000.0;
+
+//     // Batcher
+//     const size_t MAX_BATCH_SIZE = 32;
+//     const size_t MAX_WAIT_MICROS = 1000;
+
+//     // Loading Model
+//     Pipeline pipe = Pipeline::loadFromBin("models/ClassMnistTrain.nn");
+//     vector<vector<string> > rows = readRows(inputPath, TARGET_COL, MAX_ROWS);
+
+//     // Unbatched Reference (one record per predict call)
+//     pipe.prepareInference(1);
+//     vector<float> output(pipe.getOutputSize());
+//     chrono::steady_clock::time_point start = chrono::steady_clock::now();
+//     for (const vector<string> &row : rows) {
+//         vector<string_view> fields(row.begin(), row.end());
+//         pipe.predict(fields, output.data());
+//     }
+//     double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+//     cout << "Unbatched: " << rows.size() / seconds << " requests/s" << endl;
+
+//     // Dynamic Batching
+//     DynamicBatcher batcher(pipe, MAX_BATCH_SIZE, MAX_WAIT_MICROS);
+//     mutex latencyMutex;
+//     LatencyHistogram latencies;
+//     atomic<size_t> numDone(0);
+//     size_t numRequests = NUM_CLIENTS * REQUESTS_PER_CLIENT;
+
+//     chrono::steady_clock::duration interval = chrono::duration_cast<chrono::steady_clock::duration>(
+//         chrono::duration<double>(NUM_CLIENTS / REQUESTS_PER_SECOND)
+//     );
+
+//     start = chrono::steady_clock::now();
+//     vector<thread> clients;
+//     for (size_t c = 0; c < NUM_CLIENTS; c++) {
+//         clients.emplace_back([&, c] {
+//             chrono::steady_clock::time_point next = start;
+//             for (size_t i = 0; i < REQUESTS_PER_CLIENT; i++) {
+//                 this_thread::sleep_until(next);
+//                 next += interval;
+
+//                 chrono::steady_clock::time_point sent = chrono::steady_clock::now();
+//                 const vector<string> &row = rows[(c * REQUESTS_PER_CLIENT + i) % rows.size()];
+//                 batcher.submit(row, [&, sent](vector<float> result) {
+//                     chrono::duration<double, micro> latency = chrono::steady_clock::now() - sent;
+//                     lock_guard<mutex> lock(latencyMutex);
+//                     latencies.record(latency.count());
+//                     numDone++;
+//                 });
+//             }
+//         });
+//     }
+
+//     for (thread &client : clients) {
+//         client.join();
+//     }
+//     while (numDone.load() < numRequests) {
+//         this_thread::sleep_for(chrono::milliseconds(1));
+//     }
+
+//     // Report
+//     seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+//     cout << "Batched: " << numRequests / seconds << " requests/s (offered " 
+//          << REQUESTS_PER_SECOND << ")" << endl;
+//     latencies.print("End-to-end latency");
+//     batcher.printStats();
+
+//     return 0;
+// }
\ No newline at end of file
@@ -45,32 +45,23 @@ int main() {
     ImageTransform2D *transformer = pipe.getImageTransformer();
     NeuralNet *nn = pipe.getModel();
 
-    // Data Reading
-    data->readTrain(dataPath);
+    // Data Reading (decode and resize straight into 128x128 8-bit images)
+    data->readTrain(dataPath, *transformer);
+    const ByteTensor &x = data->getTrainImages();
+    const vector<float> &y = data->getTrainTargets();
 
-    // Transform data (resize to 128x128 and normalize)
-    Tensor x = transformer->transform(data->getTrainFeatures());
-    vector<float> y = data->getTrainTargets();
+    // Splitting training data into train, test, and validation sets (index views over x)
+    IndexSplit splitTest = DataSplitter::stratifiedIndexSplit(x, y, 0.2f);
+    IndexSplit splitVal = DataSplitter::stratifiedIndexSplit(splitTest.xTrain, splitTest.yTrain, 0.1f);
 
-    // Splitting training data into train, test, and validation sets
-    Split splitTest = DataSplitter::stratifiedSplit(x, y, 0.2f);
-    Split splitVal = DataSplitter::stratifiedSplit(splitTest.xTrain, splitTest.yTrain, 0.1f);
-
-    const Tensor xTrain = splitVal.xTrain;
-    const Tensor xTest = splitTest.xVal;
-    const Tensor xVal = splitVal.xVal;
+    const SampleView xTrain = splitVal.xTrain;
+    const SampleView xTest = splitTest.xVal;
+    const SampleView xVal = splitVal.xVal;
 
     const vector<float> yTrain = splitVal.yTrain;
     const vector<float> yTest = splitTest.yVal;
     const vector<float> yVal = splitVal.yVal;
 
-    // Clearing unused data
-    data->clearTrain();
-    x.clear();
-    y.clear();
-    splitTest.clear();
-    splitVal.clear();
-
     // Training Data
     ProgressMetric *metric = new ProgressAccuracy();
     nn->fit(
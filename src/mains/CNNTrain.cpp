@@ -47,34 +47,25 @@
 //     // Data Paths
 //     const string dataPath = "DataFiles/kaggle_chest_xray";
 
-//     // Data Reading
+//     // Data Reading (decode and resize straight into 128x128 8-bit images)
 //     ImageData2D *data = new ImageData2D(CHANNELS);
-//     data->readTrain(dataPath);
-
-//     // Transform data (resize to 128x128 and normalize)
 //     ImageTransform2D *transformer = new ImageTransform2D(SIZE, SIZE, CHANNELS);
-//     Tensor x = transformer->transform(data->getTrainFeatures());
-//     vector<float> y = data->getTrainTargets();
+//     data->readTrain(dataPath, *transformer);
+//     const ByteTensor &x = data->getTrainImages();
+//     const vector<float> &y = data->getTrainTargets();
 
-//     // Splitting training data into train, test, and validation sets
-//     Split splitTest = DataSplitter::stratifiedSplit(x, y, 0.2f);
-//     Split splitVal = DataSplitter::stratifiedSplit(splitTest.xTrain, splitTest.yTrain, 0.1f);
+//     // Splitting training data into train, test, and validation sets (index views over x)
+//     IndexSplit splitTest = DataSplitter::stratifiedIndexSplit(x, y, 0.2f);
+//     IndexSplit splitVal = DataSplitter::stratifiedIndexSplit(splitTest.xTrain, splitTest.yTrain, 0.1f);
 
-//     const Tensor xTrain = splitVal.xTrain;
-//     const Tensor xTest = splitTest.xVal;
-//     const Tensor xVal = splitVal.xVal;
+//     const SampleView xTrain = splitVal.xTrain;
+//     const SampleView xTest = splitTest.xVal;
+//     const SampleView xVal = splitVal.xVal;
 
 //     const vector<float> yTrain = splitVal.yTrain;
 //     const vector<float> yTest = splitTest.yVal;
 //     const vector<float> yVal = splitVal.yVal;
 
-//     // Clearing unused data
-//     data->clearTrain();
-//     x.clear();
-//     y.clear();
-//     splitTest.clear();
-//     splitVal.clear();
-
 //     // Defining Model Architecture
 //     Loss *loss = new SoftmaxCrossEntropy();
 //     vector<Layer*> layers = {
@@ -0,0 +1,34 @@
+// #include <string>
+// #include "core/model/Pipeline.h"
+// #include "core/data/TabularData.h"
+// #include "utils/ConsoleUtils.h"
+// #include "utils/BulkScorer.h"
+
+// int main() {
+
+//     // Welcome Message
+//     ConsoleUtils::printTitle();
+
+//     // Data Paths
+//     const string inputPath = "DataFiles/MNIST/mnist_test.csv";
+//     const string outputPath = "DataFiles/MNIST/mnist_predictions.csv";
+
+//     // Skipped if present in the input, columns are matched by header name
+//     const string targetColumn = "label";
+
+//     // Rows parsed and inferred together, and number of chunks in flight (bounds memory)
+//     const size_t CHUNK_ROWS = 4096;
+//     const size_t NUM_CHUNKS = 4;
+
+//     // Threads for parsing, the rest go to inference (0 splits them evenly)
+//     const size_t PARSE_THREADS = 0;
+
+//     // Loading Model
+//     Pipeline pipe = Pipeline::loadFromBin("models/ClassMnistTrain.nn");
+
+//     // Streaming parse, inference and write
+//     BulkScorer scorer(pipe, CHUNK_ROWS, NUM_CHUNKS, PARSE_THREADS);
+//     scorer.score(inputPath, outputPath, targetColumn);
+
+//     return 0;
+// }
\ No newline at end of file
@@ -0,0 +1,38 @@
+// #include <iostream>
+// #include <string>
+// #include "utils/ConsoleUtils.h"
+// #include "utils/ImageTransform2D.h"
+// #include "core/data/ImageData2D.h"
+
+// int main() {
+//     // Welcome Message
+//     ConsoleUtils::printTitle();
+
+//     // Image Resize Dims
+//     const size_t SIZE = 128;
+
+//     // Number of channels to read in
+//     const size_t CHANNELS = 1;
+
+//     // Images per shard file
+//     const size_t RECORDS_PER_SHARD = 4096;
+
+//     // Data Paths
+//     const string trainPath = "DataFiles/kaggle_chest_xray/train";
+//     const string testPath = "DataFiles/kaggle_chest_xray/test";
+//     const string trainShardPath = "DataFiles/kaggle_chest_xray_shards/train";
+//     const string testShardPath = "DataFiles/kaggle_chest_xray_shards/test";
+
+//     // Decode and resize straight into packed 8-bit images
+//     ImageData2D *data = new ImageData2D(CHANNELS);
+//     ImageTransform2D *transformer = new ImageTransform2D(SIZE, SIZE, CHANNELS);
+//     data->readTrain(trainPath, *transformer);
+//     data->readTest(testPath, *transformer);
+
+//     // Write fixed-record shards (load later with data->readTrainShards(trainShardPath))
+//     data->writeTrainShards(trainShardPath, RECORDS_PER_SHARD);
+//     data->writeTestShards(testShardPath, RECORDS_PER_SHARD);
+
+//     delete data;
+//     delete transformer;
+// }
\ No newline at end of file
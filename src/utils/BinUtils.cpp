@@ -8,6 +8,7 @@
 #include <cstring>
 #include "core/model/Pipeline.h"
 #include "core/model/NeuralNet.h"
+#include "utils/MappedFile.h"
 #include <filesystem>
 
 using namespace std;
@@ -17,8 +18,31 @@ const char BinUtils::CANCEL = 'q';
 const char BinUtils::OVERRIDE = 'o';
 const char BinUtils::RENAME = 'r';
 const string BinUtils::MODEL_EXTENSION = ".nn";
-
-void BinUtils::savePipeline(const Pipeline &pipe, const string &filepath) {
+const string BinUtils::TEMP_EXTENSION = ".tmp";
+const uint8_t BinUtils::FORMAT_MARKER = 0xA5;
+const uint32_t BinUtils::FORMAT_REVISION = 7;
+const uint32_t BinUtils::LEGACY_REVISION = 1;
+const char BinUtils::CONTAINER_MAGIC[4] = {'N', 'N', 'V', '2'};
+const uint32_t BinUtils::CONTAINER_VERSION = 2;
+const size_t BinUtils::ALIGNMENT = 64;
+const uint32_t BinUtils::STREAM_SECTION = 0;
+const uint32_t BinUtils::FLOAT_SECTION = 1;
+const uint32_t BinUtils::BYTE_SECTION = 2;
+const uint32_t BinUtils::INLINE_ARRAY = 0;
+const uint32_t BinUtils::SECTION_ARRAY = 1;
+const uint64_t BinUtils::CHECKSUM_SEED = 0xCBF29CE484222325ULL;
+const uint64_t BinUtils::CHECKSUM_PRIME = 0x9E3779B97F4A7C15ULL;
+
+mutex BinUtils::fileMutex;
+uint32_t BinUtils::readRevision = BinUtils::FORMAT_REVISION;
+bool BinUtils::isWritingSections = false;
+BinUtils::WeightFormats BinUtils::writeFormat = BinUtils::FP32;
+vector<BinUtils::Section> BinUtils::writeSections;
+shared_ptr<const MappedFile> BinUtils::readMapping;
+vector<BinUtils::Section> BinUtils::readSections;
+bool BinUtils::verifyChecksums = true;
+
+void BinUtils::savePipeline(const Pipeline &pipe, const string &filepath, WeightFormats format) {
     string fileToWrite = addExtension(filepath);
     bool done = !fileExists(fileToWrite, false);
     bool shouldWrite = done;
@@ -42,7 +66,7 @@ void BinUtils::savePipeline(const Pipeline &pipe, const string &filepath) {
 
     if (shouldWrite) {
         checkParentDirs(fileToWrite);
-        writeToBin(pipe, fileToWrite);
+        writeToBin(pipe, fileToWrite, format);
         ConsoleUtils::printSuccess("Model saved successfully as \"" + fileToWrite + "\".", true);
     }
 
@@ -109,17 +133,83 @@ void BinUtils::checkParentDirs(const string &filepath) {
     }
 }
 
-void BinUtils::writeToBin(const Pipeline &pipe, const string &filepath) {
-    ofstream modelBin(filepath, ios::out | ios::binary);
+// Writes to a temporary file next to the target and renames it over the target at the end.
+// A model loaded from the target may still be reading its weights from the old file's mapping.
+// The section table and read state below are shared, so whole saves and loads run one at a time.
+void BinUtils::writeToBin(const Pipeline &pipe, const string &filepath, WeightFormats format) {
+    lock_guard<mutex> lock(fileMutex);
+    string tempPath = filepath + TEMP_EXTENSION;
+    ofstream modelBin(tempPath, ios::out | ios::binary);
     if (!modelBin) {
         ConsoleUtils::fatalError(
-            "Could not open \"" + filepath + "\": " + strerror(errno) + "."
+            "Could not open \"" + tempPath + "\": " + strerror(errno) + "."
         );
     }
 
+    ContainerHeader header = {};
+    modelBin.write((char*) &header, sizeof(ContainerHeader));
+
+    // Section 0 is the serialized stream itself; it is filled in once its length is known.
+    writeSections.assign(1, Section());
+    isWritingSections = true;
+    writeFormat = format;
+    writeHeader(modelBin);
     pipe.writeBin(modelBin);
+    isWritingSections = false;
+    writeFormat = FP32;
+
+    writePadding(modelBin);
+    uint64_t tableOffset = (uint64_t) modelBin.tellp();
+    writeSections[0] = {
+        STREAM_SECTION, 0, sizeof(ContainerHeader), tableOffset - sizeof(ContainerHeader), 0
+    };
+    modelBin.write((char*) writeSections.data(), writeSections.size() * sizeof(Section));
+
+    modelBin.close();
+    if (!modelBin) {
+        ConsoleUtils::fatalError(
+            "Failed to write model to \"" + tempPath + "\". The file may be corrupted."
+        );
+    }
+
+    finishContainer(tempPath, tableOffset);
+
+    error_code ec;
+    fs::rename(tempPath, filepath, ec);
+    if (ec) {
+        ConsoleUtils::fatalError(
+            "Could not replace \"" + filepath + "\" with the saved model: " + ec.message() +
+            ". The model was left in \"" + tempPath + "\"."
+        );
+    }
+}
+
+// Checksums the stream section from the written file, then fills in its table entry and the
+// header. The header goes last, so an interrupted save never looks like a valid container.
+void BinUtils::finishContainer(const string &filepath, uint64_t tableOffset) {
+    uint64_t fileSize;
+    {
+        MappedFile written(filepath);
+        writeSections[0].checksum = streamChecksum(written.getData(), writeSections);
+        fileSize = written.getSize();
+    }
 
+    ContainerHeader header = {};
+    memcpy(header.magic, CONTAINER_MAGIC, sizeof(CONTAINER_MAGIC));
+    header.version = CONTAINER_VERSION;
+    header.numSections = (uint32_t) writeSections.size();
+    header.alignment = (uint32_t) ALIGNMENT;
+    header.tableOffset = tableOffset;
+    header.fileSize = fileSize;
+
+    fstream modelBin(filepath, ios::in | ios::out | ios::binary);
+    modelBin.seekp(tableOffset);
+    modelBin.write((char*) &writeSections[0], sizeof(Section));
+    modelBin.seekp(0);
+    modelBin.write((char*) &header, sizeof(ContainerHeader));
     modelBin.close();
+    writeSections.clear();
+
     if (!modelBin) {
         ConsoleUtils::fatalError(
             "Failed to write model to \"" + filepath + "\". The file may be corrupted."
@@ -127,6 +217,13 @@ void BinUtils::writeToBin(const Pipeline &pipe, const string &filepath) {
     }
 }
 
+void BinUtils::writePadding(ofstream &modelBin) {
+    size_t pos = (size_t) modelBin.tellp();
+    size_t padBytes = (ALIGNMENT - pos % ALIGNMENT) % ALIGNMENT;
+    char zeros[ALIGNMENT] = {};
+    modelBin.write(zeros, padBytes);
+}
+
 string BinUtils::getNewModelPath() {
     bool done = false;
     string newFilepath;
@@ -148,6 +245,7 @@ string BinUtils::getNewModelPath() {
 
 Pipeline BinUtils::loadPipeline(const string &filepath) {
     string fullFilepath = addExtension(filepath);
+    lock_guard<mutex> lock(fileMutex);
 
     ifstream modelBin(fullFilepath, ios::in | ios::binary);
     if (!modelBin) {
@@ -157,8 +255,17 @@ Pipeline BinUtils::loadPipeline(const string &filepath) {
         );
     }
 
+    if (isContainer(modelBin)) {
+        openContainer(fullFilepath);
+        modelBin.seekg(sizeof(ContainerHeader));
+    }
+
+    readHeader(modelBin);
     Pipeline pipe;
     pipe.loadComponents(modelBin);
+    readRevision = FORMAT_REVISION;
+    readMapping.reset();
+    readSections.clear();
     modelBin.close();
 
     if (!modelBin) {
@@ -173,6 +280,257 @@ Pipeline BinUtils::loadPipeline(const string &filepath) {
     return pipe;
 }
 
+void BinUtils::writeHeader(ofstream &modelBin) {
+    modelBin.write((char*) &FORMAT_MARKER, sizeof(uint8_t));
+    modelBin.write((char*) &FORMAT_REVISION, sizeof(uint32_t));
+}
+
+// Files written before revisioning start with the hasModel flag (0 or 1) instead of the marker.
+void BinUtils::readHeader(ifstream &modelBin) {
+    if (modelBin.peek() != FORMAT_MARKER) {
+        readRevision = LEGACY_REVISION;
+        return;
+    }
+
+    uint8_t marker;
+    modelBin.read((char*) &marker, sizeof(uint8_t));
+    modelBin.read((char*) &readRevision, sizeof(uint32_t));
+
+    if (readRevision > FORMAT_REVISION) {
+        ConsoleUtils::fatalError(
+            "Model file revision " + to_string(readRevision) + " is newer than the supported "
+            "revision " + to_string(FORMAT_REVISION) + ". Please update the library."
+        );
+    }
+}
+
+uint32_t BinUtils::getReadRevision() {
+    return readRevision;
+}
+
+// Files from before the container start with the revision marker or the legacy hasModel flag.
+bool BinUtils::isContainer(ifstream &modelBin) {
+    char magic[sizeof(CONTAINER_MAGIC)] = {};
+    modelBin.read(magic, sizeof(magic));
+    bool isMatching = modelBin.gcount() == (streamsize) sizeof(magic) &&
+        memcmp(magic, CONTAINER_MAGIC, sizeof(magic)) == 0;
+
+    modelBin.clear();
+    modelBin.seekg(0);
+    return isMatching;
+}
+
+// Maps the whole file and validates the section table. Weight sections are handed out as views
+// into the mapping, so processes serving the same file share its pages through the page cache.
+void BinUtils::openContainer(const string &filepath) {
+    shared_ptr<const MappedFile> file = make_shared<const MappedFile>(filepath);
+    const uint8_t *data = file->getData();
+    size_t fileSize = file->getSize();
+    string corrupted = "Model file \"" + filepath + "\" is corrupted: ";
+
+    ContainerHeader header;
+    if (fileSize < sizeof(ContainerHeader)) {
+        ConsoleUtils::fatalError(corrupted + "the header is truncated.");
+    }
+    memcpy(&header, data, sizeof(ContainerHeader));
+
+    if (header.version > CONTAINER_VERSION) {
+        ConsoleUtils::fatalError(
+            "Model container version " + to_string(header.version) + " is newer than the "
+            "supported version " + to_string(CONTAINER_VERSION) + ". Please update the library."
+        );
+    }
+
+    if (header.fileSize != fileSize || header.tableOffset > fileSize || header.numSections == 0 ||
+        header.numSections > (fileSize - header.tableOffset) / sizeof(Section)) {
+        ConsoleUtils::fatalError(corrupted + "the file is truncated.");
+    }
+
+    readSections.resize(header.numSections);
+    memcpy(readSections.data(), data + header.tableOffset, header.numSections * sizeof(Section));
+
+    const Section &stream = readSections[0];
+    uint64_t prevEnd = stream.offset;
+    bool isValid = stream.kind == STREAM_SECTION && stream.offset == sizeof(ContainerHeader) &&
+        stream.size == header.tableOffset - stream.offset;
+
+    for (size_t i = 1; i < readSections.size() && isValid; i++) {
+        const Section &section = readSections[i];
+        isValid = (section.kind == FLOAT_SECTION || section.kind == BYTE_SECTION) &&
+            section.offset % ALIGNMENT == 0 &&
+            section.offset >= prevEnd && section.size <= header.tableOffset - section.offset;
+        prevEnd = section.offset + section.size;
+    }
+
+    if (!isValid) {
+        ConsoleUtils::fatalError(corrupted + "the section table is invalid.");
+    }
+
+    if (streamChecksum(data, readSections) != stream.checksum) {
+        ConsoleUtils::fatalError(corrupted + "checksum mismatch in the model description.");
+    }
+
+    for (size_t i = 1; i < readSections.size() && verifyChecksums; i++) {
+        const Section &section = readSections[i];
+        if (checksum(data + section.offset, section.size, CHECKSUM_SEED) != section.checksum) {
+            ConsoleUtils::fatalError(
+                corrupted + "checksum mismatch in weight section " + to_string(i) + "."
+            );
+        }
+    }
+
+    readMapping = file;
+}
+
+// Word-at-a-time multiply-xorshift hash. It catches truncation and bit rot, not tampering.
+uint64_t BinUtils::checksum(const uint8_t *bytes, size_t numBytes, uint64_t seed) {
+    uint64_t hash = seed ^ (numBytes * CHECKSUM_PRIME);
+    size_t numWords = numBytes / sizeof(uint64_t);
+
+    for (size_t i = 0; i < numWords; i++) {
+        uint64_t word;
+        memcpy(&word, bytes + i * sizeof(uint64_t), sizeof(uint64_t));
+        hash = (hash ^ word) * CHECKSUM_PRIME;
+        hash ^= hash >> 29;
+    }
+
+    uint64_t tail = 0;
+    memcpy(&tail, bytes + numWords * sizeof(uint64_t), numBytes % sizeof(uint64_t));
+    hash = (hash ^ tail) * CHECKSUM_PRIME;
+    return hash ^ (hash >> 32);
+}
+
+// The stream checksum skips the weight sections it contains; they carry their own.
+uint64_t BinUtils::streamChecksum(const uint8_t *data, const vector<Section> &sections) {
+    uint64_t hash = CHECKSUM_SEED;
+    uint64_t pos = sections[0].offset;
+    for (size_t i = 1; i < sections.size(); i++) {
+        hash = checksum(data + pos, sections[i].offset - pos, hash);
+        pos = sections[i].offset + sections[i].size;
+    }
+
+    return checksum(data + pos, sections[0].offset + sections[0].size - pos, hash);
+}
+
+bool BinUtils::isWritingContainer() {
+    return isWritingSections;
+}
+
+// Only container saves compress weights; checkpoints always keep them exact.
+BinUtils::WeightFormats BinUtils::getWeightFormat() {
+    return isWritingSections ? writeFormat : FP32;
+}
+
+// Checking every weight section reads the whole file once at load. Servers that trust their
+// model files can skip it; the model description is always checked.
+void BinUtils::setVerifyChecksums(bool shouldVerify) {
+    verifyChecksums = shouldVerify;
+}
+
+// Inside a container the array goes to its own 64-byte aligned section; elsewhere, such as the
+// best-weights checkpoints, it follows inline.
+void BinUtils::writeArray(ofstream &modelBin, const void *values, size_t numBytes, uint32_t kind) {
+    if (!isWritingSections) {
+        modelBin.write((char*) &INLINE_ARRAY, sizeof(uint32_t));
+        modelBin.write((char*) values, numBytes);
+        return;
+    }
+
+    uint32_t sectionIdx = (uint32_t) writeSections.size();
+    modelBin.write((char*) &SECTION_ARRAY, sizeof(uint32_t));
+    modelBin.write((char*) &sectionIdx, sizeof(uint32_t));
+    writePadding(modelBin);
+
+    Section section = {
+        kind, 0, (uint64_t) modelBin.tellp(), numBytes,
+        checksum((const uint8_t*) values, numBytes, CHECKSUM_SEED)
+    };
+    writeSections.push_back(section);
+    modelBin.write((char*) values, numBytes);
+}
+
+void BinUtils::writeFloats(ofstream &modelBin, const float *values, size_t count) {
+    writeArray(modelBin, values, count * sizeof(float), FLOAT_SECTION);
+}
+
+void BinUtils::writeBytes(ofstream &modelBin, const int8_t *values, size_t count) {
+    writeArray(modelBin, values, count, BYTE_SECTION);
+}
+
+// Returns the mapped payload of a section-stored array and skips past it, or nullptr when the
+// array follows inline.
+const uint8_t* BinUtils::readSection(ifstream &modelBin, size_t numBytes, uint32_t kind) {
+    if (readRevision < 5)
+        return nullptr;
+
+    uint32_t storage;
+    modelBin.read((char*) &storage, sizeof(uint32_t));
+    if (storage == INLINE_ARRAY)
+        return nullptr;
+
+    uint32_t sectionIdx;
+    modelBin.read((char*) &sectionIdx, sizeof(uint32_t));
+
+    if (storage != SECTION_ARRAY || readMapping == nullptr || sectionIdx == 0 ||
+        sectionIdx >= readSections.size() || readSections[sectionIdx].kind != kind ||
+        readSections[sectionIdx].size != numBytes) {
+        ConsoleUtils::fatalError("Model file has an invalid weight section. The file may be corrupted.");
+    }
+
+    const Section &section = readSections[sectionIdx];
+    modelBin.seekg(section.offset + section.size);
+    return readMapping->getData() + section.offset;
+}
+
+void BinUtils::readFloats(ifstream &modelBin, float *values, size_t count) {
+    const uint8_t *mapped = readSection(modelBin, count * sizeof(float), FLOAT_SECTION);
+    if (mapped == nullptr) {
+        modelBin.read((char*) values, count * sizeof(float));
+    } else {
+        memcpy(values, mapped, count * sizeof(float));
+    }
+}
+
+// Returns a read-only view into the mapped file when the array has its own section, keeping the
+// mapping alive through the last argument. Inline arrays are read into storage instead.
+const float* BinUtils::readFloats(
+    ifstream &modelBin,
+    vector<float> &storage,
+    size_t count,
+    shared_ptr<const MappedFile> &mapping
+) {
+    const uint8_t *mapped = readSection(modelBin, count * sizeof(float), FLOAT_SECTION);
+    if (mapped != nullptr) {
+        mapping = readMapping;
+        vector<float>().swap(storage);
+        return (const float*) mapped;
+    }
+
+    mapping.reset();
+    storage.resize(count);
+    modelBin.read((char*) storage.data(), count * sizeof(float));
+    return storage.data();
+}
+
+const int8_t* BinUtils::readBytes(
+    ifstream &modelBin,
+    vector<int8_t> &storage,
+    size_t count,
+    shared_ptr<const MappedFile> &mapping
+) {
+    const uint8_t *mapped = readSection(modelBin, count, BYTE_SECTION);
+    if (mapped != nullptr) {
+        mapping = readMapping;
+        vector<int8_t>().swap(storage);
+        return (const int8_t*) mapped;
+    }
+
+    mapping.reset();
+    storage.resize(count);
+    modelBin.read((char*) storage.data(), count);
+    return storage.data();
+}
+
 string BinUtils::addExtension(const string &modelName) {
     size_t extLength = MODEL_EXTENSION.length();
     size_t nameLength = modelName.length();
@@ -194,6 +552,7 @@ string BinUtils::addExtension(const string &modelName) {
 }
 
 void BinUtils::saveBestWeights(const string &path, const NeuralNet &nn) {
+    lock_guard<mutex> lock(fileMutex);
     ofstream modelBin(path, ios::out | ios::binary);
     if (!modelBin) {
         ConsoleUtils::printError(
@@ -212,6 +571,7 @@ void BinUtils::saveBestWeights(const string &path, const NeuralNet &nn) {
 }
 
 void BinUtils::loadBestWeights(const string &path, NeuralNet &nn) {
+    lock_guard<mutex> lock(fileMutex);
     ifstream modelBin(path, ios::in | ios::binary);
     if (!modelBin) {
         ConsoleUtils::printError(
@@ -0,0 +1,397 @@
+#include "utils/BulkScorer.h"
+#include "utils/SlotQueue.h"
+#include "utils/CsvUtils.h"
+#include "utils/ConsoleUtils.h"
+#include "utils/TrainingUtils.h"
+#include "core/model/Pipeline.h"
+#include "core/data/TabularData.h"
+#include "core/tensor/PanelMatrix.h"
+#include <thread>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <omp.h>
+
+const char BulkScorer::DELIMITER = ',';
+const string BulkScorer::PREDICTION_COL = "prediction";
+
+BulkScorer::BulkScorer(
+    Pipeline &pipeline, 
+    size_t chunkRows, 
+    size_t numChunks, 
+    size_t parseThreads
+) :
+    pipeline(pipeline),
+    data(nullptr),
+    chunkRows(chunkRows),
+    numChunks(numChunks),
+    parseThreads(0),
+    inferThreads(0),
+    numFileCols(0),
+    numFields(0),
+    recordWidth(0),
+    outputSize(0),
+    isSparse(false)
+{
+    if (chunkRows == 0 || numChunks == 0) {
+        ConsoleUtils::fatalError("Bulk scoring requires at least one chunk of at least one row.");
+    }
+
+    splitThreads(parseThreads);
+}
+
+// Parsing and inference run at the same time, so they share omp_get_max_threads() instead of
+// each spawning a full team. A parse budget of 0 gives each stage half.
+void BulkScorer::splitThreads(size_t requested) {
+    size_t maxThreads = omp_get_max_threads();
+    if (requested >= maxThreads && maxThreads > 1) {
+        ConsoleUtils::fatalError(
+            "Bulk scoring needs at least one inference thread, but " + to_string(requested) + 
+            " of " + to_string(maxThreads) + " threads were given to parsing."
+        );
+    }
+
+    parseThreads = requested > 0 ? requested : max((size_t) 1, maxThreads / 2);
+    inferThreads = max((size_t) 1, maxThreads - min(parseThreads, maxThreads));
+}
+
+void BulkScorer::prepare() {
+    data = dynamic_cast<TabularData*>(pipeline.getData());
+    if (data == nullptr) {
+        ConsoleUtils::fatalError("Bulk scoring requires a pipeline with tabular data.");
+    }
+
+    pipeline.prepareInference(chunkRows);
+    numFields = data->getNumFeatureFields();
+    recordWidth = data->getRecordWidth();
+    outputSize = pipeline.getOutputSize();
+    isSparse = data->getFeatureFormat() == TabularData::Sparse;
+
+    labelNames.clear();
+    if (data->isClassification()) {
+        labelNames = data->getLabelNames();
+    }
+}
+
+// Locates each training feature column in the input header so column order may differ.
+void BulkScorer::mapColumns(const string &headerLine, const string &targetCol) {
+    const vector<string> &trainHeader = data->getHeader();
+    if (trainHeader.empty()) {
+        ConsoleUtils::fatalError(
+            "Bulk scoring requires a pipeline trained from a CSV with a header."
+        );
+    }
+
+    vector<string> fileHeader;
+    size_t start = 0;
+    size_t end;
+    do {
+        end = headerLine.find(DELIMITER, start);
+        string colName = headerLine.substr(start, end == string::npos ? string::npos : end - start);
+        fileHeader.push_back(CsvUtils::toLowerCase(CsvUtils::trim(colName)));
+        start = end + 1;
+    } while (end != string::npos);
+
+    string cleanTarget = CsvUtils::toLowerCase(CsvUtils::trim(targetCol));
+    fieldCols.clear();
+    for (const string &colName : trainHeader) {
+        if (colName == cleanTarget) {
+            continue;
+        }
+
+        size_t fileCol = find(fileHeader.begin(), fileHeader.end(), colName) - fileHeader.begin();
+        if (fileCol == fileHeader.size()) {
+            ConsoleUtils::fatalError("Feature column \"" + colName + "\" not found in the input header.");
+        }
+        fieldCols.push_back(fileCol);
+    }
+
+    if (fieldCols.size() != numFields) {
+        ConsoleUtils::fatalError(
+            "Expected " + to_string(numFields) + " feature columns but found " + 
+            to_string(fieldCols.size()) + ".\n"
+            "Please pass the target column used during training."
+        );
+    }
+
+    numFileCols = fileHeader.size();
+}
+
+void BulkScorer::prepareChunks() {
+    chunks.resize(numChunks);
+    for (Chunk &chunk : chunks) {
+        chunk.numRows = 0;
+        chunk.firstRecord = 0;
+        chunk.lines.resize(chunkRows);
+        chunk.rawFields.resize(chunkRows * numFileCols);
+        chunk.fields.resize(chunkRows * numFields);
+        chunk.output.resize(chunkRows * outputSize);
+
+        if (isSparse) {
+            chunk.sparseCols.resize(chunkRows * numFields);
+            chunk.sparseValues.resize(chunkRows * numFields);
+            chunk.rowNnz.resize(chunkRows);
+            chunk.sparseInput = CsrTensor(0, recordWidth);
+            chunk.sparseInput.reserve(chunkRows, chunkRows * numFields);
+        } else {
+            chunk.inputShape = {chunkRows, recordWidth};
+            chunk.input = Tensor(chunk.inputShape);
+        }
+    }
+}
+
+size_t BulkScorer::score(const string &inPath, const string &outPath, const string &targetCol) {
+    CsvUtils::checkFile(inPath);
+    prepare();
+
+    ifstream inFile(inPath);
+    string headerLine;
+    getline(inFile, headerLine);
+    mapColumns(headerLine, targetCol);
+
+    ofstream outFile(outPath);
+    if (!outFile) {
+        ConsoleUtils::fatalError(
+            "Unable to open file \"" + outPath + "\" for writing.\n" +
+            "Reason: " + strerror(errno) + "."
+        );
+    }
+
+    prepareChunks();
+    parseError.clear();
+    SlotQueue freeSlots(numChunks);
+    SlotQueue parsedSlots(numChunks);
+    SlotQueue scoredSlots(numChunks);
+    for (size_t i = 0; i < numChunks; i++) {
+        freeSlots.push(i);
+    }
+
+    ConsoleUtils::loadMessage("Scoring Rows.");
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+    size_t gemvThreads = PanelMatrix::getNumThreads();
+    PanelMatrix::setNumThreads(inferThreads);
+
+    thread parser(&BulkScorer::parseStage, this, ref(inFile), ref(freeSlots), ref(parsedSlots));
+    thread inferer(&BulkScorer::inferStage, this, ref(parsedSlots), ref(scoredSlots));
+    size_t numRows = writeStage(outFile, scoredSlots, freeSlots);
+    parser.join();
+    inferer.join();
+    outFile.close();
+    PanelMatrix::setNumThreads(gemvThreads);
+
+    // Reported once every stage has joined, so no worker is still running at exit.
+    if (!parseError.empty()) {
+        ConsoleUtils::fatalError(parseError);
+    }
+
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    ConsoleUtils::completeMessage();
+    printf(
+        "Scored %zu rows in %.2fs (%.0f rows/s).\n", 
+        numRows, seconds, seconds > 0 ? numRows / seconds : 0.0
+    );
+
+    return numRows;
+}
+
+bool BulkScorer::splitLine(const string &line, string_view *rawFields) const {
+    size_t lineLen = line.size();
+    if (lineLen > 0 && line[lineLen - 1] == '\r') {
+        lineLen--;
+    }
+
+    string_view lineView(line.data(), lineLen);
+    size_t col = 0;
+    size_t start = 0;
+    while (col < numFileCols) {
+        size_t end = lineView.find(DELIMITER, start);
+        if (end == string_view::npos) {
+            rawFields[col++] = lineView.substr(start);
+            break;
+        }
+
+        rawFields[col++] = lineView.substr(start, end - start);
+        start = end + 1;
+    }
+
+    return col == numFileCols && lineView.find(DELIMITER, start) == string_view::npos;
+}
+
+string BulkScorer::describeInvalidRecord(const Chunk &chunk, size_t row) const {
+    const string &line = chunk.lines[row];
+    vector<string_view> rawFields(numFileCols);
+    string reason = splitLine(line, rawFields.data()) ? 
+        "has an invalid numeric field" : 
+        "does not have " + to_string(numFileCols) + " fields";
+
+    return "Record " + to_string(chunk.firstRecord + row + 1) + " " + reason + ".\n"
+        "Line: \"" + line + "\"";
+}
+
+bool BulkScorer::encodeRow(Chunk &chunk, size_t row, float *inputFlat) const {
+    string_view *rawFields = chunk.rawFields.data() + row * numFileCols;
+    string_view *fields = chunk.fields.data() + row * numFields;
+    if (!splitLine(chunk.lines[row], rawFields))
+        return false;
+
+    for (size_t j = 0; j < numFields; j++) {
+        fields[j] = rawFields[fieldCols[j]];
+    }
+
+    if (isSparse) {
+        size_t offset = row * numFields;
+        return pipeline.tryEncodeRecord(
+            fields, chunk.sparseCols.data() + offset, 
+            chunk.sparseValues.data() + offset, chunk.rowNnz[row]
+        );
+    }
+
+    return pipeline.tryEncodeRecord(fields, inputFlat + row * recordWidth);
+}
+
+// Rows are split and encoded in parallel. Sparse rows are encoded into fixed slots of numFields
+// entries and then packed into the chunk's CSR input. Workers never exit the process: the first
+// invalid record is described in error once the loop is done.
+bool BulkScorer::encodeChunk(Chunk &chunk, string &error) const {
+    size_t numRows = chunk.numRows;
+    float *inputFlat = nullptr;
+    if (!isSparse) {
+        chunk.inputShape[0] = numRows;
+        chunk.input.reShapeInPlace(chunk.inputShape);
+        inputFlat = chunk.input.getFlat().data();
+    }
+
+    size_t invalidRow = numRows;
+
+    #pragma omp parallel for num_threads(parseThreads) if(parseThreads > 1) reduction(min:invalidRow)
+    for (size_t i = 0; i < numRows; i++) {
+        if (!encodeRow(chunk, i, inputFlat)) {
+            invalidRow = min(invalidRow, i);
+        }
+    }
+
+    if (invalidRow < numRows) {
+        error = describeInvalidRecord(chunk, invalidRow);
+        return false;
+    }
+
+    if (isSparse) {
+        gatherSparse(chunk);
+    }
+    return true;
+}
+
+void BulkScorer::gatherSparse(Chunk &chunk) const {
+    CsrTensor &sparseInput = chunk.sparseInput;
+    sparseInput.clearRows();
+
+    for (size_t i = 0; i < chunk.numRows; i++) {
+        const uint32_t *cols = chunk.sparseCols.data() + i * numFields;
+        const float *values = chunk.sparseValues.data() + i * numFields;
+        for (size_t k = 0; k < chunk.rowNnz[i]; k++) {
+            sparseInput.appendEntry(cols[k], values[k]);
+        }
+        sparseInput.finishRow();
+    }
+}
+
+void BulkScorer::formatChunk(const Chunk &chunk, string &text) const {
+    char buffer[32];
+    text.clear();
+
+    for (size_t i = 0; i < chunk.numRows; i++) {
+        if (!labelNames.empty()) {
+            size_t label = TrainingUtils::getPrediction(chunk.output, i, outputSize);
+            text += labelNames[label];
+        } else {
+            for (size_t j = 0; j < outputSize; j++) {
+                if (j > 0) {
+                    text += DELIMITER;
+                }
+                int len = snprintf(buffer, sizeof(buffer), "%.7g", chunk.output[i * outputSize + j]);
+                text.append(buffer, len);
+            }
+        }
+        text += '\n';
+    }
+}
+
+void BulkScorer::parseStage(ifstream &inFile, SlotQueue &freeSlots, SlotQueue &parsedSlots) {
+    size_t numRecords = 0;
+    size_t slot;
+    bool isDone = false;
+
+    while (!isDone && freeSlots.pop(slot)) {
+        Chunk &chunk = chunks[slot];
+        size_t numRows = 0;
+        while (numRows < chunkRows && getline(inFile, chunk.lines[numRows])) {
+            numRows++;
+        }
+
+        isDone = numRows < chunkRows;
+        if (numRows == 0) {
+            break;
+        }
+
+        chunk.numRows = numRows;
+        chunk.firstRecord = numRecords;
+        if (!encodeChunk(chunk, parseError))
+            break;
+
+        numRecords += numRows;
+        parsedSlots.push(slot);
+    }
+
+    parsedSlots.close();
+}
+
+void BulkScorer::inferStage(SlotQueue &parsedSlots, SlotQueue &scoredSlots) {
+    // Only affects parallel regions opened from this thread.
+    omp_set_num_threads((int) inferThreads);
+
+    size_t slot;
+    while (parsedSlots.pop(slot)) {
+        Chunk &chunk = chunks[slot];
+        if (isSparse) {
+            pipeline.predictEncoded(chunk.sparseInput, chunk.output.data());
+        } else {
+            pipeline.predictEncoded(chunk.input, chunk.output.data());
+        }
+        scoredSlots.push(slot);
+    }
+
+    scoredSlots.close();
+}
+
+// Chunks pass through each stage in FIFO order, so output rows match input order.
+size_t BulkScorer::writeStage(ofstream &outFile, SlotQueue &scoredSlots, SlotQueue &freeSlots) {
+    string text;
+    size_t numRows = 0;
+
+    if (labelNames.empty() && outputSize > 1) {
+        for (size_t j = 0; j < outputSize; j++) {
+            text += (j > 0 ? string(1, DELIMITER) : "") + PREDICTION_COL + "_" + to_string(j);
+        }
+        text += '\n';
+    } else {
+        text = PREDICTION_COL + "\n";
+    }
+    outFile.write(text.data(), text.size());
+
+    size_t slot;
+    while (scoredSlots.pop(slot)) {
+        const Chunk &chunk = chunks[slot];
+        formatChunk(chunk, text);
+        outFile.write(text.data(), text.size());
+        numRows += chunk.numRows;
+        freeSlots.push(slot);
+    }
+
+    if (!outFile) {
+        ConsoleUtils::fatalError("Failed while writing predictions.");
+    }
+
+    return numRows;
+}
\ No newline at end of file
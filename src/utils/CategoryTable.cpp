@@ -0,0 +1,234 @@
+#include "utils/CategoryTable.h"
+#include "utils/ConsoleUtils.h"
+#include <algorithm>
+#include <cstring>
+
+const uint32_t CategoryTable::EMPTY_SLOT = 0xFFFFFFFFu;
+const uint64_t CategoryTable::HASH_SEED = 14695981039346656037ull;
+const uint64_t CategoryTable::HASH_PRIME = 0xFF51AFD7ED558CCDull;
+const uint64_t CategoryTable::LOW_BITS = 0x7F7F7F7F7F7F7F7Full;
+const uint64_t CategoryTable::HIGH_BITS = 0x8080808080808080ull;
+const uint64_t CategoryTable::SEED_MIX = 0x9E3779B97F4A7C15ull;
+const uint32_t CategoryTable::MAX_SEED = 1u << 20;
+const size_t CategoryTable::KEYS_PER_BUCKET = 4;
+
+CategoryTable::CategoryTable() {}
+
+// Keys are stored lowercased in id order, so the id of a key is its index in the arena.
+CategoryTable::CategoryTable(const unordered_map<string, float> &encoding) {
+    size_t numKeys = encoding.size();
+    vector<const string*> ordered(numKeys, nullptr);
+    for (const pair<const string, float> &entry : encoding) {
+        size_t id = (size_t) entry.second;
+        if (id >= numKeys || ordered[id] != nullptr) {
+            ConsoleUtils::fatalError("Category encoding ids must be unique and contiguous.");
+        }
+        ordered[id] = &entry.first;
+    }
+
+    keyEnds.resize(numKeys);
+    for (size_t i = 0; i < numKeys; i++) {
+        for (char c : *ordered[i]) {
+            keyArena += foldCase(c);
+        }
+        keyEnds[i] = keyArena.size();
+    }
+
+    compile();
+}
+
+char CategoryTable::foldCase(char c) {
+    if (c <= 'Z' && c >= 'A') {
+        return c + ('a' - 'A');
+    }
+
+    return c;
+}
+
+uint64_t CategoryTable::mix(uint64_t hash) {
+    hash ^= hash >> 33;
+    hash *= 0xFF51AFD7ED558CCDull;
+    hash ^= hash >> 33;
+    hash *= 0xC4CEB9FE1A85EC53ull;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+// Lowercases the ASCII letters of eight packed bytes at once.
+uint64_t CategoryTable::foldCase8(uint64_t chunk) {
+    uint64_t low = chunk & LOW_BITS;
+    uint64_t aboveZ = low + (0x7F - 'Z') * (LOW_BITS / 0x7F);
+    uint64_t atLeastA = low + (0x80 - 'A') * (LOW_BITS / 0x7F);
+    uint64_t upper = ~chunk & (atLeastA ^ aboveZ) & HIGH_BITS;
+    return chunk | (upper >> 2);
+}
+
+uint64_t CategoryTable::loadChunk(const char *key, size_t length) {
+    uint64_t chunk = 0;
+    memcpy(&chunk, key, min(length, sizeof(uint64_t)));
+    return foldCase8(chunk);
+}
+
+uint64_t CategoryTable::hashKey(const char *key, size_t length) {
+    uint64_t hash = HASH_SEED ^ length;
+    for (size_t i = 0; i < length; i += sizeof(uint64_t)) {
+        hash = (hash ^ loadChunk(key + i, length - i)) * HASH_PRIME;
+        hash ^= hash >> 29;
+    }
+
+    return mix(hash);
+}
+
+bool CategoryTable::isBlank(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f';
+}
+
+size_t CategoryTable::getBucket(uint64_t hash) const {
+    return fastRange((uint32_t) (hash >> 32), seeds.size());
+}
+
+size_t CategoryTable::getSlot(uint64_t hash, uint32_t seed) const {
+    return fastRange((uint32_t) mix(hash ^ (seed * SEED_MIX)), slots.size());
+}
+
+size_t CategoryTable::fastRange(uint32_t hash, size_t range) {
+    return (size_t) (((uint64_t) hash * (uint64_t) range) >> 32);
+}
+
+// Hash and displace: keys are grouped into buckets by an unseeded hash, then each
+// bucket (largest first) searches for a seed that places all its keys in free slots.
+void CategoryTable::compile() {
+    size_t numKeys = keyEnds.size();
+    size_t numBuckets = max((size_t) 1, (numKeys + KEYS_PER_BUCKET - 1) / KEYS_PER_BUCKET);
+    size_t numSlots = max((size_t) 1, numKeys + numKeys / 4);
+
+    seeds.assign(numBuckets, 0);
+    slots.assign(numSlots, Slot{EMPTY_SLOT, 0, 0});
+
+    vector<uint64_t> hashes(numKeys);
+    vector<vector<uint32_t> > buckets(numBuckets);
+    for (uint32_t id = 0; id < numKeys; id++) {
+        string_view key = getKey(id);
+        hashes[id] = hashKey(key.data(), key.size());
+        buckets[getBucket(hashes[id])].push_back(id);
+    }
+
+    vector<size_t> order(numBuckets);
+    for (size_t b = 0; b < numBuckets; b++) {
+        order[b] = b;
+    }
+    sort(order.begin(), order.end(), [&buckets](size_t a, size_t b) {
+        return buckets[a].size() > buckets[b].size();
+    });
+
+    vector<size_t> placed;
+    for (size_t b : order) {
+        const vector<uint32_t> &bucket = buckets[b];
+        if (bucket.empty())
+            break;
+
+        bool found = false;
+        for (uint32_t seed = 1; seed < MAX_SEED && !found; seed++) {
+            placed.clear();
+            found = true;
+            for (size_t k = 0; k < bucket.size() && found; k++) {
+                size_t slot = getSlot(hashes[bucket[k]], seed);
+                found = slots[slot].id == EMPTY_SLOT && 
+                        std::find(placed.begin(), placed.end(), slot) == placed.end();
+                placed.push_back(slot);
+            }
+
+            if (found) {
+                seeds[b] = seed;
+                for (size_t k = 0; k < bucket.size(); k++) {
+                    uint32_t id = bucket[k];
+                    uint32_t start = (id == 0) ? 0 : keyEnds[id - 1];
+                    slots[placed[k]] = Slot{id, start, keyEnds[id] - start};
+                }
+            }
+        }
+
+        if (!found) {
+            ConsoleUtils::fatalError("Failed to build category table: duplicate categories.");
+        }
+    }
+}
+
+bool CategoryTable::equalsKey(const Slot &slot, const char *key, size_t length) const {
+    if (slot.length != length) {
+        return false;
+    }
+
+    const char *stored = keyArena.data() + slot.start;
+    for (size_t i = 0; i < length; i += sizeof(uint64_t)) {
+        size_t chunkBytes = min(length - i, sizeof(uint64_t));
+        uint64_t storedChunk = 0;
+        memcpy(&storedChunk, stored + i, chunkBytes);
+        if (storedChunk != loadChunk(key + i, chunkBytes)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+size_t CategoryTable::size() const {
+    return keyEnds.size();
+}
+
+bool CategoryTable::find(string_view value, size_t &catIdx) const {
+    if (keyEnds.empty()) {
+        return false;
+    }
+
+    size_t start = 0;
+    size_t end = value.size();
+    while (start < end && isBlank(value[start])) {
+        start++;
+    }
+    while (end > start && isBlank(value[end - 1])) {
+        end--;
+    }
+
+    const char *key = value.data() + start;
+    size_t length = end - start;
+
+    uint64_t hash = hashKey(key, length);
+    uint32_t seed = seeds[getBucket(hash)];
+    if (seed == 0) {
+        return false;
+    }
+
+    const Slot &slot = slots[getSlot(hash, seed)];
+    if (slot.id == EMPTY_SLOT || !equalsKey(slot, key, length)) {
+        return false;
+    }
+
+    catIdx = slot.id;
+    return true;
+}
+
+string_view CategoryTable::getKey(size_t id) const {
+    size_t start = (id == 0) ? 0 : keyEnds[id - 1];
+    return string_view(keyArena.data() + start, keyEnds[id] - start);
+}
+
+void CategoryTable::writeBin(ofstream &modelBin) const {
+    uint32_t numKeys = keyEnds.size();
+    modelBin.write((char*) &numKeys, sizeof(uint32_t));
+    modelBin.write((char*) keyEnds.data(), numKeys * sizeof(uint32_t));
+    modelBin.write(keyArena.data(), keyArena.size());
+}
+
+void CategoryTable::loadFromBin(ifstream &modelBin) {
+    uint32_t numKeys;
+    modelBin.read((char*) &numKeys, sizeof(uint32_t));
+    keyEnds.resize(numKeys);
+    modelBin.read((char*) keyEnds.data(), numKeys * sizeof(uint32_t));
+
+    size_t arenaBytes = (numKeys == 0) ? 0 : keyEnds.back();
+    keyArena = string(arenaBytes, '\0');
+    modelBin.read(keyArena.data(), arenaBytes);
+
+    compile();
+}
\ No newline at end of file
@@ -58,6 +58,12 @@ void ConsoleUtils::printValidationMetrics(ProgressMetric &metric) {
          << defaultfloat << setprecision(6) << endl;
 }
 
+void ConsoleUtils::printGatherBandwidth(float megabytesPerSec) {
+    cout << fixed << setprecision(2) 
+         << "Gather Bandwidth: " << megabytesPerSec << " MB/s"
+         << defaultfloat << setprecision(6) << endl;
+}
+
 void ConsoleUtils::loadMessage(const string &message) {
     currentLoadMessage = message;
     spinnerRunning = true;
@@ -123,7 +129,14 @@ void ConsoleUtils::printError(const string &message) {
     cout << "[" << RED << CROSS << RESET_COLOUR << "] " << message << endl;
 }
 
+// A spinner still running at exit would abort the process, so it is stopped first.
 void ConsoleUtils::fatalError(const string &message) {
+    spinnerRunning = false;
+    if (spinnerThread.joinable()) {
+        spinnerThread.join();
+        cout << endl;
+    }
+
     cerr << "Fatal Error: " << message << " Exiting." << endl;
     exit(1);
 }
\ No newline at end of file
@@ -11,35 +11,39 @@ float DataSplitter::clampRatio(float ratio) {
     return min(max(ratio, 0.0f), 0.999999f);
 }
 
-Split DataSplitter::prepareSplit(
-    size_t sampleFloats,
-    size_t nTrain,
-    size_t nVal,
-    const Tensor& x
+IndexSplit DataSplitter::makeSplit(
+    const SampleView &x,
+    const vector<float> &y,
+    vector<size_t> &trainIndices,
+    vector<size_t> &valIndices
 ) {
-    Split split;
-    size_t trainFloats = sampleFloats * nTrain;
-    size_t valFloats = sampleFloats * nVal;
+    sort(trainIndices.begin(), trainIndices.end());
+    sort(valIndices.begin(), valIndices.end());
 
-    vector<size_t> xTrainShape = x.getShape();
-    vector<size_t> xValShape = x.getShape();
+    IndexSplit split;
+    split.xTrain = SampleView(x, trainIndices);
+    split.xVal = SampleView(x, valIndices);
 
-    xTrainShape[0] = nTrain;
-    xValShape[0] = nVal;
+    size_t nTrain = trainIndices.size();
+    size_t nVal = valIndices.size();
+    split.yTrain.resize(nTrain);
+    split.yVal.resize(nVal);
 
-    split.xTrain.reShapeInPlace(xTrainShape);
-    split.xVal.reShapeInPlace(xValShape);
+    #pragma omp parallel for
+    for (size_t i = 0; i < nTrain; i++) {
+        split.yTrain[i] = y[trainIndices[i]];
+    }
 
-    split.xTrain.getFlat().reserve(trainFloats);
-    split.xVal.getFlat().reserve(valFloats);
-    split.yTrain.reserve(nTrain);
-    split.yVal.reserve(nVal);
+    #pragma omp parallel for
+    for (size_t i = 0; i < nVal; i++) {
+        split.yVal[i] = y[valIndices[i]];
+    }
 
     return split;
 }
 
-Split DataSplitter::stratifiedSplit(
-    const Tensor &x,
+IndexSplit DataSplitter::stratifiedIndexSplit(
+    const SampleView &x,
     const vector<float> &y,
     float valRatio
 ) {
@@ -47,10 +51,6 @@ Split DataSplitter::stratifiedSplit(
     unordered_map<size_t, vector<size_t>> indicesMap;
 
     size_t size = y.size();
-
-    const vector<float> &xFlat = x.getFlat();
-    size_t sampleFloats = x.getSize() / x.getShape()[0];
-
     for (size_t i = 0; i < size; i++) {
         size_t label = (size_t) y[i];
         indicesMap[label].push_back(i);
@@ -72,53 +72,37 @@ Split DataSplitter::stratifiedSplit(
          << nTrain << " | " << nVal << endl;
     ConsoleUtils::loadMessage("Splitting data with stratification.");
 
-    Split split = prepareSplit(sampleFloats, nTrain, nVal, x);
-
-    vector<float> &xTrain = split.xTrain.getFlat();
-    vector<float> &xVal = split.xVal.getFlat();
-    vector<float> &yTrain = split.yTrain;
-    vector<float> &yVal = split.yVal;
+    vector<size_t> trainIndices;
+    vector<size_t> valIndices;
+    trainIndices.reserve(nTrain);
+    valIndices.reserve(nVal);
 
     for (pair<const size_t, vector<size_t>> &keyVal : indicesMap) {
         vector<size_t> &indices = keyVal.second;
 
         shuffle(indices.begin(), indices.end(), gen);
 
-        size_t numIndices = indices.size();
-        size_t valIndicesEnd = (size_t)(valRatio * numIndices);
-
-        for (size_t i = 0; i < valIndicesEnd; i++) {
-            size_t idx = indices[i] * sampleFloats;
-            xVal.insert(xVal.end(), xFlat.begin() + idx, xFlat.begin() + idx + sampleFloats);
-            yVal.push_back(y[indices[i]]);
-        }
-
-        for (size_t i = valIndicesEnd; i < numIndices; i++) {
-            size_t idx = indices[i] * sampleFloats;
-            xTrain.insert(xTrain.end(), xFlat.begin() + idx, xFlat.begin() + idx + sampleFloats);
-            yTrain.push_back(y[indices[i]]);
-        }
+        size_t valIndicesEnd = (size_t)(valRatio * indices.size());
+        valIndices.insert(valIndices.end(), indices.begin(), indices.begin() + valIndicesEnd);
+        trainIndices.insert(trainIndices.end(), indices.begin() + valIndicesEnd, indices.end());
     }
 
+    IndexSplit split = makeSplit(x, y, trainIndices, valIndices);
+
     ConsoleUtils::completeMessage();
     ConsoleUtils::printSepLine();
     
     return split;
 }
 
-Split DataSplitter::randomSplit(
-    const Tensor &x,
+IndexSplit DataSplitter::randomIndexSplit(
+    const SampleView &x,
     const vector <float> &y,
     float valRatio
 ) {
-    
-
     valRatio = clampRatio(valRatio);
     size_t size = y.size();
 
-    const vector<float> &xFlat = x.getFlat();
-    size_t sampleFloats = x.getSize() / x.getShape()[0];
-
     size_t nVal = (size_t) (valRatio * size);
     size_t nTrain = size - nVal;
 
@@ -133,31 +117,48 @@ Split DataSplitter::randomSplit(
     std::iota(indices.begin(), indices.end(), 0); 
     std::shuffle(indices.begin(), indices.end(), gen);
 
-    Split split = prepareSplit(sampleFloats, nTrain, nVal, x);
+    vector<size_t> valIndices(indices.begin(), indices.begin() + nVal);
+    vector<size_t> trainIndices(indices.begin() + nVal, indices.end());
+    IndexSplit split = makeSplit(x, y, trainIndices, valIndices);
 
-    vector<float> &xTrain = split.xTrain.getFlat();
-    vector<float> &xVal = split.xVal.getFlat();
-    vector<float> &yTrain = split.yTrain;
-    vector<float> &yVal = split.yVal;
+    ConsoleUtils::completeMessage();
+    ConsoleUtils::printSepLine();
 
-    for (size_t i = 0; i < nVal; i++) {
-        size_t idx = indices[i] * sampleFloats;
-        xVal.insert(xVal.end(), xFlat.begin() + idx, xFlat.begin() + idx + sampleFloats);
-        yVal.push_back(y[indices[i]]);
-    }
+    return split;
+}
 
-    for (size_t i = nVal; i < size; i++) {
-        size_t idx = indices[i] * sampleFloats;
-        xTrain.insert(xTrain.end(), xFlat.begin() + idx, xFlat.begin() + idx + sampleFloats);
-        yTrain.push_back(y[indices[i]]);
-    }
+Split DataSplitter::stratifiedSplit(
+    const Tensor &x,
+    const vector<float> &y,
+    float valRatio
+) {
+    return stratifiedIndexSplit(x, y, valRatio).materialize();
+}
 
-    ConsoleUtils::completeMessage();
-    ConsoleUtils::printSepLine();
+Split DataSplitter::randomSplit(
+    const Tensor &x,
+    const vector<float> &y,
+    float valRatio
+) {
+    return randomIndexSplit(x, y, valRatio).materialize();
+}
 
+Split IndexSplit::materialize() const {
+    Split split;
+    split.xTrain = xTrain.materialize();
+    split.xVal = xVal.materialize();
+    split.yTrain = yTrain;
+    split.yVal = yVal;
     return split;
 }
 
+void IndexSplit::clear() {
+    xTrain = SampleView();
+    xVal = SampleView();
+    vector<float>().swap(yTrain);
+    vector<float>().swap(yVal);
+}
+
 void Split::clear() {
     xTrain.clear();
     xVal.clear();
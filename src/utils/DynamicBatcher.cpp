@@ -0,0 +1,276 @@
+#include "utils/DynamicBatcher.h"
+#include "utils/ConsoleUtils.h"
+#include "core/model/Pipeline.h"
+#include "core/data/TabularData.h"
+#include <iostream>
+
+DynamicBatcher::DynamicBatcher(Pipeline &pipeline, size_t maxBatchSize, size_t maxWaitMicros) :
+    pipeline(pipeline),
+    maxBatchSize(maxBatchSize),
+    maxWait(maxWaitMicros),
+    numFields(0),
+    recordWidth(0),
+    outputSize(0),
+    isSparse(false),
+    isStopping(false),
+    isWaiting(false),
+    numBatches(0),
+    numRequests(0)
+{
+    if (maxBatchSize == 0) {
+        ConsoleUtils::fatalError("Dynamic batching requires a max batch size of at least 1.");
+    }
+
+    TabularData *data = dynamic_cast<TabularData*>(pipeline.getData());
+    if (data == nullptr) {
+        ConsoleUtils::fatalError("Dynamic batching requires a pipeline with tabular data.");
+    }
+
+    pipeline.prepareInference(maxBatchSize);
+    numFields = data->getNumFeatureFields();
+    recordWidth = data->getRecordWidth();
+    outputSize = pipeline.getOutputSize();
+    isSparse = data->getFeatureFormat() == TabularData::Sparse;
+
+    batch.reserve(maxBatchSize);
+    fieldViews.resize(maxBatchSize * numFields);
+    output.resize(maxBatchSize * outputSize);
+    if (isSparse) {
+        sparseInput = CsrTensor(0, recordWidth);
+        sparseInput.reserve(maxBatchSize, maxBatchSize * numFields);
+    } else {
+        inputShape = {maxBatchSize, recordWidth};
+        input = Tensor(inputShape);
+    }
+
+    // The queue always holds one node that has already been consumed.
+    Node *stub = new Node();
+    stub->next.store(nullptr);
+    stub->request = nullptr;
+    head.store(stub);
+    tail = stub;
+
+    worker = thread(&DynamicBatcher::run, this);
+}
+
+// Requests already submitted are still answered before the worker exits.
+DynamicBatcher::~DynamicBatcher() {
+    {
+        lock_guard<mutex> lock(wakeMutex);
+        isStopping.store(true);
+    }
+    wakeUp.notify_one();
+    worker.join();
+
+    delete tail;
+}
+
+// Lock-free multi-producer push: producers only contend on the exchange of head.
+void DynamicBatcher::enqueue(Request *request) {
+    if (isStopping.load()) {
+        ConsoleUtils::fatalError("Cannot submit a request to a stopped batcher.");
+    }
+
+    if (request->fields.size() != numFields) {
+        ConsoleUtils::fatalError(
+            "Expected " + to_string(numFields) + " fields, but got " + 
+            to_string(request->fields.size()) + "."
+        );
+    }
+
+    Node *node = new Node();
+    node->next.store(nullptr, memory_order_relaxed);
+    node->request = request;
+    request->enqueueTime = chrono::steady_clock::now();
+
+    Node *prev = head.exchange(node, memory_order_acq_rel);
+    prev->next.store(node);
+
+    if (isWaiting.load()) {
+        lock_guard<mutex> lock(wakeMutex);
+        wakeUp.notify_one();
+    }
+}
+
+// Single consumer pop. A push that has swapped head but not yet linked its node reads as empty,
+// and that producer wakes the worker once the link is visible.
+DynamicBatcher::Request* DynamicBatcher::dequeue() {
+    Node *next = tail->next.load();
+    if (next == nullptr)
+        return nullptr;
+
+    Request *request = next->request;
+    delete tail;
+    tail = next;
+    return request;
+}
+
+bool DynamicBatcher::hasRequests() const {
+    return tail->next.load() != nullptr;
+}
+
+void DynamicBatcher::waitForRequests(const chrono::steady_clock::time_point *deadline) {
+    unique_lock<mutex> lock(wakeMutex);
+    isWaiting.store(true);
+
+    auto isReady = [this] { return hasRequests() || isStopping.load(); };
+    if (deadline == nullptr) {
+        wakeUp.wait(lock, isReady);
+    } else {
+        wakeUp.wait_until(lock, *deadline, isReady);
+    }
+
+    isWaiting.store(false);
+}
+
+future<vector<float> > DynamicBatcher::submit(vector<string> fields) {
+    Request *request = new Request();
+    request->fields = move(fields);
+    future<vector<float> > result = request->result.get_future();
+
+    enqueue(request);
+    return result;
+}
+
+// The callback runs on the batcher's worker thread, so it should return quickly.
+void DynamicBatcher::submit(vector<string> fields, function<void(vector<float>)> callback) {
+    Request *request = new Request();
+    request->fields = move(fields);
+    request->callback = move(callback);
+
+    enqueue(request);
+}
+
+void DynamicBatcher::run() {
+    while (collectBatch()) {
+        processBatch();
+    }
+}
+
+// Blocks for the first request, then keeps adding requests until the batch is full or the
+// first one has waited maxWait. Returns false once stopped with nothing left to run.
+bool DynamicBatcher::collectBatch() {
+    batch.clear();
+
+    Request *request = dequeue();
+    while (request == nullptr) {
+        if (isStopping.load()) {
+            request = dequeue();
+            if (request == nullptr)
+                return false;
+            break;
+        }
+
+        waitForRequests(nullptr);
+        request = dequeue();
+    }
+    batch.push_back(request);
+
+    chrono::steady_clock::time_point deadline = request->enqueueTime + maxWait;
+    while (batch.size() < maxBatchSize) {
+        request = dequeue();
+        if (request != nullptr) {
+            batch.push_back(request);
+            continue;
+        }
+
+        if (isStopping.load() || chrono::steady_clock::now() >= deadline)
+            break;
+
+        waitForRequests(&deadline);
+    }
+
+    return true;
+}
+
+void DynamicBatcher::encodeBatch() {
+    size_t batchSize = batch.size();
+    for (size_t i = 0; i < batchSize; i++) {
+        const vector<string> &fields = batch[i]->fields;
+        for (size_t j = 0; j < numFields; j++) {
+            fieldViews[i * numFields + j] = fields[j];
+        }
+    }
+
+    if (isSparse) {
+        sparseInput.clearRows();
+        for (size_t i = 0; i < batchSize; i++) {
+            pipeline.encodeRecord(fieldViews.data() + i * numFields, sparseInput);
+        }
+    } else {
+        inputShape[0] = batchSize;
+        input.reShapeInPlace(inputShape);
+
+        float *inputFlat = input.getFlat().data();
+        for (size_t i = 0; i < batchSize; i++) {
+            pipeline.encodeRecord(fieldViews.data() + i * numFields, inputFlat + i * recordWidth);
+        }
+    }
+}
+
+void DynamicBatcher::processBatch() {
+    chrono::steady_clock::time_point computeStart = chrono::steady_clock::now();
+
+    encodeBatch();
+    if (isSparse) {
+        pipeline.predictEncoded(sparseInput, output.data());
+    } else {
+        pipeline.predictEncoded(input, output.data());
+    }
+
+    chrono::steady_clock::time_point computeEnd = chrono::steady_clock::now();
+    recordStats(computeStart, computeEnd);
+
+    size_t batchSize = batch.size();
+    for (size_t i = 0; i < batchSize; i++) {
+        Request *request = batch[i];
+        const float *row = output.data() + i * outputSize;
+        vector<float> result(row, row + outputSize);
+
+        if (request->callback) {
+            request->callback(move(result));
+        } else {
+            request->result.set_value(move(result));
+        }
+        delete request;
+    }
+}
+
+void DynamicBatcher::recordStats(
+    chrono::steady_clock::time_point computeStart,
+    chrono::steady_clock::time_point computeEnd
+) {
+    lock_guard<mutex> lock(statsMutex);
+    double computeMicros = chrono::duration<double, micro>(computeEnd - computeStart).count();
+    computeTimes.record(computeMicros);
+    for (const Request *request : batch) {
+        queueTimes.record(chrono::duration<double, micro>(computeStart - request->enqueueTime).count());
+    }
+
+    numBatches++;
+    numRequests += batch.size();
+}
+
+LatencyHistogram DynamicBatcher::getQueueTimes() const {
+    lock_guard<mutex> lock(statsMutex);
+    return queueTimes;
+}
+
+LatencyHistogram DynamicBatcher::getComputeTimes() const {
+    lock_guard<mutex> lock(statsMutex);
+    return computeTimes;
+}
+
+double DynamicBatcher::getMeanBatchSize() const {
+    lock_guard<mutex> lock(statsMutex);
+    return (numBatches == 0) ? 0.0 : (double) numRequests / numBatches;
+}
+
+void DynamicBatcher::printStats() const {
+    lock_guard<mutex> lock(statsMutex);
+    double meanBatchSize = (numBatches == 0) ? 0.0 : (double) numRequests / numBatches;
+
+    cout << "Batches: " << numBatches << ", mean batch size: " << meanBatchSize << endl;
+    queueTimes.print("Queue time (per request)");
+    computeTimes.print("Compute time (per batch)");
+}
\ No newline at end of file
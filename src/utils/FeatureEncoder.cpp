@@ -1,7 +1,15 @@
 #include <utils/FeatureEncoder.h>
 #include <utils/ConsoleUtils.h>
+#include "utils/CategoryTable.h"
 #include "core/tensor/Tensor.h"
+#include "core/tensor/CsrTensor.h"
 #include <stdexcept>
+#include <cstdlib>
+#include <cstring>
+
+const uint32_t FeatureEncoder::FNV_OFFSET_BASIS = 2166136261u;
+const uint32_t FeatureEncoder::FNV_PRIME = 16777619u;
+const size_t FeatureEncoder::MAX_NUMERIC_CHARS = 63;
 
 bool FeatureEncoder::getValueType(const string &value) {
     try {
@@ -48,26 +56,77 @@ unordered_map<string, float> FeatureEncoder::encodeFeature(
     return encoding;
 }
 
-vector<unordered_map<string, float> > FeatureEncoder::encodeFeatures(
+vector<CategoryTable> FeatureEncoder::encodeFeatures(
     const vector<vector<string> > &featuresRaw,
-    const vector<bool> &isCategorical
+    const vector<bool> &isCategorical,
+    const vector<uint32_t> &hashBuckets
 ) {
     size_t numCols = featuresRaw[0].size();
-    vector<unordered_map<string, float> > encodings(numCols);
+    vector<CategoryTable> encodings(numCols);
 
     #pragma omp parallel for
     for (size_t j = 0; j < numCols; j++)  {
-        if (isCategorical[j]) {
-            encodings[j] = encodeFeature(featuresRaw, j);
+        if (isCategorical[j] && hashBuckets[j] == 0) {
+            encodings[j] = CategoryTable(encodeFeature(featuresRaw, j));
         }
     }
 
     return encodings;
 }
 
+// Trims and lowercases on the fly so raw fields hash like parsed CSV tokens.
+uint32_t FeatureEncoder::hashValue(string_view value) {
+    size_t start = 0;
+    size_t end = value.size();
+    while (start < end && isspace((unsigned char) value[start])) {
+        start++;
+    }
+    while (end > start && isspace((unsigned char) value[end - 1])) {
+        end--;
+    }
+
+    uint32_t hash = FNV_OFFSET_BASIS;
+    for (size_t i = start; i < end; i++) {
+        char c = value[i];
+        if (c <= 'Z' && c >= 'A') {
+            c += 'a' - 'A';
+        }
+        hash ^= (uint8_t) c;
+        hash *= FNV_PRIME;
+    }
+
+    return hash;
+}
+
+size_t FeatureEncoder::getCategoryWidth(
+    const CategoryTable &encoding,
+    uint32_t numBuckets
+) {
+    if (numBuckets > 0) {
+        return numBuckets;
+    }
+
+    return encoding.size();
+}
+
+bool FeatureEncoder::getCategoryIdx(
+    const CategoryTable &encoding,
+    uint32_t numBuckets,
+    string_view value,
+    size_t &catIdx
+) {
+    if (numBuckets > 0) {
+        catIdx = hashValue(value) % numBuckets;
+        return true;
+    }
+
+    return encoding.find(value, catIdx);
+}
+
 vector<size_t> FeatureEncoder::getOffsets(
     const vector<bool> &isCategorical,
-    const vector<unordered_map<string, float> > &encodings,
+    const vector<CategoryTable> &encodings,
+    const vector<uint32_t> &hashBuckets,
     size_t numCols,
     size_t &totalCols
 ) {
@@ -75,7 +134,7 @@ vector<size_t> FeatureEncoder::getOffsets(
     for (size_t i = 0; i < numCols; i++) {
         offsets[i] = totalCols;
         if (isCategorical[i]) {
-            totalCols += encodings[i].size();
+            totalCols += getCategoryWidth(encodings[i], hashBuckets[i]);
         } else {
             totalCols++;
         }
@@ -86,14 +145,15 @@ vector<size_t> FeatureEncoder::getOffsets(
 
 Tensor FeatureEncoder::getFeatures(
     const vector<bool> &isCategorical,
-    const vector<unordered_map<string, float> > &encodings,
+    const vector<CategoryTable> &encodings,
+    const vector<uint32_t> &hashBuckets,
     const vector<vector<string> > &featuresRaw
 ) {
     size_t numRows = featuresRaw.size();
     size_t numCols = featuresRaw[0].size();
 
     size_t totalCols = 0;
-    vector<size_t> offsets = getOffsets(isCategorical, encodings, numCols, totalCols);
+    vector<size_t> offsets = getOffsets(isCategorical, encodings, hashBuckets, numCols, totalCols);
     Tensor features({numRows, totalCols});
     vector<float> &featuresFlat = features.getFlat();
 
@@ -102,9 +162,8 @@ Tensor FeatureEncoder::getFeatures(
         for (size_t j = 0; j < numCols; j++) {
             size_t offset = offsets[j];
             if (isCategorical[j]) {
-                unordered_map<string, float>::const_iterator it = encodings[j].find(featuresRaw[i][j]);
-                if (it != encodings[j].end()) {
-                    size_t catIdx = it->second;
+                size_t catIdx;
+                if (getCategoryIdx(encodings[j], hashBuckets[j], featuresRaw[i][j], catIdx)) {
                     featuresFlat[i * totalCols + offset + catIdx] = 1;
                 }
             } else {
@@ -114,4 +173,244 @@ Tensor FeatureEncoder::getFeatures(
     }
 
     return features;
+}
+
+// Categorical ids come first in column order, followed by the numeric columns.
+// Unseen categories map to the out-of-vocabulary id, which is the encoding size.
+// Hashed columns always land in one of their buckets.
+vector<size_t> FeatureEncoder::getIdOrder(const vector<bool> &isCategorical) {
+    size_t numCols = isCategorical.size();
+    vector<size_t> order;
+    for (size_t j = 0; j < numCols; j++) {
+        if (isCategorical[j]) {
+            order.push_back(j);
+        }
+    }
+    for (size_t j = 0; j < numCols; j++) {
+        if (!isCategorical[j]) {
+            order.push_back(j);
+        }
+    }
+
+    return order;
+}
+
+Tensor FeatureEncoder::getCategoryIds(
+    const vector<bool> &isCategorical,
+    const vector<CategoryTable> &encodings,
+    const vector<uint32_t> &hashBuckets,
+    const vector<vector<string> > &featuresRaw
+) {
+    size_t numRows = featuresRaw.size();
+    size_t numCols = featuresRaw[0].size();
+
+    vector<size_t> order = getIdOrder(isCategorical);
+    Tensor features({numRows, numCols});
+    vector<float> &featuresFlat = features.getFlat();
+
+    #pragma omp parallel for
+    for (size_t i = 0; i < numRows; i++) {
+        for (size_t k = 0; k < numCols; k++) {
+            size_t j = order[k];
+            if (isCategorical[j]) {
+                size_t catIdx;
+                if (!getCategoryIdx(encodings[j], hashBuckets[j], featuresRaw[i][j], catIdx)) {
+                    catIdx = encodings[j].size();
+                }
+                featuresFlat[i * numCols + k] = (float) catIdx;
+            } else {
+                featuresFlat[i * numCols + k] = stod(featuresRaw[i][j]);
+            }
+        }
+    }
+
+    return features;
+}
+
+CsrTensor FeatureEncoder::getSparseFeatures(
+    const vector<bool> &isCategorical,
+    const vector<CategoryTable> &encodings,
+    const vector<uint32_t> &hashBuckets,
+    const vector<vector<string> > &featuresRaw
+) {
+    size_t numRows = featuresRaw.size();
+    size_t numCols = featuresRaw[0].size();
+
+    size_t totalCols = 0;
+    vector<size_t> offsets = getOffsets(isCategorical, encodings, hashBuckets, numCols, totalCols);
+    CsrTensor features(numRows, totalCols);
+    vector<size_t> &rowPtr = features.getRowPtr();
+
+    vector<float> rowVals(numRows * numCols, 0.0f);
+    vector<uint32_t> rowCols(numRows * numCols, 0);
+
+    #pragma omp parallel for
+    for (size_t i = 0; i < numRows; i++) {
+        size_t rowNnz = 0;
+        for (size_t j = 0; j < numCols; j++) {
+            size_t offset = offsets[j];
+            float value = 0.0f;
+            if (isCategorical[j]) {
+                size_t catIdx;
+                if (getCategoryIdx(encodings[j], hashBuckets[j], featuresRaw[i][j], catIdx)) {
+                    offset += catIdx;
+                    value = 1.0f;
+                }
+            } else {
+                value = stod(featuresRaw[i][j]);
+            }
+
+            if (value != 0.0f) {
+                rowCols[i * numCols + rowNnz] = offset;
+                rowVals[i * numCols + rowNnz] = value;
+                rowNnz++;
+            }
+        }
+        rowPtr[i + 1] = rowNnz;
+    }
+
+    for (size_t i = 0; i < numRows; i++) {
+        rowPtr[i + 1] += rowPtr[i];
+    }
+
+    vector<uint32_t> &colIdx = features.getColIdx();
+    vector<float> &values = features.getValues();
+    colIdx.resize(rowPtr[numRows]);
+    values.resize(rowPtr[numRows]);
+
+    #pragma omp parallel for
+    for (size_t i = 0; i < numRows; i++) {
+        size_t rowNnz = rowPtr[i + 1] - rowPtr[i];
+        for (size_t k = 0; k < rowNnz; k++) {
+            colIdx[rowPtr[i] + k] = rowCols[i * numCols + k];
+            values[rowPtr[i] + k] = rowVals[i * numCols + k];
+        }
+    }
+
+    return features;
+}
+
+// Parses through a stack buffer so that record scoring never allocates. Returns false instead of
+// exiting so that callers parsing records in parallel can report the error afterwards.
+bool FeatureEncoder::tryParseNumeric(string_view field, float &value) {
+    if (field.size() > MAX_NUMERIC_CHARS)
+        return false;
+
+    char buffer[MAX_NUMERIC_CHARS + 1];
+    memcpy(buffer, field.data(), field.size());
+    buffer[field.size()] = '\0';
+
+    char *end;
+    double parsed = strtod(buffer, &end);
+    while (*end == ' ' || *end == '\t' || *end == '\r' || *end == '\n') {
+        end++;
+    }
+
+    if (end == buffer || *end != '\0')
+        return false;
+
+    value = (float) parsed;
+    return true;
+}
+
+float FeatureEncoder::parseNumeric(string_view field) {
+    if (field.size() > MAX_NUMERIC_CHARS) {
+        ConsoleUtils::fatalError("Numeric field \"" + string(field) + "\" is too long.");
+    }
+
+    float value;
+    if (!tryParseNumeric(field, value)) {
+        ConsoleUtils::fatalError("Invalid numeric field \"" + string(field) + "\".");
+    }
+
+    return value;
+}
+
+// Record encoders return false on an invalid numeric field.
+bool FeatureEncoder::encodeRecord(
+    const vector<bool> &isCategorical,
+    const vector<CategoryTable> &encodings,
+    const vector<uint32_t> &hashBuckets,
+    const vector<size_t> &offsets,
+    size_t totalCols,
+    const string_view *fields,
+    float *dst
+) {
+    size_t numCols = isCategorical.size();
+    memset(dst, 0, totalCols * sizeof(float));
+
+    for (size_t j = 0; j < numCols; j++) {
+        if (isCategorical[j]) {
+            size_t catIdx;
+            if (getCategoryIdx(encodings[j], hashBuckets[j], fields[j], catIdx)) {
+                dst[offsets[j] + catIdx] = 1;
+            }
+        } else if (!tryParseNumeric(fields[j], dst[offsets[j]])) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool FeatureEncoder::encodeRecordIds(
+    const vector<bool> &isCategorical,
+    const vector<CategoryTable> &encodings,
+    const vector<uint32_t> &hashBuckets,
+    const vector<size_t> &order,
+    const string_view *fields,
+    float *dst
+) {
+    size_t numCols = order.size();
+    for (size_t k = 0; k < numCols; k++) {
+        size_t j = order[k];
+        if (isCategorical[j]) {
+            size_t catIdx;
+            if (!getCategoryIdx(encodings[j], hashBuckets[j], fields[j], catIdx)) {
+                catIdx = encodings[j].size();
+            }
+            dst[k] = (float) catIdx;
+        } else if (!tryParseNumeric(fields[j], dst[k])) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Writes the nonzero entries of one record, at most one per field, into cols and values.
+bool FeatureEncoder::encodeRecordSparse(
+    const vector<bool> &isCategorical,
+    const vector<CategoryTable> &encodings,
+    const vector<uint32_t> &hashBuckets,
+    const vector<size_t> &offsets,
+    const string_view *fields,
+    uint32_t *cols,
+    float *values,
+    size_t &nnz
+) {
+    size_t numCols = isCategorical.size();
+    nnz = 0;
+    for (size_t j = 0; j < numCols; j++) {
+        if (isCategorical[j]) {
+            size_t catIdx;
+            if (getCategoryIdx(encodings[j], hashBuckets[j], fields[j], catIdx)) {
+                cols[nnz] = offsets[j] + catIdx;
+                values[nnz] = 1.0f;
+                nnz++;
+            }
+        } else {
+            float value;
+            if (!tryParseNumeric(fields[j], value))
+                return false;
+
+            if (value != 0.0f) {
+                cols[nnz] = offsets[j];
+                values[nnz] = value;
+                nnz++;
+            }
+        }
+    }
+
+    return true;
 }
\ No newline at end of file
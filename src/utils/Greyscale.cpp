@@ -6,21 +6,16 @@
 
 const float Greyscale::MAX_GREYSCALE_VALUE = 255.0;
 
-Tensor Greyscale::transform(const Tensor &data) const {
+void Greyscale::transformInPlace(Tensor &data) const {
     checkFitted();
 
-    Tensor transformed(data.getShape());
-    vector<float> &transformedFlat = transformed.getFlat();
-
     size_t size = data.getSize();
-    const vector<float> &dataFlat = data.getFlat();
+    float *dataFlat = data.getFlat().data();
 
-    #pragma omp parallel for
+    #pragma omp parallel for simd
     for (size_t i = 0; i < size; i++) {
-      transformedFlat[i] = (dataFlat[i] / MAX_GREYSCALE_VALUE);
+        dataFlat[i] = (dataFlat[i] / MAX_GREYSCALE_VALUE);
     }
-
-    return transformed;
 }
 
 Tensor Greyscale::reverseTransform(const Tensor &data) const {
@@ -51,6 +46,14 @@ void Greyscale::fit(const vector<float> &data) {
     throwDataFormatError();
 }
 
+void Greyscale::partialFit(const vector<float> &data) {
+    throwDataFormatError();
+}
+
+void Greyscale::transformInPlace(vector<float> &data) const {
+    throwDataFormatError();
+}
+
 vector<float> Greyscale::transform(const vector<float> &data) const {
     throwDataFormatError();
     return {};
@@ -61,6 +64,13 @@ vector<float> Greyscale::reverseTransform(const vector<float> &data) const {
     return {};
 }
 
+bool Greyscale::getAffine(vector<float> &scale, vector<float> &shift) const {
+    checkFitted();
+    scale.assign(1, 1.0f / MAX_GREYSCALE_VALUE);
+    shift.assign(1, 0.0f);
+    return true;
+}
+
 uint32_t Greyscale::getEncoding() const {
     return Scalar::Encodings::Greyscale;
 }
@@ -0,0 +1,165 @@
+#include "utils/ImageAugment2D.h"
+#include "core/tensor/Tensor.h"
+#include "utils/ConsoleUtils.h"
+#include <cmath>
+#include <algorithm>
+
+const int ImageAugment2D::OUTSIDE = -2;
+
+ImageAugment2D::ImageAugment2D(
+    float flipProb,
+    float maxTranslate,
+    float minCropScale,
+    float maxBrightness,
+    float maxContrast,
+    uint64_t seed
+) : flipProb(flipProb), maxTranslate(maxTranslate), minCropScale(minCropScale),
+    maxBrightness(maxBrightness), maxContrast(maxContrast), seed(seed) 
+{
+    if (minCropScale <= 0.0f || minCropScale > 1.0f) {
+        ConsoleUtils::fatalError("Minimum crop scale must be in (0, 1].");
+    }
+}
+
+uint64_t ImageAugment2D::getSampleSeed(size_t sampleIdx, size_t epoch) const {
+    uint64_t z = seed + 0x9E3779B97F4A7C15ULL * (epoch + 1) + 0xBF58476D1CE4E5B9ULL * sampleIdx;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+void ImageAugment2D::buildAxis(
+    size_t size,
+    float scale,
+    float offset,
+    bool flip,
+    vector<int> &srcIdx,
+    vector<float> &frac
+) const {
+    for (size_t i = 0; i < size; i++) {
+        float pos = flip ? (float) (size - 1 - i) : (float) i;
+        float src = offset + (pos + 0.5f) * scale - 0.5f;
+        float base = floor(src);
+
+        if (src < -0.5f || src > (float) size - 0.5f) {
+            srcIdx[i] = OUTSIDE;
+            frac[i] = 0.0f;
+        } else {
+            srcIdx[i] = (int) base;
+            frac[i] = src - base;
+        }
+    }
+}
+
+void ImageAugment2D::resample(
+    const float *src,
+    float *dst,
+    size_t height,
+    size_t width,
+    size_t channels,
+    mt19937 &gen
+) const {
+    uniform_real_distribution<float> unit(0.0f, 1.0f);
+    float scale = minCropScale + (1.0f - minCropScale) * unit(gen);
+    float cropY = (1.0f - scale) * height * unit(gen);
+    float cropX = (1.0f - scale) * width * unit(gen);
+    float shiftY = maxTranslate * height * (2.0f * unit(gen) - 1.0f);
+    float shiftX = maxTranslate * width * (2.0f * unit(gen) - 1.0f);
+    bool flip = unit(gen) < flipProb;
+
+    thread_local vector<int> rowIdx, colIdx;
+    thread_local vector<float> rowFrac, colFrac;
+    rowIdx.resize(height); rowFrac.resize(height);
+    colIdx.resize(width); colFrac.resize(width);
+
+    buildAxis(height, scale, cropY - shiftY, false, rowIdx, rowFrac);
+    buildAxis(width, scale, cropX - shiftX, flip, colIdx, colFrac);
+
+    size_t rowSize = width * channels;
+    for (size_t y = 0; y < height; y++) {
+        float *dstRow = dst + y * rowSize;
+        if (rowIdx[y] == OUTSIDE) {
+            fill(dstRow, dstRow + rowSize, 0.0f);
+            continue;
+        }
+
+        int y0 = max(rowIdx[y], 0);
+        int y1 = min(rowIdx[y] + 1, (int) height - 1);
+        float fy = rowFrac[y];
+        const float *row0 = src + y0 * rowSize;
+        const float *row1 = src + y1 * rowSize;
+
+        for (size_t x = 0; x < width; x++) {
+            float *out = dstRow + x * channels;
+            if (colIdx[x] == OUTSIDE) {
+                fill(out, out + channels, 0.0f);
+                continue;
+            }
+
+            size_t x0 = max(colIdx[x], 0) * channels;
+            size_t x1 = min(colIdx[x] + 1, (int) width - 1) * channels;
+            float fx = colFrac[x];
+
+            #pragma omp simd
+            for (size_t c = 0; c < channels; c++) {
+                float top = row0[x0 + c] + fx * (row0[x1 + c] - row0[x0 + c]);
+                float bottom = row1[x0 + c] + fx * (row1[x1 + c] - row1[x0 + c]);
+                out[c] = top + fy * (bottom - top);
+            }
+        }
+    }
+}
+
+void ImageAugment2D::adjustColour(float *image, size_t size, mt19937 &gen) const {
+    if (maxBrightness == 0.0f && maxContrast == 0.0f) {
+        return;
+    }
+
+    uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    float brightness = maxBrightness * unit(gen);
+    float contrast = 1.0f + maxContrast * unit(gen);
+
+    float sum = 0.0f;
+    #pragma omp simd reduction(+:sum)
+    for (size_t i = 0; i < size; i++) {
+        sum += image[i];
+    }
+
+    float mean = sum / size;
+    float offset = mean * (1.0f - contrast) + brightness;
+
+    #pragma omp simd
+    for (size_t i = 0; i < size; i++) {
+        image[i] = image[i] * contrast + offset;
+    }
+}
+
+void ImageAugment2D::apply(
+    Tensor &batch,
+    const vector<size_t> &sampleIndices,
+    size_t epoch
+) const {
+    const vector<size_t> &shape = batch.getShape();
+    if (shape.size() != 4) {
+        ConsoleUtils::fatalError("Image augmentation requires NHWC image batches.");
+    }
+
+    size_t batchSize = shape[0];
+    size_t height = shape[1];
+    size_t width = shape[2];
+    size_t channels = shape[3];
+    size_t sampleSize = height * width * channels;
+    float *batchData = batch.getFlat().data();
+
+    #pragma omp parallel for
+    for (size_t i = 0; i < batchSize; i++) {
+        mt19937 gen(getSampleSeed(sampleIndices[i], epoch));
+        float *image = batchData + i * sampleSize;
+
+        thread_local vector<float> original;
+        original.assign(image, image + sampleSize);
+
+        resample(original.data(), image, height, width, channels, gen);
+        adjustColour(image, sampleSize, gen);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,186 @@
+#include "utils/ImageResizer.h"
+#include <cmath>
+#include <algorithm>
+
+const float ImageResizer::MAX_PIXEL_VALUE = 255.0f;
+
+map<tuple<size_t, size_t, size_t, size_t>, shared_ptr<const ResizePlan> > ImageResizer::plans;
+mutex ImageResizer::plansMutex;
+
+void ResizeKernel::build(size_t srcSize, size_t dstSize) {
+    float ratio = (float) srcSize / (float) dstSize;
+    float support = max(ratio, 1.0f);
+    taps = min((size_t) ceil(2.0f * support) + 1, srcSize);
+
+    starts.assign(dstSize, 0);
+    weights.assign(dstSize * taps, 0.0f);
+
+    for (size_t i = 0; i < dstSize; i++) {
+        float center = ((float) i + 0.5f) * ratio;
+        long first = (long) floor(center - support);
+        size_t start = (size_t) max(0L, min(first, (long) (srcSize - taps)));
+        starts[i] = start;
+
+        float *kernel = weights.data() + i * taps;
+        float total = 0.0f;
+        for (long s = (long) floor(center - support); s <= (long) ceil(center + support); s++) {
+            float dist = fabs(((float) s + 0.5f - center) / support);
+            if (dist >= 1.0f) {
+                continue;
+            }
+
+            size_t srcIdx = (size_t) max(0L, min(s, (long) srcSize - 1));
+            size_t tap = min(max(srcIdx, start) - start, taps - 1);
+            float weight = 1.0f - dist;
+            kernel[tap] += weight;
+            total += weight;
+        }
+
+        if (total == 0.0f) {
+            size_t srcIdx = min((size_t) center, srcSize - 1);
+            kernel[min(max(srcIdx, start) - start, taps - 1)] = 1.0f;
+            total = 1.0f;
+        }
+
+        for (size_t t = 0; t < taps; t++) {
+            kernel[t] /= total;
+        }
+    }
+}
+
+const ResizePlan& ImageResizer::getPlan(
+    size_t srcWidth,
+    size_t srcHeight,
+    size_t dstWidth,
+    size_t dstHeight
+) {
+    tuple<size_t, size_t, size_t, size_t> key(srcWidth, srcHeight, dstWidth, dstHeight);
+    thread_local tuple<size_t, size_t, size_t, size_t> lastKey;
+    thread_local shared_ptr<const ResizePlan> lastPlan;
+
+    if (lastPlan && lastKey == key) {
+        return *lastPlan;
+    }
+
+    lock_guard<mutex> lock(plansMutex);
+    shared_ptr<const ResizePlan> &plan = plans[key];
+    if (!plan) {
+        shared_ptr<ResizePlan> newPlan = make_shared<ResizePlan>();
+        newPlan->horizontal.build(srcWidth, dstWidth);
+        newPlan->vertical.build(srcHeight, dstHeight);
+        plan = newPlan;
+    }
+
+    lastKey = key;
+    lastPlan = plan;
+    return *lastPlan;
+}
+
+size_t ImageResizer::getNumCachedPlans() {
+    lock_guard<mutex> lock(plansMutex);
+    return plans.size();
+}
+
+const float* ImageResizer::resizeHorizontal(
+    const unsigned char *src,
+    size_t srcWidth,
+    size_t srcHeight,
+    size_t dstWidth,
+    size_t channels,
+    const ResizeKernel &kernel
+) {
+    thread_local vector<float> scratch;
+    size_t dstRowSize = dstWidth * channels;
+    if (scratch.size() < srcHeight * dstRowSize) {
+        scratch.resize(srcHeight * dstRowSize);
+    }
+
+    size_t taps = kernel.taps;
+    size_t srcRowSize = srcWidth * channels;
+    for (size_t y = 0; y < srcHeight; y++) {
+        const unsigned char *srcRow = src + y * srcRowSize;
+        float *dstRow = scratch.data() + y * dstRowSize;
+
+        for (size_t x = 0; x < dstWidth; x++) {
+            const unsigned char *window = srcRow + kernel.starts[x] * channels;
+            const float *weights = kernel.weights.data() + x * taps;
+
+            for (size_t c = 0; c < channels; c++) {
+                float sum = 0.0f;
+
+                #pragma omp simd reduction(+:sum)
+                for (size_t t = 0; t < taps; t++) {
+                    sum += weights[t] * (float) window[t * channels + c];
+                }
+                dstRow[x * channels + c] = sum;
+            }
+        }
+    }
+
+    return scratch.data();
+}
+
+unsigned char ImageResizer::toPixel(float value) {
+    return (unsigned char) min(max(value + 0.5f, 0.0f), MAX_PIXEL_VALUE);
+}
+
+void ImageResizer::resize(
+    const unsigned char *src,
+    size_t srcWidth,
+    size_t srcHeight,
+    unsigned char *dst,
+    size_t dstWidth,
+    size_t dstHeight,
+    size_t channels
+) {
+    const ResizePlan &plan = getPlan(srcWidth, srcHeight, dstWidth, dstHeight);
+    const float *rows = resizeHorizontal(src, srcWidth, srcHeight, dstWidth, channels, plan.horizontal);
+
+    const ResizeKernel &kernel = plan.vertical;
+    size_t rowSize = dstWidth * channels;
+    for (size_t y = 0; y < dstHeight; y++) {
+        const float *window = rows + kernel.starts[y] * rowSize;
+        const float *weights = kernel.weights.data() + y * kernel.taps;
+        unsigned char *dstRow = dst + y * rowSize;
+
+        #pragma omp simd
+        for (size_t i = 0; i < rowSize; i++) {
+            float sum = 0.0f;
+            for (size_t t = 0; t < kernel.taps; t++) {
+                sum += weights[t] * window[t * rowSize + i];
+            }
+            dstRow[i] = toPixel(sum);
+        }
+    }
+}
+
+void ImageResizer::resize(
+    const unsigned char *src,
+    size_t srcWidth,
+    size_t srcHeight,
+    float *dst,
+    size_t dstWidth,
+    size_t dstHeight,
+    size_t channels,
+    float scale
+) {
+    const ResizePlan &plan = getPlan(srcWidth, srcHeight, dstWidth, dstHeight);
+    const float *rows = resizeHorizontal(src, srcWidth, srcHeight, dstWidth, channels, plan.horizontal);
+
+    const ResizeKernel &kernel = plan.vertical;
+    size_t rowSize = dstWidth * channels;
+    for (size_t y = 0; y < dstHeight; y++) {
+        const float *window = rows + kernel.starts[y] * rowSize;
+        const float *weights = kernel.weights.data() + y * kernel.taps;
+        float *dstRow = dst + y * rowSize;
+
+        #pragma omp simd
+        for (size_t i = 0; i < rowSize; i++) {
+            float sum = 0.0f;
+            for (size_t t = 0; t < kernel.taps; t++) {
+                sum += weights[t] * window[t * rowSize + i];
+            }
+            dstRow[i] = (float) toPixel(sum) * scale;
+        }
+    }
+}
\ No newline at end of file
@@ -1,11 +1,5 @@
-#define STB_IMAGE_RESIZE_IMPLEMENTATION
-#pragma clang diagnostic push
-#pragma clang diagnostic ignored "-Wunused-value"
-#pragma clang diagnostic ignored "-Wunused-variable"
-#include <stb/stb_image_resize.h>
-#pragma clang diagnostic pop
-
 #include "utils/ImageTransform2D.h"
+#include "utils/ImageResizer.h"
 #include "utils/ConsoleUtils.h"
 #include <iostream>
 #include <omp.h>
@@ -17,7 +11,26 @@ ImageTransform2D::ImageTransform2D(int height, int width, int channels) :
 
 ImageTransform2D::ImageTransform2D() {}
 
-Tensor ImageTransform2D::transform(const vector<RawImage> &rawImages) const {
+void ImageTransform2D::checkChannels(size_t imageChannels) const {
+    if ((size_t) channels != imageChannels) {
+        ConsoleUtils::fatalError(
+            "Channel mismatch: requested " + std::to_string(channels) +
+            " but file provides " + std::to_string(imageChannels) +
+            ". Choose a consistent channel count or pre-convert your data."
+        ); 
+    }
+}
+
+void ImageTransform2D::resizeInto(
+    const unsigned char *src,
+    size_t srcWidth,
+    size_t srcHeight,
+    unsigned char *dst
+) const {
+    ImageResizer::resize(src, srcWidth, srcHeight, dst, width, height, channels);
+}
+
+Tensor ImageTransform2D::transform(const RawImageSet &rawImages) const {
     cout << endl << "🎨 Transforming " << rawImages.size() << " images." << endl;
     ConsoleUtils::loadMessage("Resizing & Normalizing images.");
 
@@ -27,30 +40,17 @@ Tensor ImageTransform2D::transform(const vector<RawImage> &rawImages) const {
 
     vector<float> &imageFlat = transformedImages.getFlat();
     size_t numImages = rawImages.size();
-    size_t size = height * width * channels;
+    size_t size = getImageSize();
 
-    #pragma omp parallel for
+    #pragma omp parallel for schedule(dynamic)
     for (size_t n = 0; n < numImages; n++) {
-        const RawImage &image = rawImages[n];
-        if (channels != image.channels) {
-            ConsoleUtils::fatalError(
-                "Channel mismatch: requested " + std::to_string(channels) +
-                " but file provides " + std::to_string(image.channels) +
-                ". Choose a consistent channel count or pre-convert your data."
-            ); 
-        }
-
-        vector<unsigned char> resized(height * width * channels);
-        stbir_resize_uint8(
-            image.pixels.data(), image.width, image.height, 0,
-            resized.data(), width, height, 0,
-            channels
+        const RawImage &image = rawImages.images[n];
+        checkChannels(image.channels);
+        ImageResizer::resize(
+            rawImages.getPixels(n), image.width, image.height,
+            imageFlat.data() + n * size, width, height, channels,
+            1.0f / MAX_COLOUR_VALUE
         );
-
-        size_t currIdx = n * size;
-        for (size_t i = 0; i < size; i++) {
-            imageFlat[i + currIdx] = (float) resized[i] / MAX_COLOUR_VALUE;
-        }
     }
     
     ConsoleUtils::completeMessage();
@@ -58,6 +58,39 @@ Tensor ImageTransform2D::transform(const vector<RawImage> &rawImages) const {
     return transformedImages;
 }
 
+ByteTensor ImageTransform2D::transformPacked(const RawImageSet &rawImages) const {
+    cout << endl << "🎨 Transforming " << rawImages.size() << " images." << endl;
+    ConsoleUtils::loadMessage("Resizing images.");
+
+    ByteTensor packedImages = makePackedTensor(rawImages.size());
+
+    unsigned char *imageData = packedImages.getData();
+    size_t numImages = rawImages.size();
+    size_t size = getImageSize();
+
+    #pragma omp parallel for schedule(dynamic)
+    for (size_t n = 0; n < numImages; n++) {
+        const RawImage &image = rawImages.images[n];
+        checkChannels(image.channels);
+        resizeInto(rawImages.getPixels(n), image.width, image.height, imageData + n * size);
+    }
+
+    ConsoleUtils::completeMessage();
+    ConsoleUtils::printSepLine();
+    return packedImages;
+}
+
+ByteTensor ImageTransform2D::makePackedTensor(size_t numImages) const {
+    return ByteTensor(
+        {numImages, (size_t) height, (size_t) width, (size_t) channels},
+        1.0f / MAX_COLOUR_VALUE
+    );
+}
+
+size_t ImageTransform2D::getImageSize() const {
+    return (size_t) height * width * channels;
+}
+
 int ImageTransform2D::getHeight() const {
     return height;
 }
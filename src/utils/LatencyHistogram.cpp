@@ -0,0 +1,84 @@
+#include "utils/LatencyHistogram.h"
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <algorithm>
+
+const size_t LatencyHistogram::NUM_BUCKETS = 28;
+const size_t LatencyHistogram::BAR_WIDTH = 40;
+
+LatencyHistogram::LatencyHistogram() : 
+    counts(NUM_BUCKETS, 0), totalCount(0), totalMicros(0.0), maxMicros(0.0) {}
+
+// Bucket i holds durations below 2^i microseconds; the last bucket is unbounded.
+double LatencyHistogram::getBucketLimit(size_t bucket) {
+    return ldexp(1.0, (int) bucket);
+}
+
+void LatencyHistogram::record(double micros) {
+    micros = max(micros, 0.0);
+    size_t bucket = 0;
+    while (bucket + 1 < NUM_BUCKETS && micros >= getBucketLimit(bucket)) {
+        bucket++;
+    }
+
+    counts[bucket]++;
+    totalCount++;
+    totalMicros += micros;
+    maxMicros = max(maxMicros, micros);
+}
+
+size_t LatencyHistogram::getCount() const {
+    return totalCount;
+}
+
+double LatencyHistogram::getMean() const {
+    return (totalCount == 0) ? 0.0 : totalMicros / totalCount;
+}
+
+double LatencyHistogram::getMax() const {
+    return maxMicros;
+}
+
+// Returns the upper limit of the bucket holding the given percentile (0 - 100).
+double LatencyHistogram::getPercentile(float percentile) const {
+    if (totalCount == 0)
+        return 0.0;
+
+    size_t rank = (size_t) ceil(percentile / 100.0 * totalCount);
+    size_t seen = 0;
+    for (size_t i = 0; i < NUM_BUCKETS; i++) {
+        seen += counts[i];
+        if (seen >= max(rank, (size_t) 1)) {
+            return min(getBucketLimit(i), maxMicros);
+        }
+    }
+
+    return maxMicros;
+}
+
+void LatencyHistogram::print(const string &name) const {
+    ios_base::fmtflags flags = cout.flags();
+    streamsize precision = cout.precision();
+
+    cout << fixed << setprecision(1)
+         << name << " (us): n=" << totalCount
+         << "  mean=" << getMean()
+         << "  p50<=" << getPercentile(50.0f)
+         << "  p90<=" << getPercentile(90.0f)
+         << "  p99<=" << getPercentile(99.0f)
+         << "  max=" << maxMicros << endl;
+
+    cout.flags(flags);
+    cout.precision(precision);
+
+    size_t peak = *max_element(counts.begin(), counts.end());
+    for (size_t i = 0; i < NUM_BUCKETS; i++) {
+        if (counts[i] == 0)
+            continue;
+
+        size_t barLength = (counts[i] * BAR_WIDTH + peak - 1) / peak;
+        cout << "  < " << setw(10) << (size_t) getBucketLimit(i) << "  "
+             << string(barLength, '#') << " " << counts[i] << endl;
+    }
+}
\ No newline at end of file
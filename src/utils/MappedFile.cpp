@@ -0,0 +1,47 @@
+#include "utils/MappedFile.h"
+#include "utils/ConsoleUtils.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+MappedFile::MappedFile(const string &path) : data(nullptr), size(0) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        ConsoleUtils::fatalError("Could not open file: " + path);
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        close(fd);
+        ConsoleUtils::fatalError("Could not stat file: " + path);
+    }
+
+    size = (size_t) info.st_size;
+    if (size > 0) {
+        void *mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped == MAP_FAILED) {
+            close(fd);
+            ConsoleUtils::fatalError("Could not map file: " + path);
+        }
+
+        madvise(mapped, size, MADV_WILLNEED);
+        data = (const uint8_t*) mapped;
+    }
+
+    close(fd);
+}
+
+MappedFile::~MappedFile() {
+    if (data != nullptr) {
+        munmap((void*) data, size);
+    }
+}
+
+const uint8_t* MappedFile::getData() const {
+    return data;
+}
+
+size_t MappedFile::getSize() const {
+    return size;
+}
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include <omp.h>
 #include "utils/ConsoleUtils.h"
 #include <limits>
+#include <algorithm>
 
 void Minmax::checkRank(const Tensor &data) const {
     if (data.getRank() != 2) {
@@ -24,29 +25,50 @@ void Minmax::checkDims(size_t toFitDim) const {
     }
 }
 
+float Minmax::getScaleFactor(size_t col) const {
+    float scaleFactor = maxVals[col] - minVals[col];
+    if (scaleFactor == 0.0) {
+        scaleFactor = 1.0;
+    }
+    return scaleFactor;
+}
+
 void Minmax::fit(const Tensor &data) {
+    reset();
+    partialFit(data);
+}
+
+void Minmax::partialFit(const Tensor &data) {
     checkRank(data);
-    Scalar::fit(data);
+    Scalar::partialFit(data);
     
     Matrix dataMat = data.M();
     size_t numCols = dataMat.getNumCols();
     size_t numRows = dataMat.getNumRows();
-    const vector<float> &dataFlat = data.getFlat();
+    const float *dataFlat = data.getFlat().data();
 
-    minVals = vector<float>(numCols, numeric_limits<float>::max());
-    maxVals = vector<float>(numCols, -numeric_limits<float>::max());
+    if (minVals.empty()) {
+        minVals = vector<float>(numCols, numeric_limits<float>::max());
+        maxVals = vector<float>(numCols, -numeric_limits<float>::max());
+    } else {
+        checkDims(numCols);
+    }
 
     #pragma omp parallel
     {
         vector<float> threadMinVals(numCols, numeric_limits<float>::max());
         vector<float> threadMaxVals(numCols, -numeric_limits<float>::max());
+        float *threadMin = threadMinVals.data();
+        float *threadMax = threadMaxVals.data();
 
-        #pragma omp for
-        for (size_t j = 0; j < numCols; j++) {
-            for (size_t i = 0; i < numRows; i++) {
-                float val = dataFlat[i * numCols + j];
-                if (val < threadMinVals[j]) threadMinVals[j] = val;
-                if (val > threadMaxVals[j]) threadMaxVals[j] = val;
+        #pragma omp for schedule(static)
+        for (size_t i = 0; i < numRows; i++) {
+            const float *row = dataFlat + i * numCols;
+
+            #pragma omp simd
+            for (size_t j = 0; j < numCols; j++) {
+                threadMin[j] = min(threadMin[j], row[j]);
+                threadMax[j] = max(threadMax[j], row[j]);
             }
         }
 
@@ -61,11 +83,22 @@ void Minmax::fit(const Tensor &data) {
 }
 
 void Minmax::fit(const vector<float> &data) {
-    Scalar::fit(data);
+    reset();
+    partialFit(data);
+}
+
+void Minmax::partialFit(const vector<float> &data) {
+    Scalar::partialFit(data);
+    if (minVals.empty()) {
+        minVals = vector<float>(1, numeric_limits<float>::max());
+        maxVals = vector<float>(1, -numeric_limits<float>::max());
+    } else {
+        checkDims(1);
+    }
 
     size_t size = data.size();
-    float minVal = numeric_limits<float>::max();
-    float maxVal = -numeric_limits<float>::max();
+    float minVal = minVals[0];
+    float maxVal = maxVals[0];
 
     #pragma omp parallel for reduction(min:minVal) reduction(max:maxVal)
     for (size_t i = 0; i < size; i++) {
@@ -74,55 +107,50 @@ void Minmax::fit(const vector<float> &data) {
         if (val > maxVal) maxVal = val;
     }
 
-    minVals = vector<float>(1, minVal);
-    maxVals = vector<float>(1, maxVal);
+    minVals[0] = minVal;
+    maxVals[0] = maxVal;
 }
 
-Tensor Minmax::transform(const Tensor &data) const {
+void Minmax::transformInPlace(Tensor &data) const {
     checkFitted();
     checkRank(data);
     checkDims(data.getShape()[1]);
 
-    Tensor transformed(data.getShape());
-    vector<float> &transformedFlat = transformed.getFlat();
-
     Matrix dataMat = data.M();
     size_t numCols = dataMat.getNumCols();
     size_t numRows = dataMat.getNumRows();
-    const vector<float> &dataFlat = data.getFlat();
+    float *dataFlat = data.getFlat().data();
 
-    #pragma omp parallel for
+    vector<float> scaleFactors(numCols);
     for (size_t j = 0; j < numCols; j++) {
-        float scaleFactor = maxVals[j] - minVals[j];
-        if (scaleFactor == 0.0) {
-            scaleFactor = 1.0;
-        }
+        scaleFactors[j] = getScaleFactor(j);
+    }
+    const float *mins = minVals.data();
+    const float *scales = scaleFactors.data();
 
-        for (size_t i = 0; i < numRows; i++) {
-            transformedFlat[i * numCols + j] = (dataFlat[i * numCols + j] - minVals[j])/scaleFactor;
+    #pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < numRows; i++) {
+        float *row = dataFlat + i * numCols;
+
+        #pragma omp simd
+        for (size_t j = 0; j < numCols; j++) {
+            row[j] = (row[j] - mins[j])/scales[j];
         }
     }
-
-    return transformed;
 }
 
-vector<float> Minmax::transform(const vector<float> &data) const {
+void Minmax::transformInPlace(vector<float> &data) const {
     checkFitted();
     checkDims(1);
 
     size_t size = data.size();
-    vector<float> transformed(size);
+    float minVal = minVals[0];
+    float scaleFactor = getScaleFactor(0);
 
-    float scaleFactor = maxVals[0] - minVals[0];
-    if (scaleFactor == 0.0) {
-        scaleFactor = 1.0;
-    }
-    #pragma omp parallel for
+    #pragma omp parallel for simd
     for (size_t i = 0; i < size; i++) {
-        transformed[i] = (data[i] - minVals[0])/scaleFactor;
+        data[i] = (data[i] - minVal)/scaleFactor;
     }
-
-    return transformed;
 }
 
 Tensor Minmax::reverseTransform(const Tensor &data) const {
@@ -138,15 +166,18 @@ Tensor Minmax::reverseTransform(const Tensor &data) const {
     size_t numRows = dataMat.getNumRows();
     const vector<float> &dataFlat = data.getFlat();
 
-    #pragma omp parallel for
+    vector<float> scaleFactors(numCols);
     for (size_t j = 0; j < numCols; j++) {
-        float scaleFactor = maxVals[j] - minVals[j];
-        if (scaleFactor == 0.0) {
-            scaleFactor = 1.0;
-        }
+        scaleFactors[j] = getScaleFactor(j);
+    }
 
-        for (size_t i = 0; i < numRows; i++) {
-            transformedFlat[i * numCols + j] = dataFlat[i * numCols + j] * scaleFactor + minVals[j];
+    #pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < numRows; i++) {
+        size_t rowStart = i * numCols;
+
+        #pragma omp simd
+        for (size_t j = 0; j < numCols; j++) {
+            transformedFlat[rowStart + j] = dataFlat[rowStart + j] * scaleFactors[j] + minVals[j];
         }
     }
 
@@ -160,10 +191,7 @@ vector<float> Minmax::reverseTransform(const vector<float> &data) const {
     size_t size = data.size();
     vector<float> transformed(size);
 
-    float scaleFactor = maxVals[0] - minVals[0];
-    if (scaleFactor == 0.0) {
-        scaleFactor = 1.0;
-    }
+    float scaleFactor = getScaleFactor(0);
     
     #pragma omp parallel for
     for (size_t i = 0; i < size; i++) {
@@ -173,7 +201,22 @@ vector<float> Minmax::reverseTransform(const vector<float> &data) const {
     return transformed;
 }
 
+bool Minmax::getAffine(vector<float> &scale, vector<float> &shift) const {
+    checkFitted();
+    size_t numCols = minVals.size();
+    scale.resize(numCols);
+    shift.resize(numCols);
+
+    for (size_t j = 0; j < numCols; j++) {
+        float scaleFactor = getScaleFactor(j);
+        scale[j] = 1.0f / scaleFactor;
+        shift[j] = -minVals[j] / scaleFactor;
+    }
+    return true;
+}
+
 void Minmax::reset() {
+    Scalar::reset();
     minVals.clear();
     maxVals.clear();
 }
@@ -1,5 +1,7 @@
 #include "utils/Scalar.h"
 #include "utils/ConsoleUtils.h"
+#include "core/tensor/Tensor.h"
+#include "core/data/SampleView.h"
 
 void Scalar::fit(const Tensor &data) {
     fitted = true;
@@ -9,12 +11,51 @@ void Scalar::fit(const vector<float> &data) {
     fitted = true;
 }
 
+void Scalar::partialFit(const Tensor &data) {
+    fitted = true;
+}
+
+void Scalar::partialFit(const vector<float> &data) {
+    fitted = true;
+}
+
+Tensor Scalar::transform(const Tensor &data) const {
+    Tensor transformed = data;
+    transformInPlace(transformed);
+    return transformed;
+}
+
+vector<float> Scalar::transform(const vector<float> &data) const {
+    vector<float> transformed = data;
+    transformInPlace(transformed);
+    return transformed;
+}
+
+bool Scalar::getAffine(vector<float> &scale, vector<float> &shift) const {
+    return false;
+}
+
+SampleView Scalar::transformView(const SampleView &data) const {
+    vector<float> scale;
+    vector<float> shift;
+    if (!getAffine(scale, shift)) {
+        ConsoleUtils::fatalError("This scalar cannot be applied during batch gather.");
+    }
+
+    return data.withAffine(scale, shift);
+}
+
 void Scalar::checkFitted() const {
     if (!fitted) {
         ConsoleUtils::fatalError("Cannot transform data before calling fit().");
     }
 }
 
+// For scalars whose statistics can be filled in other than through fit().
+void Scalar::markFitted() {
+    fitted = true;
+}
+
 void Scalar::reset() {
     fitted = false;
 }
@@ -0,0 +1,250 @@
+#include "utils/ShardUtils.h"
+#include "utils/MappedFile.h"
+#include "utils/ConsoleUtils.h"
+#include <filesystem>
+#include <cstring>
+#include <cstdio>
+
+using namespace std;
+namespace fs = std::filesystem;
+
+const uint32_t ShardUtils::MAGIC = 0x4853534E;
+const uint32_t ShardUtils::VERSION = 1;
+const size_t ShardUtils::PAGE_ALIGNMENT = 4096;
+const string ShardUtils::MANIFEST_NAME = "index.bin";
+const string ShardUtils::SHARD_PREFIX = "shard_";
+const string ShardUtils::SHARD_EXTENSION = ".bin";
+
+string ShardUtils::getShardPath(const string &dirPath, size_t shardIdx) {
+    char name[16];
+    snprintf(name, sizeof(name), "%05zu", shardIdx);
+    return (fs::path(dirPath) / (SHARD_PREFIX + name + SHARD_EXTENSION)).string();
+}
+
+size_t ShardUtils::getDataOffset(size_t numRecords) {
+    size_t headerBytes = (4 + numRecords) * sizeof(uint32_t);
+    return ((headerBytes + PAGE_ALIGNMENT - 1) / PAGE_ALIGNMENT) * PAGE_ALIGNMENT;
+}
+
+void ShardUtils::writeShards(
+    const string &dirPath,
+    const ByteTensor &images,
+    const vector<float> &targets,
+    const unordered_map<string, int> &labelMap,
+    size_t recordsPerShard
+) {
+    ConsoleUtils::loadMessage("Writing Image Shards.");
+    size_t numRecords = images.getShape().empty() ? 0 : images.getShape()[0];
+    if (numRecords == 0 || images.getShape().size() != 4) {
+        ConsoleUtils::fatalError("Shards require a packed image tensor of shape [N, H, W, C].");
+    }
+
+    if (targets.size() != numRecords) {
+        ConsoleUtils::fatalError("Number of targets does not match number of images.");
+    }
+
+    if (recordsPerShard == 0) {
+        ConsoleUtils::fatalError("Records per shard must be greater than 0.");
+    }
+
+    fs::create_directories(dirPath);
+    size_t numShards = (numRecords + recordsPerShard - 1) / recordsPerShard;
+
+    #pragma omp parallel for schedule(dynamic)
+    for (size_t s = 0; s < numShards; s++) {
+        size_t start = s * recordsPerShard;
+        size_t end = min(start + recordsPerShard, numRecords);
+        writeShard(getShardPath(dirPath, s), images, targets, start, end);
+    }
+
+    writeManifest(dirPath, images, labelMap, recordsPerShard, numShards);
+    ConsoleUtils::completeMessage();
+}
+
+void ShardUtils::writeShard(
+    const string &shardPath,
+    const ByteTensor &images,
+    const vector<float> &targets,
+    size_t start,
+    size_t end
+) {
+    ofstream shardBin(shardPath, ios::binary);
+    if (!shardBin) {
+        ConsoleUtils::fatalError("Could not open shard for writing: " + shardPath);
+    }
+
+    uint32_t numRecords = end - start;
+    uint32_t recordBytes = images.getSampleSize();
+    uint32_t dataOffset = getDataOffset(numRecords);
+
+    shardBin.write((char*) &MAGIC, sizeof(uint32_t));
+    shardBin.write((char*) &numRecords, sizeof(uint32_t));
+    shardBin.write((char*) &recordBytes, sizeof(uint32_t));
+    shardBin.write((char*) &dataOffset, sizeof(uint32_t));
+
+    for (size_t i = start; i < end; i++) {
+        uint32_t label = (uint32_t) targets[i];
+        shardBin.write((char*) &label, sizeof(uint32_t));
+    }
+
+    size_t headerBytes = (4 + numRecords) * sizeof(uint32_t);
+    vector<char> padding(dataOffset - headerBytes, 0);
+    shardBin.write(padding.data(), padding.size());
+
+    for (size_t i = start; i < end; i++) {
+        shardBin.write((const char*) images.getSample(i), recordBytes);
+    }
+
+    if (!shardBin) {
+        ConsoleUtils::fatalError("Failed while writing shard: " + shardPath);
+    }
+}
+
+void ShardUtils::writeManifest(
+    const string &dirPath,
+    const ByteTensor &images,
+    const unordered_map<string, int> &labelMap,
+    size_t recordsPerShard,
+    size_t numShards
+) {
+    string manifestPath = (fs::path(dirPath) / MANIFEST_NAME).string();
+    ofstream manifestBin(manifestPath, ios::binary);
+    if (!manifestBin) {
+        ConsoleUtils::fatalError("Could not open shard index for writing: " + manifestPath);
+    }
+
+    const vector<size_t> &shape = images.getShape();
+    uint32_t header[] = {
+        MAGIC, VERSION,
+        (uint32_t) shape[0], (uint32_t) recordsPerShard, (uint32_t) numShards,
+        (uint32_t) shape[1], (uint32_t) shape[2], (uint32_t) shape[3]
+    };
+    manifestBin.write((char*) header, sizeof(header));
+
+    float scale = images.getScale();
+    float shift = images.getShift();
+    manifestBin.write((char*) &scale, sizeof(float));
+    manifestBin.write((char*) &shift, sizeof(float));
+
+    uint32_t mapSize = labelMap.size();
+    manifestBin.write((char*) &mapSize, sizeof(uint32_t));
+    for (const pair<const string, int> &pair : labelMap) {
+        uint32_t keyLen = pair.first.size();
+        manifestBin.write((char*) &keyLen, sizeof(uint32_t));
+        manifestBin.write(pair.first.c_str(), keyLen);
+
+        uint32_t mapVal = pair.second;
+        manifestBin.write((char*) &mapVal, sizeof(uint32_t));
+    }
+}
+
+uint32_t ShardUtils::readField(const MappedFile &shard, size_t fieldIdx) {
+    uint32_t value;
+    memcpy(&value, shard.getData() + fieldIdx * sizeof(uint32_t), sizeof(uint32_t));
+    return value;
+}
+
+const uint8_t* ShardUtils::readShard(
+    const MappedFile &shard,
+    const string &shardPath,
+    size_t expectedRecords,
+    size_t recordBytes,
+    vector<float> &targets,
+    size_t targetStart
+) {
+    if (shard.getSize() < 4 * sizeof(uint32_t) || readField(shard, 0) != MAGIC) {
+        ConsoleUtils::fatalError("Invalid image shard: " + shardPath);
+    }
+
+    size_t numRecords = readField(shard, 1);
+    size_t dataOffset = readField(shard, 3);
+    if (
+        numRecords != expectedRecords || 
+        readField(shard, 2) != recordBytes ||
+        dataOffset < (4 + numRecords) * sizeof(uint32_t) ||
+        shard.getSize() < dataOffset + numRecords * recordBytes
+    ) {
+        ConsoleUtils::fatalError("Image shard is truncated or does not match index: " + shardPath);
+    }
+
+    for (size_t i = 0; i < numRecords; i++) {
+        targets[targetStart + i] = (float) readField(shard, 4 + i);
+    }
+
+    return shard.getData() + dataOffset;
+}
+
+ByteTensor ShardUtils::readShards(
+    const string &dirPath,
+    vector<float> &targets,
+    unordered_map<string, int> &labelMap
+) {
+    ConsoleUtils::loadMessage("Mapping Image Shards.");
+    string manifestPath = (fs::path(dirPath) / MANIFEST_NAME).string();
+    ifstream manifestBin(manifestPath, ios::binary);
+    if (!manifestBin) {
+        ConsoleUtils::fatalError("Could not open shard index: " + manifestPath);
+    }
+
+    uint32_t header[8];
+    manifestBin.read((char*) header, sizeof(header));
+    if (!manifestBin || header[0] != MAGIC) {
+        ConsoleUtils::fatalError("Invalid shard index: " + manifestPath);
+    }
+
+    if (header[1] != VERSION) {
+        ConsoleUtils::fatalError(
+            "Unsupported shard version \"" + to_string(header[1]) + "\" in " + manifestPath + "."
+        );
+    }
+
+    size_t numRecords = header[2];
+    size_t recordsPerShard = header[3];
+    size_t numShards = header[4];
+    vector<size_t> shape = {numRecords, header[5], header[6], header[7]};
+    if (recordsPerShard == 0 || numShards != (numRecords + recordsPerShard - 1) / recordsPerShard) {
+        ConsoleUtils::fatalError("Shard index has an inconsistent shard layout: " + manifestPath);
+    }
+
+    float scale, shift;
+    manifestBin.read((char*) &scale, sizeof(float));
+    manifestBin.read((char*) &shift, sizeof(float));
+
+    uint32_t mapSize;
+    manifestBin.read((char*) &mapSize, sizeof(uint32_t));
+    labelMap.clear();
+    for (uint32_t i = 0; i < mapSize; i++) {
+        uint32_t keyLen;
+        manifestBin.read((char*) &keyLen, sizeof(uint32_t));
+
+        string key(keyLen, '\0');
+        manifestBin.read(key.data(), keyLen);
+
+        uint32_t value;
+        manifestBin.read((char*) &value, sizeof(uint32_t));
+        labelMap[key] = value;
+    }
+
+    if (!manifestBin) {
+        ConsoleUtils::fatalError("Shard index is truncated: " + manifestPath);
+    }
+
+    ByteTensor images = ByteTensor::view(shape, recordsPerShard, scale, shift);
+    size_t recordBytes = images.getSampleSize();
+    targets.assign(numRecords, 0.0f);
+
+    for (size_t s = 0; s < numShards; s++) {
+        string shardPath = getShardPath(dirPath, s);
+        size_t start = s * recordsPerShard;
+        size_t expectedRecords = min(recordsPerShard, numRecords - start);
+
+        shared_ptr<const MappedFile> shard = make_shared<const MappedFile>(shardPath);
+        const uint8_t *pixels = readShard(
+            *shard, shardPath, expectedRecords, recordBytes, targets, start
+        );
+        images.addSegment(shard, pixels);
+    }
+
+    ConsoleUtils::completeMessage();
+    return images;
+}
\ No newline at end of file
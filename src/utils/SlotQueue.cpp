@@ -0,0 +1,39 @@
+#include "utils/SlotQueue.h"
+#include "utils/ConsoleUtils.h"
+
+SlotQueue::SlotQueue(size_t capacity) : slots(capacity), head(0), count(0), closed(false) {
+    if (capacity == 0) {
+        ConsoleUtils::fatalError("Slot queue capacity must be greater than 0.");
+    }
+}
+
+void SlotQueue::push(size_t slot) {
+    unique_lock<mutex> lock(queueMutex);
+    notFull.wait(lock, [this] { return count < slots.size(); });
+
+    slots[(head + count) % slots.size()] = slot;
+    count++;
+    notEmpty.notify_one();
+}
+
+// Returns false once the queue is closed and drained.
+bool SlotQueue::pop(size_t &slot) {
+    unique_lock<mutex> lock(queueMutex);
+    notEmpty.wait(lock, [this] { return count > 0 || closed; });
+
+    if (count == 0) {
+        return false;
+    }
+
+    slot = slots[head];
+    head = (head + 1) % slots.size();
+    count--;
+    notFull.notify_one();
+    return true;
+}
+
+void SlotQueue::close() {
+    lock_guard<mutex> lock(queueMutex);
+    closed = true;
+    notEmpty.notify_all();
+}
\ No newline at end of file
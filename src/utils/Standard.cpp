@@ -0,0 +1,284 @@
+#include "utils/Standard.h"
+#include "core/tensor/Matrix.h"
+#include "core/tensor/Tensor.h"
+#include <omp.h>
+#include "utils/ConsoleUtils.h"
+#include <cmath>
+
+Standard::Standard() : count(0) {}
+
+void Standard::checkRank(const Tensor &data) const {
+    if (data.getRank() != 2) {
+        ConsoleUtils::fatalError(
+            "Standard scaling only supports rank-2 tensors (matrices).\n"
+            "Received tensor with rank: " + to_string(data.getRank()) + "."
+        );
+    }
+}
+
+void Standard::checkDims(size_t toFitDim) const {
+    if (means.size() != toFitDim) {
+        ConsoleUtils::fatalError(
+            "Standard scaling dimension mismatch:\n"
+            "Expected numCols = " + to_string(means.size()) +
+            ", but got " + to_string(toFitDim) + "."
+        );
+    }
+}
+
+void Standard::accumulate(const float *data, size_t numRows, size_t numCols) {
+    if (count == 0) {
+        means.assign(numCols, 0.0);
+        sumSquares.assign(numCols, 0.0);
+    } else {
+        checkDims(numCols);
+    }
+
+    int numThreads = omp_get_max_threads();
+    vector<Standard> partials(numThreads);
+
+    #pragma omp parallel
+    {
+        Standard &partial = partials[omp_get_thread_num()];
+        partial.means.assign(numCols, 0.0);
+        partial.sumSquares.assign(numCols, 0.0);
+        double *threadMeans = partial.means.data();
+        double *threadSumSquares = partial.sumSquares.data();
+
+        #pragma omp for schedule(static)
+        for (size_t i = 0; i < numRows; i++) {
+            const float *row = data + i * numCols;
+            partial.count++;
+            double invCount = 1.0 / (double) partial.count;
+
+            #pragma omp simd
+            for (size_t j = 0; j < numCols; j++) {
+                double delta = row[j] - threadMeans[j];
+                threadMeans[j] += delta * invCount;
+                threadSumSquares[j] += delta * (row[j] - threadMeans[j]);
+            }
+        }
+    }
+
+    for (int t = 0; t < numThreads; t++) {
+        mergeStats(partials[t]);
+    }
+}
+
+void Standard::mergeStats(const Standard &other) {
+    if (other.count == 0) {
+        return;
+    }
+
+    if (count == 0) {
+        count = other.count;
+        means = other.means;
+        sumSquares = other.sumSquares;
+        return;
+    }
+
+    checkDims(other.means.size());
+    double total = (double) (count + other.count);
+    double otherWeight = (double) other.count / total;
+    double crossWeight = (double) count * (double) other.count / total;
+    size_t numCols = means.size();
+
+    for (size_t j = 0; j < numCols; j++) {
+        double delta = other.means[j] - means[j];
+        means[j] += delta * otherWeight;
+        sumSquares[j] += other.sumSquares[j] + delta * delta * crossWeight;
+    }
+    count += other.count;
+}
+
+// Combines the statistics of a scalar fitted on other data, as if both had been fitted together.
+void Standard::merge(const Standard &other) {
+    if (other.count == 0)
+        return;
+
+    mergeStats(other);
+    updateScaling();
+    markFitted();
+}
+
+void Standard::updateScaling() {
+    size_t numCols = means.size();
+    meanVals.resize(numCols);
+    stdVals.resize(numCols);
+
+    for (size_t j = 0; j < numCols; j++) {
+        float stdVal = (float) sqrt(sumSquares[j] / (double) count);
+        meanVals[j] = (float) means[j];
+        stdVals[j] = (stdVal == 0.0f) ? 1.0f : stdVal;
+    }
+}
+
+void Standard::fit(const Tensor &data) {
+    reset();
+    partialFit(data);
+}
+
+void Standard::partialFit(const Tensor &data) {
+    checkRank(data);
+    Scalar::partialFit(data);
+
+    Matrix dataMat = data.M();
+    accumulate(data.getFlat().data(), dataMat.getNumRows(), dataMat.getNumCols());
+    updateScaling();
+}
+
+void Standard::fit(const vector<float> &data) {
+    reset();
+    partialFit(data);
+}
+
+void Standard::partialFit(const vector<float> &data) {
+    Scalar::partialFit(data);
+    accumulate(data.data(), data.size(), 1);
+    updateScaling();
+}
+
+void Standard::transformInPlace(Tensor &data) const {
+    checkFitted();
+    checkRank(data);
+    checkDims(data.getShape()[1]);
+
+    Matrix dataMat = data.M();
+    size_t numCols = dataMat.getNumCols();
+    size_t numRows = dataMat.getNumRows();
+    float *dataFlat = data.getFlat().data();
+    const float *meanPtr = meanVals.data();
+    const float *stdPtr = stdVals.data();
+
+    #pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < numRows; i++) {
+        float *row = dataFlat + i * numCols;
+
+        #pragma omp simd
+        for (size_t j = 0; j < numCols; j++) {
+            row[j] = (row[j] - meanPtr[j]) / stdPtr[j];
+        }
+    }
+}
+
+void Standard::transformInPlace(vector<float> &data) const {
+    checkFitted();
+    checkDims(1);
+
+    size_t size = data.size();
+    float meanVal = meanVals[0];
+    float stdVal = stdVals[0];
+
+    #pragma omp parallel for simd
+    for (size_t i = 0; i < size; i++) {
+        data[i] = (data[i] - meanVal) / stdVal;
+    }
+}
+
+Tensor Standard::reverseTransform(const Tensor &data) const {
+    checkFitted();
+    checkRank(data);
+    checkDims(data.getShape()[1]);
+
+    Tensor transformed = data;
+    Matrix dataMat = transformed.M();
+    size_t numCols = dataMat.getNumCols();
+    size_t numRows = dataMat.getNumRows();
+    float *dataFlat = transformed.getFlat().data();
+    const float *meanPtr = meanVals.data();
+    const float *stdPtr = stdVals.data();
+
+    #pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < numRows; i++) {
+        float *row = dataFlat + i * numCols;
+
+        #pragma omp simd
+        for (size_t j = 0; j < numCols; j++) {
+            row[j] = row[j] * stdPtr[j] + meanPtr[j];
+        }
+    }
+
+    return transformed;
+}
+
+vector<float> Standard::reverseTransform(const vector<float> &data) const {
+    checkFitted();
+    checkDims(1);
+
+    size_t size = data.size();
+    vector<float> transformed(size);
+    float meanVal = meanVals[0];
+    float stdVal = stdVals[0];
+
+    #pragma omp parallel for simd
+    for (size_t i = 0; i < size; i++) {
+        transformed[i] = data[i] * stdVal + meanVal;
+    }
+
+    return transformed;
+}
+
+bool Standard::getAffine(vector<float> &scale, vector<float> &shift) const {
+    checkFitted();
+    size_t numCols = meanVals.size();
+    scale.resize(numCols);
+    shift.resize(numCols);
+
+    for (size_t j = 0; j < numCols; j++) {
+        scale[j] = 1.0f / stdVals[j];
+        shift[j] = -meanVals[j] / stdVals[j];
+    }
+    return true;
+}
+
+const vector<float>& Standard::getMeans() const {
+    return meanVals;
+}
+
+const vector<float>& Standard::getStds() const {
+    return stdVals;
+}
+
+void Standard::reset() {
+    Scalar::reset();
+    count = 0;
+    means.clear();
+    sumSquares.clear();
+    meanVals.clear();
+    stdVals.clear();
+}
+
+void Standard::writeBin(ofstream &modelBin) const {
+    Scalar::writeBin(modelBin);
+
+    uint32_t numCols = means.size();
+    modelBin.write((char*) &numCols, sizeof(uint32_t));
+    modelBin.write((char*) &count, sizeof(uint64_t));
+    modelBin.write((char*) means.data(), numCols * sizeof(double));
+    modelBin.write((char*) sumSquares.data(), numCols * sizeof(double));
+}
+
+void Standard::loadFromBin(ifstream &modelBin) {
+    Scalar::loadFromBin(modelBin);
+
+    uint32_t numCols;
+    modelBin.read((char*) &numCols, sizeof(uint32_t));
+    modelBin.read((char*) &count, sizeof(uint64_t));
+
+    means.resize(numCols);
+    sumSquares.resize(numCols);
+    modelBin.read((char*) means.data(), numCols * sizeof(double));
+    modelBin.read((char*) sumSquares.data(), numCols * sizeof(double));
+
+    if (count > 0) {
+        updateScaling();
+    }
+}
+
+uint32_t Standard::getEncoding() const {
+    return Scalar::Encodings::Standard;
+}
+
+Scalar* Standard::clone() const {
+    return new Standard(*this);
+}
\ No newline at end of file
@@ -0,0 +1,236 @@
+// // Bf16TensorCpu.cpp
+// #include "core/tensor/Bf16Tensor.h"
+// #include "core/tensor/Tensor.h"
+
+// #include <cassert>
+// #include <cstdio>
+// #include <cmath>
+// #include <cstring>
+// #include <cstdint>
+// #include <random>
+// #include <vector>
+
+// using std::vector;
+
+// static void fillRandom(Tensor &t, uint32_t seed, float lo=-1.f, float hi=1.f) {
+//     std::mt19937 rng(seed);
+//     std::uniform_real_distribution<float> U(lo, hi);
+//     for (auto &x : t.getFlat()) x = U(rng);
+// }
+
+// static float fromBits(uint32_t bits) {
+//     float f;
+//     std::memcpy(&f, &bits, sizeof(float));
+//     return f;
+// }
+
+// // Each output must be within bf16 rounding of the fp32 value: both operands carry a relative
+// // error of 2^-9, so a sum of products can be off by about 2^-8 of the sum of their magnitudes.
+// static void assertBf16Close(const Tensor &out, const Tensor &ref, const Tensor &mag, const char *name) {
+//     assert(out.getSize() == ref.getSize());
+//     for (size_t i = 0; i < out.getSize(); ++i) {
+//         float tol = 1e-5f + mag.getFlat()[i] / 256.f;
+//         if (std::fabs(out.getFlat()[i] - ref.getFlat()[i]) > tol) {
+//             std::fprintf(stderr, "%s mismatch at %zu: %g vs %g (tol %g)\n",
+//                 name, i, out.getFlat()[i], ref.getFlat()[i], tol);
+//             assert(false);
+//         }
+//     }
+// }
+
+// // Padded copy of an NHWC input with the zero border of the window
+// static Tensor naivePad(const Tensor &x, const WindowDims &win) {
+//     const vector<size_t> &s = x.getShape();
+//     size_t R = s[1] + win.padRows, C = s[2] + win.padCols, D = s[3];
+//     Tensor p({s[0], R, C, D});
+//     for (size_t n = 0; n < s[0]; ++n)
+//         for (size_t r = 0; r < s[1]; ++r)
+//             for (size_t c = 0; c < s[2]; ++c)
+//                 for (size_t d = 0; d < D; ++d)
+//                     p.getFlat()[((n*R + r + win.padTop)*C + c + win.padLeft)*D + d] =
+//                         x.getFlat()[((n*s[1] + r)*s[2] + c)*D + d];
+//     return p;
+// }
+
+// struct ConvRef {
+//     Tensor out, outMag;
+//     Tensor dW, dWMag;
+//     Tensor dX, dXMag;
+// };
+
+// // fp32 forward, kernel and input gradients of a valid convolution over the padded input, plus
+// // the sums of absolute products each one is made of. dX is cropped back to the unpadded input.
+// static ConvRef naiveConv(
+//     const Tensor &padded, const Tensor &K, const Tensor &b, const Tensor &grad,
+//     size_t stride, const WindowDims &win, const vector<size_t> &inShape
+// ) {
+//     const vector<size_t> &ps = padded.getShape();
+//     size_t N = ps[0], R = ps[1], C = ps[2], D = ps[3];
+//     size_t O = K.getShape()[0], kR = K.getShape()[1], kC = K.getShape()[2];
+//     size_t oR = grad.getShape()[1], oC = grad.getShape()[2];
+
+//     ConvRef ref;
+//     ref.out = Tensor({N, oR, oC, O}); ref.outMag = Tensor({N, oR, oC, O});
+//     ref.dW = Tensor(K.getShape()); ref.dWMag = Tensor(K.getShape());
+//     Tensor dP(ps), dPMag(ps);
+
+//     auto in = [&](size_t n, size_t r, size_t c, size_t d) { return padded.getFlat()[((n*R + r)*C + c)*D + d]; };
+//     auto k = [&](size_t o, size_t i, size_t j, size_t d) { return K.getFlat()[((o*kR + i)*kC + j)*D + d]; };
+
+//     for (size_t n = 0; n < N; ++n)
+//         for (size_t r = 0; r < oR; ++r)
+//             for (size_t c = 0; c < oC; ++c)
+//                 for (size_t o = 0; o < O; ++o) {
+//                     size_t outIdx = ((n*oR + r)*oC + c)*O + o;
+//                     float g = grad.getFlat()[outIdx];
+//                     float acc = b.getFlat()[o], mag = std::fabs(b.getFlat()[o]);
+
+//                     for (size_t i = 0; i < kR; ++i)
+//                         for (size_t j = 0; j < kC; ++j)
+//                             for (size_t d = 0; d < D; ++d) {
+//                                 float x = in(n, r*stride + i, c*stride + j, d), w = k(o, i, j, d);
+//                                 size_t kIdx = ((o*kR + i)*kC + j)*D + d;
+//                                 size_t pIdx = ((n*R + r*stride + i)*C + c*stride + j)*D + d;
+//                                 acc += x * w;
+//                                 mag += std::fabs(x * w);
+//                                 ref.dW.getFlat()[kIdx] += g * x;
+//                                 ref.dWMag.getFlat()[kIdx] += std::fabs(g * x);
+//                                 dP.getFlat()[pIdx] += g * w;
+//                                 dPMag.getFlat()[pIdx] += std::fabs(g * w);
+//                             }
+
+//                     ref.out.getFlat()[outIdx] = acc;
+//                     ref.outMag.getFlat()[outIdx] = mag;
+//                 }
+
+//     size_t H = inShape[1], W = inShape[2];
+//     ref.dX = Tensor({N, H, W, D}); ref.dXMag = Tensor({N, H, W, D});
+//     for (size_t n = 0; n < N; ++n)
+//         for (size_t r = 0; r < H; ++r)
+//             for (size_t c = 0; c < W; ++c)
+//                 for (size_t d = 0; d < D; ++d) {
+//                     size_t pIdx = ((n*R + r + win.padTop)*C + c + win.padLeft)*D + d;
+//                     ref.dX.getFlat()[((n*H + r)*W + c)*D + d] = dP.getFlat()[pIdx];
+//                     ref.dXMag.getFlat()[((n*H + r)*W + c)*D + d] = dPMag.getFlat()[pIdx];
+//                 }
+//     return ref;
+// }
+
+// // 1) fp32 to bf16 rounds to nearest even, keeps infinities and keeps NaNs NaN
+// static void test_conversions() {
+//     assert(Bf16Tensor::fromFloat(1.0f) == 0x3F80);
+//     assert(Bf16Tensor::fromFloat(-1.5f) == 0xBFC0);
+//     assert(Bf16Tensor::fromFloat(0.0f) == 0x0000);
+//     assert(Bf16Tensor::fromFloat(-0.0f) == 0x8000);
+
+//     // Halfway cases go to the even neighbour, anything past halfway rounds up.
+//     assert(Bf16Tensor::fromFloat(fromBits(0x3F808000u)) == 0x3F80);
+//     assert(Bf16Tensor::fromFloat(fromBits(0x3F818000u)) == 0x3F82);
+//     assert(Bf16Tensor::fromFloat(fromBits(0x3F808001u)) == 0x3F81);
+//     assert(Bf16Tensor::fromFloat(fromBits(0x3F807FFFu)) == 0x3F80);
+
+//     // Rounding carries into the exponent, and past the largest finite value into infinity.
+//     assert(Bf16Tensor::fromFloat(fromBits(0x3FFFFFFFu)) == 0x4000);
+//     assert(Bf16Tensor::fromFloat(fromBits(0x7F7FFFFFu)) == 0x7F80);
+//     assert(Bf16Tensor::fromFloat(INFINITY) == 0x7F80);
+//     assert(Bf16Tensor::fromFloat(-INFINITY) == 0xFF80);
+
+//     // A NaN whose payload sits in the dropped bits must not truncate to infinity.
+//     for (uint32_t bits : {0x7FC00000u, 0x7F800001u, 0xFF800001u, 0x7FFFFFFFu}) {
+//         uint16_t h = Bf16Tensor::fromFloat(fromBits(bits));
+//         assert(std::isnan(Bf16Tensor::toFloat(h)));
+//         assert((h & 0x8000) == ((bits >> 16) & 0x8000));
+//     }
+
+//     // Every bf16 value widens exactly and narrows back to itself.
+//     for (uint32_t h = 0; h < 0x10000; ++h) {
+//         float f = Bf16Tensor::toFloat((uint16_t) h);
+//         uint32_t bits;
+//         std::memcpy(&bits, &f, sizeof(float));
+//         assert(bits == h << 16);
+//         if (!std::isnan(f)) assert(Bf16Tensor::fromFloat(f) == h);
+//     }
+
+//     Tensor t({3, 5});
+//     fillRandom(t, 1, -100.f, 100.f);
+//     Bf16Tensor bf;
+//     bf.store(t);
+//     Tensor back({3, 5});
+//     bf.load(back);
+//     assert(back.getShape() == t.getShape());
+//     for (size_t i = 0; i < t.getSize(); ++i)
+//         assert(std::fabs(back.getFlat()[i] - t.getFlat()[i]) <= std::fabs(t.getFlat()[i]) / 256.f);
+
+//     std::puts("✅ test_conversions passed.");
+// }
+
+// // 2) bf16 forward, kernel and input gradients match the fp32 naive convolution within bf16
+// //    rounding, with and without padding and stride
+// static void test_conv_matches_fp32() {
+//     struct Case { size_t N, H, W, D, O, kR, kC, stride; Tensor::Paddings pad; };
+//     const Case cases[] = {
+//         {2, 7, 6, 3, 5, 3, 3, 1, Tensor::Paddings::SAME},
+//         {3, 9, 8, 4, 7, 3, 2, 2, Tensor::Paddings::SAME},
+//         {2, 8, 8, 2, 6, 3, 3, 2, Tensor::Paddings::NONE},
+//         {1, 5, 5, 17, 9, 1, 1, 1, Tensor::Paddings::NONE},
+//     };
+
+//     uint32_t seed = 10;
+//     for (const Case &t : cases) {
+//         vector<size_t> inShape = {t.N, t.H, t.W, t.D};
+//         WindowDims win = Tensor::computeInputWindow(inShape, t.kR, t.kC, t.pad, t.stride);
+
+//         Tensor x(inShape); fillRandom(x, seed++);
+//         Tensor K({t.O, t.kR, t.kC, t.D}); fillRandom(K, seed++);
+//         Tensor b({t.O}); fillRandom(b, seed++);
+//         Tensor grad({t.N, win.outRows, win.outCols, t.O}); fillRandom(grad, seed++);
+
+//         Tensor padded = naivePad(x, win);
+//         ConvRef ref = naiveConv(padded, K, b, grad, t.stride, win, inShape);
+
+//         Bf16Tensor xBf, kBf;
+//         xBf.storePadded(x, win);
+//         kBf.storeKernels(K);
+
+//         Tensor out({t.N, win.outRows, win.outCols, t.O});
+//         xBf.conv2dForward(kBf, t.stride, out, b);
+//         assertBf16Close(out, ref.out, ref.outMag, "conv2dForward");
+
+//         Tensor dW(K.getShape());
+//         xBf.conv2dWeights(grad, t.O, t.kR, t.kC, t.stride, dW);
+//         assertBf16Close(dW, ref.dW, ref.dWMag, "conv2dWeights");
+
+//         WindowDims winGrad = grad.computeGradWindow(
+//             t.kR, t.kC, padded.getShape()[1], padded.getShape()[2], t.stride, win
+//         );
+//         Bf16Tensor gradBf;
+//         gradBf.storeUpsampledGrad(grad, winGrad, t.stride);
+//         Tensor dX(inShape);
+//         gradBf.conv2dInput(kBf, dX);
+//         assertBf16Close(dX, ref.dX, ref.dXMag, "conv2dInput");
+
+//         // The fp32 kernels share the loop order and must match the reference to fp32 rounding.
+//         Tensor out32({t.N, win.outRows, win.outCols, t.O}), dW32(K.getShape()), dX32(inShape);
+//         Tensor gradUp(gradBf.getShape());
+//         padded.conv2dForward(K, t.stride, out32, b);
+//         padded.conv2dWeights(grad, t.O, t.kR, t.kC, t.stride, dW32);
+//         grad.padAndUpsampleGrad(gradUp, winGrad, t.stride);
+//         gradUp.conv2dInput(K, dX32);
+//         for (size_t i = 0; i < out32.getSize(); ++i)
+//             assert(std::fabs(out32.getFlat()[i] - ref.out.getFlat()[i]) <= 1e-5f * (1.f + ref.outMag.getFlat()[i]));
+//         for (size_t i = 0; i < dW32.getSize(); ++i)
+//             assert(std::fabs(dW32.getFlat()[i] - ref.dW.getFlat()[i]) <= 1e-5f * (1.f + ref.dWMag.getFlat()[i]));
+//         for (size_t i = 0; i < dX32.getSize(); ++i)
+//             assert(std::fabs(dX32.getFlat()[i] - ref.dX.getFlat()[i]) <= 1e-5f * (1.f + ref.dXMag.getFlat()[i]));
+//     }
+
+//     std::puts("✅ test_conv_matches_fp32 passed.");
+// }
+
+// int main() {
+//     test_conversions();
+//     test_conv_matches_fp32();
+
+//     std::puts("🎉 All Bf16Tensor CPU tests passed.");
+//     return 0;
+// }
@@ -0,0 +1,181 @@
+// // CsrTensorCpu.cpp
+// #include "core/tensor/CsrTensor.h"
+// #include "core/tensor/Tensor.h"
+// #include "core/layers/Dense.h"
+// #include "core/activations/ReLU.h"
+// #include "core/gpu/GpuEngine.h"
+
+// #include <cassert>
+// #include <cstdio>
+// #include <cmath>
+// #include <random>
+// #include <vector>
+// #include <algorithm>
+
+// using std::vector;
+
+// static void fillRandom(Tensor &t, uint32_t seed, float lo=-1.f, float hi=1.f) {
+//     std::mt19937 rng(seed);
+//     std::uniform_real_distribution<float> U(lo, hi);
+//     for (auto &x : t.getFlat()) x = U(rng);
+// }
+
+// // Random {rows, cols} matrix with about density * cols nonzeros per row, returned both ways.
+// static CsrTensor makeSparse(size_t rows, size_t cols, float density, uint32_t seed, Tensor &dense) {
+//     std::mt19937 rng(seed);
+//     std::uniform_real_distribution<float> U(-1.f, 1.f);
+//     std::uniform_real_distribution<float> P(0.f, 1.f);
+
+//     dense = Tensor({rows, cols});
+//     CsrTensor sparse(0, cols);
+//     for (size_t i = 0; i < rows; ++i) {
+//         for (size_t j = 0; j < cols; ++j) {
+//             if (P(rng) < density) {
+//                 float v = U(rng);
+//                 dense.getFlat()[i*cols + j] = v;
+//                 sparse.appendEntry((uint32_t) j, v);
+//             }
+//         }
+//         sparse.finishRow();
+//     }
+//     return sparse;
+// }
+
+// static void assertAllClose(const float *a, const float *b, size_t n, float tol, const char *name) {
+//     for (size_t i = 0; i < n; ++i) {
+//         if (std::fabs(a[i] - b[i]) > tol * (1.f + std::fabs(b[i]))) {
+//             std::fprintf(stderr, "%s mismatch at %zu: %g vs %g\n", name, i, a[i], b[i]);
+//             assert(false);
+//         }
+//     }
+// }
+
+// // y = x W^T on dense storage
+// static void naiveMmT(const Tensor &x, const Tensor &W, Tensor &y) {
+//     size_t N = x.getShape()[0], F = x.getShape()[1], M = W.getShape()[0];
+//     y = Tensor({N, M});
+//     for (size_t i = 0; i < N; ++i)
+//         for (size_t n = 0; n < M; ++n) {
+//             float acc = 0.f;
+//             for (size_t k = 0; k < F; ++k) acc += x.getFlat()[i*F + k] * W.getFlat()[n*F + k];
+//             y.getFlat()[i*M + n] = acc;
+//         }
+// }
+
+// // 1) toDense, densifyRow and gatherRows agree with the source matrix (empty rows included)
+// static void test_dense_round_trip() {
+//     const size_t N=9, F=37;
+//     Tensor dense;
+//     CsrTensor x = makeSparse(N, F, 0.15f, 1, dense);
+//     assert(x.getNumRows() == N && x.getNumCols() == F);
+
+//     Tensor back = x.toDense();
+//     assertAllClose(back.getFlat().data(), dense.getFlat().data(), N*F, 0.f, "toDense");
+
+//     vector<size_t> rows = {8, 0, 3, 3, 5};
+//     CsrTensor g = x.gatherRows(rows.data(), rows.size());
+//     vector<float> row(F);
+//     for (size_t i = 0; i < rows.size(); ++i) {
+//         g.densifyRow(i, row.data());
+//         assertAllClose(row.data(), dense.getFlat().data() + rows[i]*F, F, 0.f, "gatherRows");
+//     }
+
+//     std::puts("✅ test_dense_round_trip passed.");
+// }
+
+// // 2) Sparse x W^T matches the dense product on the densified input
+// static void test_mmT_matches_dense() {
+//     const size_t N=13, F=300, M=21;
+//     Tensor dense;
+//     CsrTensor x = makeSparse(N, F, 0.05f, 2, dense);
+//     Tensor W({M, F}); fillRandom(W, 3);
+
+//     Tensor ySparse({N, M});
+//     x.mmT(W, ySparse);
+//     Tensor yRef;
+//     naiveMmT(dense, W, yRef);
+//     assertAllClose(ySparse.getFlat().data(), yRef.getFlat().data(), N*M, 1e-5f, "mmT");
+
+//     std::puts("✅ test_mmT_matches_dense passed.");
+// }
+
+// // 3) The sparse weight update equals the dense one on touched columns and leaves the rest
+// static void test_weight_grad_matches_dense() {
+//     const size_t N=6, F=80, M=5;
+//     const float scale=-0.1f, l2=0.01f;
+//     Tensor dense;
+//     CsrTensor x = makeSparse(N, F, 0.08f, 4, dense);
+//     Tensor grad({N, M}); fillRandom(grad, 5);
+//     Tensor W({M, F}); fillRandom(W, 6);
+//     Tensor Wref = W;
+
+//     x.applyWeightGrad(grad, scale, l2, W);
+
+//     vector<char> touched(F, 0);
+//     for (uint32_t c : x.getColIdx()) touched[c] = 1;
+//     for (size_t n = 0; n < M; ++n)
+//         for (size_t k = 0; k < F; ++k) {
+//             float w = Wref.getFlat()[n*F + k];
+//             float expect = w;
+//             if (touched[k]) {
+//                 float g = 0.f;
+//                 for (size_t i = 0; i < N; ++i) g += grad.getFlat()[i*M + n] * dense.getFlat()[i*F + k];
+//                 expect = w + scale * (g + 2*l2*w);
+//             }
+//             assertAllClose(&W.getFlat()[n*F + k], &expect, 1, 1e-5f, "applyWeightGrad");
+//         }
+
+//     std::puts("✅ test_weight_grad_matches_dense passed.");
+// }
+
+// // 4) A Dense layer fed CSR rows matches the same layer fed the densified rows
+// static void test_dense_layer_sparse_vs_dense() {
+//     GpuEngine::disableGpu();
+//     const size_t N=8, F=120, M=17;
+//     Tensor x;
+//     CsrTensor xs = makeSparse(N, F, 0.1f, 7, x);
+
+//     Dense a(M, new ReLU(), /*lambda=*/0.f);
+//     a.build({N, F});
+//     Dense b(a);
+//     b.setSparseInput(true);
+//     b.build({N, F});
+
+//     a.forward(x);
+//     b.forwardSparse(xs);
+//     assertAllClose(
+//         b.getOutput().getFlat().data(), a.getOutput().getFlat().data(), N*M, 1e-5f, "forwardSparse"
+//     );
+
+//     Tensor ga({N, M}); fillRandom(ga, 8);
+//     Tensor gb = ga;
+//     a.backprop(x, /*lr=*/0.1f, ga, /*isFirstLayer=*/true);
+//     b.backpropSparse(xs, /*lr=*/0.1f, gb);
+//     assertAllClose(
+//         b.getWeights().getFlat().data(), a.getWeights().getFlat().data(), M*F, 1e-5f, "backpropSparse dW"
+//     );
+//     assertAllClose(
+//         b.getBiases().getFlat().data(), a.getBiases().getFlat().data(), M, 1e-5f, "backpropSparse dB"
+//     );
+
+//     Tensor ya({N, M}), yb({N, M}), scratch;
+//     a.infer(x, ya, scratch);
+//     b.inferSparse(xs, yb);
+//     assertAllClose(yb.getFlat().data(), ya.getFlat().data(), N*M, 1e-5f, "inferSparse");
+
+//     b.packWeights();
+//     b.inferSparse(xs, yb);
+//     assertAllClose(yb.getFlat().data(), ya.getFlat().data(), N*M, 1e-5f, "inferSparse packed");
+
+//     std::puts("✅ test_dense_layer_sparse_vs_dense passed.");
+// }
+
+// int main() {
+//     test_dense_round_trip();
+//     test_mmT_matches_dense();
+//     test_weight_grad_matches_dense();
+//     test_dense_layer_sparse_vs_dense();
+
+//     std::puts("🎉 All CsrTensor CPU tests passed.");
+//     return 0;
+// }
@@ -0,0 +1,229 @@
+// // ModelContainerCpu.cpp
+// #include "core/model/Pipeline.h"
+// #include "core/model/NeuralNet.h"
+// #include "core/layers/Dense.h"
+// #include "core/layers/Conv2D.h"
+// #include "core/layers/Flatten.h"
+// #include "core/activations/ReLU.h"
+// #include "core/activations/Softmax.h"
+// #include "core/losses/SoftmaxCrossEntropy.h"
+// #include "core/data/SampleView.h"
+// #include "core/data/Data.h"
+// #include "core/gpu/GpuEngine.h"
+// #include "utils/BinUtils.h"
+// #include "utils/Scalar.h"
+
+// #include <cassert>
+// #include <cstdio>
+// #include <cmath>
+// #include <random>
+// #include <vector>
+// #include <string>
+// #include <fstream>
+// #include <cstring>
+// #include <unistd.h>
+// #include <sys/wait.h>
+
+// using std::vector;
+// using std::string;
+
+// static void fillRandom(Tensor &t, uint32_t seed, float lo=-1.f, float hi=1.f) {
+//     std::mt19937 rng(seed);
+//     std::uniform_real_distribution<float> U(lo, hi);
+//     for (auto &x : t.getFlat()) x = U(rng);
+// }
+
+// static float maxAbsDiff(const Tensor &a, const Tensor &b) {
+//     assert(a.getSize() == b.getSize());
+//     float d = 0.f;
+//     for (size_t i = 0; i < a.getSize(); ++i) d = std::fmax(d, std::fabs(a.getFlat()[i] - b.getFlat()[i]));
+//     return d;
+// }
+
+// static float maxAbs(const Tensor &t) {
+//     float m = 0.f;
+//     for (float v : t.getFlat()) m = std::fmax(m, std::fabs(v));
+//     return m;
+// }
+
+// static NeuralNet* makeMlp() {
+//     return new NeuralNet({
+//         new Dense(48, new ReLU()), new Dense(19, new ReLU()), new Dense(3, new Softmax())
+//     }, new SoftmaxCrossEntropy());
+// }
+
+// static NeuralNet* makeCnn() {
+//     return new NeuralNet({
+//         new Conv2D(12, 3, 3, 1, "same", new ReLU()), new Flatten(), new Dense(3, new Softmax())
+//     }, new SoftmaxCrossEntropy());
+// }
+
+// // Weight tensors of every layer after a container load must equal the saved ones within the
+// // storage format's error, relative to the largest weight of the layer.
+// static void assertWeightsClose(NeuralNet &saved, NeuralNet &loaded, float relTol, const char *name) {
+//     const vector<Layer*> &a = saved.getLayers();
+//     const vector<Layer*> &b = loaded.getLayers();
+//     assert(a.size() == b.size());
+//     for (size_t i = 0; i < a.size(); ++i) {
+//         const Tensor &wa = a[i]->getWeights();
+//         const Tensor &wb = b[i]->getWeights();
+//         assert(wa.getSize() == wb.getSize());
+//         if (wa.getSize() == 0) continue;
+
+//         float d = maxAbsDiff(wa, wb);
+//         if (d > relTol * maxAbs(wa)) {
+//             std::fprintf(stderr, "%s layer %zu: weight error %g\n", name, i, d);
+//             assert(false);
+//         }
+//         assert(maxAbsDiff(a[i]->getBiases(), b[i]->getBiases()) == 0.f);
+//     }
+// }
+
+// // 1) Every weight format reloads the saved weights and predictions within its tolerance
+// static void test_round_trip_per_format() {
+//     GpuEngine::disableGpu();
+//     const BinUtils::WeightFormats formats[] = {
+//         BinUtils::FP32, BinUtils::FP16, BinUtils::BF16, BinUtils::INT8
+//     };
+//     const float weightTol[] = {0.f, 8e-4f, 4e-3f, 1.4e-2f};
+//     const float predTol[] = {0.f, 2e-3f, 1e-2f, 4e-2f};
+
+//     for (int net = 0; net < 2; ++net) {
+//         Tensor x = (net == 0) ? Tensor({16, 40}) : Tensor({16, 8, 8, 2});
+//         fillRandom(x, 1 + net);
+
+//         Pipeline pipe;
+//         NeuralNet *model = (net == 0) ? makeMlp() : makeCnn();
+//         pipe.setModel(model);
+//         Tensor ref = model->predict(SampleView(x));
+
+//         for (int f = 0; f < 4; ++f) {
+//             string path = "/tmp/model_container_test.nn";
+//             BinUtils::writeToBin(pipe, path, formats[f]);
+//             Pipeline loadedPipe = BinUtils::loadPipeline(path);
+//             NeuralNet &loaded = *loadedPipe.getModel();
+
+//             assertWeightsClose(*model, loaded, weightTol[f], "round trip");
+//             Tensor pred = loaded.predict(SampleView(x));
+//             assert(maxAbsDiff(pred, ref) <= predTol[f]);
+//             std::remove(path.c_str());
+//         }
+//     }
+
+//     std::puts("✅ test_round_trip_per_format passed.");
+// }
+
+// // A model as the first release wrote it: no header, the hasModel flag, then the network with
+// // row-major weights inline, and no data, scalars or transformer.
+// static void writeRevisionOne(const string &path, NeuralNet &model) {
+//     std::ofstream out(path, std::ios::binary);
+//     auto put = [&](uint32_t v) { out.write((char*) &v, sizeof(uint32_t)); };
+//     auto putFloats = [&](const Tensor &t) { out.write((char*) t.getFlat().data(), t.getSize() * sizeof(float)); };
+
+//     uint8_t hasModel = 1;
+//     out.write((char*) &hasModel, sizeof(uint8_t));
+//     put(SoftmaxCrossEntropy().getEncoding());
+//     put((uint32_t) model.getLayers().size());
+
+//     const vector<Layer*> &layers = model.getLayers();
+//     for (size_t i = 0; i < layers.size(); ++i) {
+//         const Tensor &w = layers[i]->getWeights();
+//         bool isLast = i + 1 == layers.size();
+//         put(Layer::Encodings::Dense);
+//         put(isLast ? Softmax().getEncoding() : ReLU().getEncoding());
+//         put((uint32_t) w.getShape()[0]);
+//         put((uint32_t) w.getShape()[1]);
+//         putFloats(w);
+//         putFloats(layers[i]->getBiases());
+//         float l2 = 0.f;
+//         out.write((char*) &l2, sizeof(float));
+//     }
+
+//     put(Data::Encodings::None);
+//     put(Scalar::Encodings::None);
+//     put(Scalar::Encodings::None);
+//     uint8_t hasTransformer = 0;
+//     out.write((char*) &hasTransformer, sizeof(uint8_t));
+// }
+
+// // 2) A revision 1 file still loads with exact weights and predictions
+// static void test_load_revision_one() {
+//     GpuEngine::disableGpu();
+//     Tensor x({9, 40});
+//     fillRandom(x, 3);
+//     NeuralNet *model = makeMlp();
+//     Tensor ref = model->predict(SampleView(x));
+
+//     string path = "/tmp/model_container_rev1.nn";
+//     writeRevisionOne(path, *model);
+//     Pipeline loadedPipe = BinUtils::loadPipeline(path);
+//     NeuralNet &loaded = *loadedPipe.getModel();
+
+//     assertWeightsClose(*model, loaded, 0.f, "revision 1");
+//     assert(maxAbsDiff(loaded.predict(SampleView(x)), ref) == 0.f);
+//     std::remove(path.c_str());
+//     delete model;
+
+//     std::puts("✅ test_load_revision_one passed.");
+// }
+
+// // Loads the file in a child process, since a rejected file ends the process. Returns the exit
+// // status.
+// static int loadInChild(const string &path) {
+//     std::fflush(stdout);
+//     pid_t pid = fork();
+//     if (pid == 0) {
+//         BinUtils::loadPipeline(path);
+//         _exit(0);
+//     }
+
+//     int status = 0;
+//     waitpid(pid, &status, 0);
+//     return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+// }
+
+// // 3) A flipped byte in the model description or in a weight section is rejected at load
+// static void test_reject_corrupted_checksum() {
+//     GpuEngine::disableGpu();
+//     Pipeline pipe;
+//     NeuralNet *model = makeMlp();
+//     pipe.setModel(model);
+//     Tensor x({2, 40});
+//     model->predict(SampleView(x));
+
+//     string path = "/tmp/model_container_corrupt.nn";
+//     BinUtils::writeToBin(pipe, path, BinUtils::FP32);
+//     assert(loadInChild(path) == 0);
+
+//     std::ifstream in(path, std::ios::binary);
+//     vector<char> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+//     in.close();
+
+//     // The header holds the section table offset at byte 16. Table entries are 32 bytes with the
+//     // section offset at byte 8, and entry 1 is the first weight section. Byte 80 is in the stream.
+//     uint64_t tableOffset, weightOffset;
+//     std::memcpy(&tableOffset, bytes.data() + 16, sizeof(uint64_t));
+//     std::memcpy(&weightOffset, bytes.data() + tableOffset + 32 + 8, sizeof(uint64_t));
+
+//     for (size_t offset : {(size_t) 80, (size_t) weightOffset + 5}) {
+//         vector<char> corrupted = bytes;
+//         corrupted[offset] ^= 0x10;
+//         std::ofstream out(path, std::ios::binary);
+//         out.write(corrupted.data(), corrupted.size());
+//         out.close();
+
+//         assert(loadInChild(path) == 1);
+//     }
+//     std::remove(path.c_str());
+
+//     std::puts("✅ test_reject_corrupted_checksum passed.");
+// }
+
+// int main() {
+//     test_round_trip_per_format();
+//     test_load_revision_one();
+//     test_reject_corrupted_checksum();
+
+//     std::puts("🎉 All model container CPU tests passed.");
+//     return 0;
+// }
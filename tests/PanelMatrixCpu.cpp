@@ -0,0 +1,165 @@
+// // PanelMatrixCpu.cpp
+// #include "core/tensor/PanelMatrix.h"
+// #include "core/tensor/CsrTensor.h"
+// #include "core/tensor/Tensor.h"
+
+// #include <cassert>
+// #include <cstdio>
+// #include <cmath>
+// #include <random>
+// #include <vector>
+
+// using std::vector;
+
+// static void fillRandom(Tensor &t, uint32_t seed, float lo=-1.f, float hi=1.f) {
+//     std::mt19937 rng(seed);
+//     std::uniform_real_distribution<float> U(lo, hi);
+//     for (auto &x : t.getFlat()) x = U(rng);
+// }
+
+// static void assertAllClose(const float *a, const float *b, size_t n, float tol, const char *name) {
+//     for (size_t i = 0; i < n; ++i) {
+//         if (std::fabs(a[i] - b[i]) > tol * (1.f + std::fabs(b[i]))) {
+//             std::fprintf(stderr, "%s mismatch at %zu: %g vs %g\n", name, i, a[i], b[i]);
+//             assert(false);
+//         }
+//     }
+// }
+
+// // y = x W^T + b on dense storage
+// static void naiveLinear(const Tensor &x, const Tensor &W, const Tensor &b, Tensor &y) {
+//     size_t N = x.getShape()[0], F = x.getShape()[1], M = W.getShape()[0];
+//     y = Tensor({N, M});
+//     for (size_t i = 0; i < N; ++i)
+//         for (size_t n = 0; n < M; ++n) {
+//             float acc = b.getFlat()[n];
+//             for (size_t k = 0; k < F; ++k) acc += x.getFlat()[i*F + k] * W.getFlat()[n*F + k];
+//             y.getFlat()[i*M + n] = acc;
+//         }
+// }
+
+// // Output widths around the panel height, including ones that leave a partial tail panel.
+// static const size_t ROW_COUNTS[] = {1, 7, 16, 17, 33, 50};
+
+// // 1) pack then unpack returns the source matrix exactly
+// static void test_pack_unpack_round_trip() {
+//     for (size_t M : ROW_COUNTS) {
+//         const size_t F = 29;
+//         Tensor W({M, F}); fillRandom(W, 1 + M);
+
+//         PanelMatrix p;
+//         assert(p.isEmpty());
+//         p.pack(W);
+//         assert(!p.isEmpty() && p.getNumRows() == M && p.getNumCols() == F);
+
+//         Tensor back({M, F});
+//         p.unpack(back);
+//         assertAllClose(back.getFlat().data(), W.getFlat().data(), M*F, 0.f, "unpack");
+
+//         PanelMatrix copy(p);
+//         Tensor backCopy({M, F});
+//         copy.unpack(backCopy);
+//         assertAllClose(backCopy.getFlat().data(), W.getFlat().data(), M*F, 0.f, "unpack copy");
+//     }
+
+//     std::puts("✅ test_pack_unpack_round_trip passed.");
+// }
+
+// // 2) gemv and gemm match the naive product, tail panels included
+// static void test_gemv_gemm_match_naive() {
+//     for (size_t M : ROW_COUNTS) {
+//         const size_t F = 300;
+//         Tensor W({M, F}); fillRandom(W, 10 + M);
+//         Tensor b({M}); fillRandom(b, 20 + M);
+//         PanelMatrix p;
+//         p.pack(W);
+
+//         for (size_t N : {1, 3, 4, 13}) {
+//             Tensor x({N, F}); fillRandom(x, 30 + N);
+//             Tensor yRef;
+//             naiveLinear(x, W, b, yRef);
+
+//             Tensor y({N, M});
+//             p.gemm(x.getFlat().data(), N, b.getFlat().data(), y.getFlat().data());
+//             assertAllClose(y.getFlat().data(), yRef.getFlat().data(), N*M, 1e-5f, "gemm");
+
+//             if (N == 1) {
+//                 Tensor yv({1, M});
+//                 p.gemv(x.getFlat().data(), b.getFlat().data(), yv.getFlat().data());
+//                 assertAllClose(yv.getFlat().data(), yRef.getFlat().data(), M, 1e-5f, "gemv");
+//             }
+//         }
+//     }
+
+//     std::puts("✅ test_gemv_gemm_match_naive passed.");
+// }
+
+// // 3) Each row of a batch gets the same result as running it alone through gemv, serial or
+// //    split across threads
+// static void test_batch_one_vs_batch_n() {
+//     const size_t N=11, F=700, M=37;
+//     Tensor W({M, F}); fillRandom(W, 40);
+//     Tensor b({M}); fillRandom(b, 41);
+//     Tensor x({N, F}); fillRandom(x, 42);
+//     PanelMatrix p;
+//     p.pack(W);
+
+//     Tensor y({N, M});
+//     p.gemm(x.getFlat().data(), N, b.getFlat().data(), y.getFlat().data());
+
+//     size_t prevThreads = PanelMatrix::getNumThreads();
+//     vector<float> row(M);
+//     for (size_t threads : {1, 4}) {
+//         PanelMatrix::setNumThreads(threads);
+//         for (size_t i = 0; i < N; ++i) {
+//             p.gemv(x.getFlat().data() + i*F, b.getFlat().data(), row.data());
+//             assertAllClose(row.data(), y.getFlat().data() + i*M, M, 1e-5f, "gemv vs gemm row");
+//         }
+//     }
+//     PanelMatrix::setNumThreads(prevThreads);
+
+//     std::puts("✅ test_batch_one_vs_batch_n passed.");
+// }
+
+// // 4) sparseGemm on CSR rows matches gemm on the densified rows
+// static void test_sparse_vs_dense_gemm() {
+//     const size_t N=9, F=200, M=33;
+//     std::mt19937 rng(50);
+//     std::uniform_real_distribution<float> U(-1.f, 1.f);
+//     std::uniform_real_distribution<float> P(0.f, 1.f);
+
+//     Tensor x({N, F});
+//     CsrTensor xs(0, F);
+//     for (size_t i = 0; i < N; ++i) {
+//         for (size_t j = 0; j < F; ++j) {
+//             if (i != 4 && P(rng) < 0.05f) {
+//                 float v = U(rng);
+//                 x.getFlat()[i*F + j] = v;
+//                 xs.appendEntry((uint32_t) j, v);
+//             }
+//         }
+//         xs.finishRow();
+//     }
+
+//     Tensor W({M, F}); fillRandom(W, 51);
+//     Tensor b({M}); fillRandom(b, 52);
+//     PanelMatrix p;
+//     p.pack(W);
+
+//     Tensor yDense({N, M}), ySparse({N, M});
+//     p.gemm(x.getFlat().data(), N, b.getFlat().data(), yDense.getFlat().data());
+//     p.sparseGemm(xs, b.getFlat().data(), ySparse.getFlat().data());
+//     assertAllClose(ySparse.getFlat().data(), yDense.getFlat().data(), N*M, 1e-5f, "sparseGemm");
+
+//     std::puts("✅ test_sparse_vs_dense_gemm passed.");
+// }
+
+// int main() {
+//     test_pack_unpack_round_trip();
+//     test_gemv_gemm_match_naive();
+//     test_batch_one_vs_batch_n();
+//     test_sparse_vs_dense_gemm();
+
+//     std::puts("🎉 All PanelMatrix CPU tests passed.");
+//     return 0;
+// }
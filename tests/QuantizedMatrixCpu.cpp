@@ -0,0 +1,206 @@
+// // QuantizedMatrixCpu.cpp
+// #include "core/tensor/QuantizedMatrix.h"
+// #include "core/tensor/Tensor.h"
+
+// #include <cassert>
+// #include <cstdio>
+// #include <cmath>
+// #include <random>
+// #include <vector>
+// #include <algorithm>
+
+// using std::vector;
+
+// static void fillRandom(Tensor &t, uint32_t seed, float lo=-1.f, float hi=1.f) {
+//     std::mt19937 rng(seed);
+//     std::uniform_real_distribution<float> U(lo, hi);
+//     for (auto &x : t.getFlat()) x = U(rng);
+// }
+
+// static void assertAllClose(const float *a, const float *b, size_t n, float tol, const char *name) {
+//     for (size_t i = 0; i < n; ++i) {
+//         if (std::fabs(a[i] - b[i]) > tol * (1.f + std::fabs(b[i]))) {
+//             std::fprintf(stderr, "%s mismatch at %zu: %g vs %g\n", name, i, a[i], b[i]);
+//             assert(false);
+//         }
+//     }
+// }
+
+// // Largest absolute input per channel, where the channel of column k is k % numChannels
+// static vector<float> channelRanges(const Tensor &x, size_t numChannels) {
+//     size_t F = x.getShape()[1];
+//     vector<float> ranges(numChannels, 0.f);
+//     for (size_t i = 0; i < x.getSize(); ++i) {
+//         size_t c = (i % F) % numChannels;
+//         ranges[c] = std::max(ranges[c], std::fabs(x.getFlat()[i]));
+//     }
+//     return ranges;
+// }
+
+// // y = x W^T + b on dense storage
+// static void naiveLinear(const Tensor &x, const Tensor &W, const Tensor &b, Tensor &y) {
+//     size_t N = x.getShape()[0], F = x.getShape()[1], M = W.getShape()[0];
+//     y = Tensor({N, M});
+//     for (size_t i = 0; i < N; ++i)
+//         for (size_t n = 0; n < M; ++n) {
+//             float acc = b.getFlat()[n];
+//             for (size_t k = 0; k < F; ++k) acc += x.getFlat()[i*F + k] * W.getFlat()[n*F + k];
+//             y.getFlat()[i*M + n] = acc;
+//         }
+// }
+
+// // Signed int8 reference of the quantized product. With smoothing each channel is divided by
+// // s = maxInput^0.5 / maxWeight^0.5 before the input is quantized per tensor, and the weights are
+// // multiplied by it before they are quantized per row. Without it s = 1.
+// static void naiveInt8Linear(
+//     const Tensor &x, const Tensor &W, const Tensor &b, const vector<float> &ranges,
+//     bool smooth, Tensor &y
+// ) {
+//     size_t N = x.getShape()[0], F = x.getShape()[1], M = W.getShape()[0], C = ranges.size();
+
+//     vector<float> wRanges(C, 0.f);
+//     for (size_t i = 0; i < M*F; ++i)
+//         wRanges[(i % F) % C] = std::max(wRanges[(i % F) % C], std::fabs(W.getFlat()[i]));
+
+//     vector<float> s(C, 1.f);
+//     float inRange = 0.f;
+//     for (size_t c = 0; c < C; ++c) {
+//         if (smooth && ranges[c] > 0.f && wRanges[c] > 0.f)
+//             s[c] = std::pow(ranges[c], 0.5f) / std::pow(wRanges[c], 0.5f);
+//         inRange = std::max(inRange, ranges[c] / s[c]);
+//     }
+//     float inScale = inRange > 0.f ? inRange / 127 : 1.f;
+
+//     vector<int32_t> xq(N*F);
+//     for (size_t i = 0; i < N*F; ++i) {
+//         float level = x.getFlat()[i] / (s[(i % F) % C] * inScale);
+//         xq[i] = (int32_t) std::nearbyint(std::min(std::max(level, -127.f), 127.f));
+//     }
+
+//     y = Tensor({N, M});
+//     for (size_t n = 0; n < M; ++n) {
+//         const float *w = W.getFlat().data() + n*F;
+//         float rowRange = 0.f;
+//         for (size_t k = 0; k < F; ++k) rowRange = std::max(rowRange, std::fabs(w[k] * s[k % C]));
+//         float rowScale = rowRange > 0.f ? rowRange / 127 : 1.f;
+
+//         vector<int32_t> wq(F);
+//         for (size_t k = 0; k < F; ++k) wq[k] = (int32_t) std::nearbyint(w[k] * s[k % C] / rowScale);
+
+//         for (size_t i = 0; i < N; ++i) {
+//             int32_t acc = 0;
+//             for (size_t k = 0; k < F; ++k) acc += xq[i*F + k] * wq[k];
+//             y.getFlat()[i*M + n] = acc * rowScale * inScale + b.getFlat()[n];
+//         }
+//     }
+// }
+
+// // Runs x through quantizeInput and gemm, or gemv for a single sample.
+// static void runQuantized(const QuantizedMatrix &q, const Tensor &x, const Tensor &b, Tensor &y) {
+//     size_t N = x.getShape()[0], M = b.getSize();
+//     vector<uint8_t> xq(N * q.getRowStride());
+//     q.quantizeInput(x.getFlat().data(), N, xq.data());
+
+//     y = Tensor({N, M});
+//     if (N == 1) {
+//         q.gemv(xq.data(), b.getFlat().data(), y.getFlat().data());
+//     } else {
+//         q.gemm(xq.data(), N, b.getFlat().data(), y.getFlat().data());
+//     }
+// }
+
+// // 1) Rows are padded with the zero point 128, and the row sums remove it from the dot products
+// static void test_zero_point_padding() {
+//     const size_t F=300, M=21;
+//     Tensor W({M, F}); fillRandom(W, 1);
+//     Tensor b({M}); fillRandom(b, 2);
+//     Tensor calib({8, F}); fillRandom(calib, 3);
+
+//     QuantizedMatrix q;
+//     q.quantize(W, channelRanges(calib, F));
+//     assert(!q.isEmpty());
+//     assert(q.getRowStride() == 320);
+
+//     Tensor zeros({3, F});
+//     vector<uint8_t> xq(3 * q.getRowStride());
+//     q.quantizeInput(zeros.getFlat().data(), 3, xq.data());
+//     for (uint8_t v : xq) assert(v == 128);
+
+//     Tensor y;
+//     runQuantized(q, zeros, b, y);
+//     for (size_t i = 0; i < 3; ++i)
+//         assertAllClose(y.getFlat().data() + i*M, b.getFlat().data(), M, 0.f, "zero input");
+
+//     std::puts("✅ test_zero_point_padding passed.");
+// }
+
+// // 2) gemv and gemm match the naive int8 reference, and stay close to fp32
+// static void test_matches_naive_int8() {
+//     const size_t F=264, M=19;
+//     Tensor W({M, F}); fillRandom(W, 10);
+//     Tensor b({M}); fillRandom(b, 11);
+//     Tensor calib({32, F}); fillRandom(calib, 12);
+
+//     for (size_t C : {(size_t) F, (size_t) 8}) {
+//         vector<float> ranges = channelRanges(calib, C);
+//         QuantizedMatrix q;
+//         q.quantize(W, ranges);
+
+//         for (size_t N : {1, 5, 8}) {
+//             Tensor x({N, F}); fillRandom(x, 20 + N);
+//             Tensor y, yInt8, yFp32;
+//             runQuantized(q, x, b, y);
+//             naiveInt8Linear(x, W, b, ranges, true, yInt8);
+//             naiveLinear(x, W, b, yFp32);
+
+//             assertAllClose(y.getFlat().data(), yInt8.getFlat().data(), N*M, 1e-4f, "int8 reference");
+//             float err = 0.f, scale = 0.f;
+//             for (size_t i = 0; i < N*M; ++i) {
+//                 err = std::max(err, std::fabs(y.getFlat()[i] - yFp32.getFlat()[i]));
+//                 scale = std::max(scale, std::fabs(yFp32.getFlat()[i]));
+//             }
+//             assert(err <= 0.02f * scale);
+//         }
+//     }
+
+//     std::puts("✅ test_matches_naive_int8 passed.");
+// }
+
+// // 3) With one outlier input channel, smoothing keeps the int8 result closer to fp32 than
+// //    quantizing the raw inputs per tensor does
+// static void test_smoothing_vs_unsmoothed() {
+//     const size_t N=16, F=256, M=24;
+//     Tensor W({M, F}); fillRandom(W, 30);
+//     Tensor b({M}); fillRandom(b, 31);
+//     Tensor x({N, F}); fillRandom(x, 32);
+//     for (size_t i = 0; i < N; ++i) x.getFlat()[i*F + 7] *= 60.f;
+//     vector<float> ranges = channelRanges(x, F);
+
+//     QuantizedMatrix q;
+//     q.quantize(W, ranges);
+//     Tensor y, ySmoothed, yUnsmoothed, yFp32;
+//     runQuantized(q, x, b, y);
+//     naiveInt8Linear(x, W, b, ranges, true, ySmoothed);
+//     naiveInt8Linear(x, W, b, ranges, false, yUnsmoothed);
+//     naiveLinear(x, W, b, yFp32);
+
+//     assertAllClose(y.getFlat().data(), ySmoothed.getFlat().data(), N*M, 1e-4f, "smoothed reference");
+
+//     float errSmoothed = 0.f, errUnsmoothed = 0.f;
+//     for (size_t i = 0; i < N*M; ++i) {
+//         errSmoothed = std::max(errSmoothed, std::fabs(y.getFlat()[i] - yFp32.getFlat()[i]));
+//         errUnsmoothed = std::max(errUnsmoothed, std::fabs(yUnsmoothed.getFlat()[i] - yFp32.getFlat()[i]));
+//     }
+//     assert(errSmoothed < errUnsmoothed);
+
+//     std::puts("✅ test_smoothing_vs_unsmoothed passed.");
+// }
+
+// int main() {
+//     test_zero_point_padding();
+//     test_matches_naive_int8();
+//     test_smoothing_vs_unsmoothed();
+
+//     std::puts("🎉 All QuantizedMatrix CPU tests passed.");
+//     return 0;
+// }